@@ -170,6 +170,12 @@ class QPID_MESSAGING_CLASS_EXTERN Message
     QPID_MESSAGING_EXTERN std::string getContentBytes() const;
     /** Set the content as raw bytes (an alias for setContent() */
     QPID_MESSAGING_EXTERN void setContentBytes(const std::string&);
+    /**
+     * Exchange the content with the data held in the string
+     * parameter, without copying it. The string is left holding the
+     * previous raw content.
+     */
+    QPID_MESSAGING_EXTERN void swapContent(std::string&);
     /**
      * Get the content as a Variant, which can represent an object of
      * different types. This can be used for content representing a
@@ -192,6 +198,10 @@ class QPID_MESSAGING_CLASS_EXTERN Message
      * memory pointed to is owned by the message. The getContentSize()
      * method indicates how much data there is (i.e. the extent of the
      * memory region pointed to by the return value of this method).
+     *
+     * For a received message whose content has not been accessed
+     * otherwise, this points into the received data without copying
+     * it. The pointer is only valid until the message is modified.
      */
     QPID_MESSAGING_EXTERN const char* getContentPtr() const;
     /** Get the size of content in bytes. */
@@ -27,6 +27,8 @@
 #include "qpid/messaging/Handle.h"
 #include "qpid/messaging/Duration.h"
 
+#include <vector>
+
 namespace qpid {
 namespace messaging {
 
@@ -89,6 +91,22 @@ class QPID_MESSAGING_CLASS_EXTERN Receiver : public qpid::messaging::Handle<Rece
      * closed, in which case isClose() will be true.
      */
     QPID_MESSAGING_EXTERN Message fetch(Duration timeout=Duration::FOREVER);
+#ifndef SWIG
+    /**
+     * Retrieves up to max messages for this Receiver's subscription,
+     * appending them to messages. Waits for up to the specified
+     * timeout for the first message; further messages are only taken
+     * if they are available without waiting. As with fetch(), the
+     * server is checked for messages before returning none, and any
+     * credit issued for the batch is reclaimed.
+     *
+     * @return the number of messages appended; 0 if there was no
+     * message available after waiting for the specified time period,
+     * or if the receiver is closed.
+     */
+    QPID_MESSAGING_EXTERN size_t fetch(std::vector<Message>& messages, size_t max,
+                                       Duration timeout=Duration::FOREVER);
+#endif
     /**
      * Sets the capacity for the Receiver. The capacity determines how
      * many incoming messages can be held in the Receiver before being
@@ -27,6 +27,7 @@
 #include "qpid/sys/IntegerTypes.h"
 
 #include <string>
+#include <vector>
 
 namespace qpid {
 namespace messaging {
@@ -58,6 +59,20 @@ class QPID_MESSAGING_CLASS_EXTERN Sender : public qpid::messaging::Handle<Sender
      * available capacity (i.e. pending == capacity)
      */
     QPID_MESSAGING_EXTERN void send(const Message& message, bool sync=false);
+#ifndef SWIG
+    /**
+     * Sends a batch of messages, in order. The effect is the same as
+     * calling send() for each message, but the per-call costs
+     * (locking, waking up the I/O thread, encoding setup) are paid
+     * once for the whole batch rather than once per message.
+     *
+     * @param messages the messages to send
+     * @param sync if true the call will block until the server
+     * confirms receipt of all the messages; if false will only block
+     * for available capacity
+     */
+    QPID_MESSAGING_EXTERN void send(const std::vector<Message>& messages, bool sync=false);
+#endif
     QPID_MESSAGING_EXTERN void close();
 
     /**
@@ -66,6 +66,7 @@ QPID_TYPES_EXTERN std::string getTypeName(VariantType type);
 QPID_TYPES_EXTERN bool isIntegerType(VariantType type);
 
 class VariantImpl;
+class VariantExtras;
 
 /**
  * Represents a value of variable type.
@@ -154,6 +155,16 @@ class QPID_TYPES_CLASS_EXTERN Variant
     QPID_TYPES_EXTERN operator std::string() const;
     QPID_TYPES_EXTERN operator Uuid() const;
 
+    /**
+     * Copies of a Variant holding a map, a list or a long string share
+     * one copy of the value until one of them is modified. A reference
+     * from a const accessor refers to that shared value. If this
+     * Variant is then modified through a non-const accessor it takes a
+     * private copy first, so the earlier const reference no longer
+     * reflects this Variant and is only valid while a copy still holds
+     * the shared value. Take a reference from the non-const accessor if
+     * it must follow later changes to this Variant.
+     */
     QPID_TYPES_EXTERN const Map& asMap() const;
     QPID_TYPES_EXTERN Map& asMap();
     QPID_TYPES_EXTERN const List& asList() const;
@@ -161,6 +172,7 @@ class QPID_TYPES_CLASS_EXTERN Variant
 
     /**
      * Unlike asString(), getString() will not do any conversions.
+     * A long string is shared between copies as described for asMap().
      * @exception InvalidConversion if the type is not STRING.
      */
     QPID_TYPES_EXTERN const std::string& getString() const;
@@ -209,7 +221,35 @@ class QPID_TYPES_CLASS_EXTERN Variant
     QPID_TYPES_EXTERN static Variant described(const Variant& descriptor, const List& value);
 
   private:
-    mutable VariantImpl* impl;
+    /**
+     * Scalars, UUIDs and short strings are held inline. Longer strings,
+     * maps and lists are held in a reference counted block that copies
+     * share until one of them is modified.
+     */
+    union Value {
+        bool b;
+        uint8_t ui8;
+        uint16_t ui16;
+        uint32_t ui32;
+        uint64_t ui64;
+        int8_t i8;
+        int16_t i16;
+        int32_t i32;
+        int64_t i64;
+        float f;
+        double d;
+        void* shared;
+        unsigned char uuid[16];
+        char string[sizeof(std::string)];
+    };
+
+    VariantType type;
+    uint8_t encoding;
+    uint8_t state;
+    Value value;
+    VariantExtras* extras;      // Descriptors and uncommon encodings, if any
+
+  friend class VariantImpl;
 };
 
 #ifndef SWIG
@@ -252,7 +252,7 @@ class SchemaType:
       stream.write (indent + self.encode.replace ("@", "buf") \
                     .replace ("#", varName + "Count") + ";\n")
       stream.write (indent + self.encode.replace ("@", "buf") \
-                    .replace ("#", varName + "Count ? " + varName + "Min : 0") + ";\n")
+                    .replace ("#", varName + "Count ? (" + self.cpp + ") " + varName + "Min : 0") + ";\n")
       stream.write (indent + self.encode.replace ("@", "buf") \
                     .replace ("#", varName + "Max") + ";\n")
       stream.write (indent + self.encode.replace ("@", "buf") \
@@ -576,16 +576,21 @@ class SchemaStatistic:
     return self.name
 
   def genDeclaration (self, stream, prefix="    "):
+    cpp   = self.type.type.cpp
+    total = "uint64_t"
+    if self.type.type.perThread:
+      cpp   = "::qpid::management::StatisticsCounter<" + cpp + ">"
+      total = "::qpid::management::StatisticsCounter<" + total + ">"
     if self.type.type.style != "mma":
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + ";\n")
+      stream.write (prefix + cpp + "  " + self.name + ";\n")
     if self.type.type.style == 'wm':
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + "High;\n")
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + "Low;\n")
+      stream.write (prefix + cpp + "  " + self.name + "High;\n")
+      stream.write (prefix + cpp + "  " + self.name + "Low;\n")
     if self.type.type.style == "mma":
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + "Count;\n")
-      stream.write (prefix + "uint64_t  " + self.name + "Total;\n")
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + "Min;\n")
-      stream.write (prefix + self.type.type.cpp + "  " + self.name + "Max;\n")
+      stream.write (prefix + cpp + "  " + self.name + "Count;\n")
+      stream.write (prefix + total + "  " + self.name + "Total;\n")
+      stream.write (prefix + cpp + "  " + self.name + "Min;\n")
+      stream.write (prefix + cpp + "  " + self.name + "Max;\n")
 
   def genAccessor (self, stream):
     self.type.type.genAccessor (stream, self.name, "instChanged")
@@ -1221,6 +1226,8 @@ class SchemaClass:
     for element in self.properties:
       if element.isConstructorArg ():
         stream.write ("," + element.getName () + "(_" + element.getName () + ")")
+    if self.testExistPerThreadStats (variables):
+      stream.write (",perThreadStatsArray(maxThreads)")
 
   def genDoMethodArgs (self, stream, variables):
     methodCount = 0
@@ -57,11 +57,6 @@ uint8_t /*MGEN:Class.NameCap*/::md5Sum[MD5_LEN]   =
     for (uint8_t idx = 0; idx < /*MGEN:Class.PresenceMaskBytes*/; idx++)
         presenceMask[idx] = 0;
 /*MGEN:ENDIF*/
-/*MGEN:IF(Class.ExistPerThreadStats)*/
-    perThreadStatsArray = new struct PerThreadStats*[maxThreads];
-    for (int idx = 0; idx < maxThreads; idx++)
-        perThreadStatsArray[idx] = 0;
-/*MGEN:ENDIF*/
 /*MGEN:IF(Root.GenLogs)*/
     QPID_LOG_CAT(trace, model, "Mgmt create " << className
         << ". id:" << getKey());
@@ -70,12 +65,6 @@ uint8_t /*MGEN:Class.NameCap*/::md5Sum[MD5_LEN]   =
 
 /*MGEN:Class.NameCap*/::~/*MGEN:Class.NameCap*/ ()
 {
-/*MGEN:IF(Class.ExistPerThreadStats)*/
-    for (int idx = 0; idx < maxThreads; idx++)
-        if (perThreadStatsArray[idx] != 0)
-            delete perThreadStatsArray[idx];
-    delete[] perThreadStatsArray;
-/*MGEN:ENDIF*/
 }
 
 void /*MGEN:Class.NameCap*/::debugStats (const std::string& comment)
@@ -147,11 +136,24 @@ void /*MGEN:Class.NameCap*/::writeSchema (std::string& schema)
 }
 
 /*MGEN:IF(Class.ExistPerThreadStats)*/
+struct /*MGEN:Class.NameCap*/::PerThreadStats* /*MGEN:Class.NameCap*/::allocateThreadStats(int idx)
+{
+    // Slow path, taken once per thread: blocks are only ever created
+    // under accessLock so aggregation never sees a half built one.
+    Mutex::ScopedLock mutex(accessLock);
+    struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
+    if (threadStats == 0) {
+        threadStats = perThreadStatsArray.allocate(idx);
+/*MGEN:Class.InitializePerThreadElements*/
+    }
+    return threadStats;
+}
+
 void /*MGEN:Class.NameCap*/::aggregatePerThreadStats(struct PerThreadStats* totals) const
 {
 /*MGEN:Class.InitializeTotalPerThreadStats*/
-    for (int idx = 0; idx < maxThreads; idx++) {
-        struct PerThreadStats* threadStats = perThreadStatsArray[idx];
+    for (int idx = 0; idx < perThreadStatsArray.size(); idx++) {
+        struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
         if (threadStats != 0) {
 /*MGEN:Class.AggregatePerThreadStats*/
         }
@@ -229,8 +231,8 @@ void /*MGEN:Class.NameCap*/::writeStatistics (std::string& _sBuf, bool skipHeade
     Mutex::ScopedLock mutex(accessLock);
     instChanged = false;
 /*MGEN:IF(Class.ExistPerThreadAssign)*/
-    for (int idx = 0; idx < maxThreads; idx++) {
-        struct PerThreadStats* threadStats = perThreadStatsArray[idx];
+    for (int idx = 0; idx < perThreadStatsArray.size(); idx++) {
+        struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
         if (threadStats != 0) {
 /*MGEN:Class.PerThreadAssign*/
         }
@@ -252,8 +254,8 @@ void /*MGEN:Class.NameCap*/::writeStatistics (std::string& _sBuf, bool skipHeade
     // Maintenance of hi-lo statistics
 /*MGEN:Class.HiLoStatResets*/
 /*MGEN:IF(Class.ExistPerThreadResets)*/
-    for (int idx = 0; idx < maxThreads; idx++) {
-        struct PerThreadStats* threadStats = perThreadStatsArray[idx];
+    for (int idx = 0; idx < perThreadStatsArray.size(); idx++) {
+        struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
         if (threadStats != 0) {
 /*MGEN:Class.PerThreadHiLoStatResets*/
         }
@@ -314,8 +316,8 @@ void /*MGEN:Class.NameCap*/::mapEncodeValues (::qpid::types::Variant::Map& _map,
     if (includeStatistics) {
         instChanged = false;
 /*MGEN:IF(Class.ExistPerThreadAssign)*/
-        for (int idx = 0; idx < maxThreads; idx++) {
-            struct PerThreadStats* threadStats = perThreadStatsArray[idx];
+        for (int idx = 0; idx < perThreadStatsArray.size(); idx++) {
+            struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
             if (threadStats != 0) {
 /*MGEN:Class.PerThreadAssign*/
             }
@@ -332,8 +334,8 @@ void /*MGEN:Class.NameCap*/::mapEncodeValues (::qpid::types::Variant::Map& _map,
     // Maintenance of hi-lo statistics
 /*MGEN:Class.HiLoStatResets*/
 /*MGEN:IF(Class.ExistPerThreadResets)*/
-        for (int idx = 0; idx < maxThreads; idx++) {
-            struct PerThreadStats* threadStats = perThreadStatsArray[idx];
+        for (int idx = 0; idx < perThreadStatsArray.size(); idx++) {
+            struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
             if (threadStats != 0) {
 /*MGEN:Class.PerThreadHiLoStatResets*/
             }
@@ -24,6 +24,7 @@
 /*MGEN:Root.Disclaimer*/
 
 #include "qpid/management/ManagementObject.h"
+#include "qpid/management/PerThreadStatistics.h"
 /*MGEN:IF(Root.InBroker)*/
 #include "qmf/BrokerImportExport.h"
 #include <boost/shared_ptr.hpp>
@@ -64,19 +65,17 @@ namespace qmf {
     };
  private:
 
-    struct PerThreadStats** perThreadStatsArray;
+    ::qpid::management::PerThreadStatsArray<PerThreadStats> perThreadStatsArray;
 
     inline struct PerThreadStats* getThreadStats() {
         int idx = getThreadIndex();
-        struct PerThreadStats* threadStats = perThreadStatsArray[idx];
-        if (threadStats == 0) {
-            threadStats = new(PerThreadStats);
-            perThreadStatsArray[idx] = threadStats;
-/*MGEN:Class.InitializePerThreadElements*/
-        }
+        struct PerThreadStats* threadStats = perThreadStatsArray.get(idx);
+        if (threadStats == 0)
+            threadStats = allocateThreadStats(idx);
         return threadStats;
     }
 
+    struct PerThreadStats* allocateThreadStats(int idx);
     void aggregatePerThreadStats(struct PerThreadStats*) const;
 /*MGEN:ENDIF*/
   public:
@@ -78,8 +78,6 @@ if (BUILD_AMQP)
          qpid/broker/amqp/ManagedIncomingLink.cpp
          qpid/broker/amqp/ManagedOutgoingLink.h
          qpid/broker/amqp/ManagedOutgoingLink.cpp
-         qpid/broker/amqp/Message.h
-         qpid/broker/amqp/Message.cpp
          qpid/broker/amqp/NodePolicy.h
          qpid/broker/amqp/NodePolicy.cpp
          qpid/broker/amqp/NodeProperties.h
@@ -119,8 +117,6 @@ if (BUILD_AMQP)
          qpid/messaging/amqp/ConnectionContext.cpp
          qpid/messaging/amqp/ConnectionHandle.h
          qpid/messaging/amqp/ConnectionHandle.cpp
-         qpid/messaging/amqp/DriverImpl.h
-         qpid/messaging/amqp/DriverImpl.cpp
          qpid/messaging/amqp/PnData.h
          qpid/messaging/amqp/PnData.cpp
          qpid/messaging/amqp/ReceiverContext.h
@@ -119,14 +119,17 @@ void SessionState::senderRecord(const AMQFrame& f) {
     QPID_LOG(trace, getId() << ": sent cmd " << sender.sendPoint.command << ": " << *f.getBody());
 
     stateful = true;
-    if (timeout) sender.replayList.push_back(f);
     sender.unflushedSize += f.encodedSize();
     sender.bytesSinceKnownCompleted += f.encodedSize();
-    sender.replaySize += f.encodedSize();
     sender.incomplete += sender.sendPoint.command;
     sender.sendPoint.advance(f);
-    if (config.replayHardLimit && config.replayHardLimit < sender.replaySize) 
-        throw ResourceLimitExceededException("Replay buffer exceeeded hard limit");
+    if (timeout) {
+        // Copying the frame shares its body, it does not copy content.
+        sender.replayList.push_back(f);
+        sender.replaySize += f.encodedSize();
+        if (config.replayHardLimit && config.replayHardLimit < sender.replaySize)
+            throw ResourceLimitExceededException("Replay buffer exceeeded hard limit");
+    }
 }
 
 static const uint32_t SPONTANEOUS_REQUEST_INTERVAL = 65536; 
@@ -29,7 +29,7 @@
 #include <qpid/framing/FrameHandler.h>
 #include <boost/operators.hpp>
 #include <boost/range/iterator_range.hpp>
-#include <vector>
+#include <deque>
 #include <iosfwd>
 #include <qpid/CommonImportExport.h>
 
@@ -72,7 +72,7 @@ QPID_COMMON_EXTERN std::ostream& operator<<(std::ostream&, const SessionPoint&);
  * source-incompatbile API changes.
  */
 class SessionState {
-    typedef std::vector<framing::AMQFrame> ReplayList;
+    typedef std::deque<framing::AMQFrame> ReplayList;
 
   public:
 
@@ -82,6 +82,7 @@ class SessionState {
         QPID_COMMON_EXTERN Configuration(size_t flush=1024*1024, size_t hard=0);
         size_t replayFlushLimit; // Flush when the replay list >= N bytes. 0 disables.
         size_t replayHardLimit; // Kill session if replay list > N bytes. 0 disables.
+                                // Only sessions with a timeout keep a replay list.
     };
 
     QPID_COMMON_EXTERN SessionState(const SessionId& =SessionId(), const Configuration& =Configuration());
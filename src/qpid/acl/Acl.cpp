@@ -156,6 +156,28 @@ bool Acl::authorise(
     return result(aclreslt, id, action, objType, ExchangeName);
 }
 
+bool Acl::authorisePublish(
+    const std::string& id,
+    const std::string& ExchangeName,
+    const std::string& RoutingKey,
+    broker::AclPublishCache& cache)
+{
+    AclResult aclreslt;
+    if (!cache.get(generation.get(), ExchangeName, RoutingKey, aclreslt)) {
+        boost::shared_ptr<AclData> dataLocal;
+        uint32_t dataGeneration;
+        {
+            Mutex::ScopedLock locker(dataLock);
+            dataLocal = data;  //rcu copy
+            dataGeneration = generation.get();
+        }
+        aclreslt = dataLocal->lookup(id,ACT_PUBLISH,OBJ_EXCHANGE,ExchangeName,RoutingKey);
+        cache.put(dataGeneration, ExchangeName, RoutingKey, aclreslt);
+    }
+    // the result is still reported, and logged if required, every time
+    return result(aclreslt, id, ACT_PUBLISH, OBJ_EXCHANGE, ExchangeName);
+}
+
 
 bool Acl::approveConnection(const qpid::broker::Connection& conn)
 {
@@ -275,6 +297,7 @@ bool Acl::readAclFile(std::string& aclFile, std::string& errorText) {
     {
         Mutex::ScopedLock locker(dataLock);
         data = d;
+        ++generation;
     }
     transferAcl = data->transferAcl; // any transfer ACL
     userRules = true; // rules in force came from an ACL file
@@ -320,6 +343,7 @@ void Acl::loadEmptyAclRuleset() {
     {
         Mutex::ScopedLock locker(dataLock);
         data = d;
+        ++generation;
     }
     if (mgmtObject!=0){
         mgmtObject->set_transferAcl(transferAcl?1:0);
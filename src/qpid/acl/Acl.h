@@ -29,6 +29,7 @@
 #include "qpid/management/Manageable.h"
 #include "qpid/management/ManagementAgent.h"
 #include "qmf/org/apache/qpid/acl/Acl.h"
+#include "qpid/sys/AtomicValue.h"
 #include "qpid/sys/Mutex.h"
 
 #include <boost/shared_ptr.hpp>
@@ -66,6 +67,7 @@ private:
     qmf::org::apache::qpid::acl::Acl::shared_ptr mgmtObject;
     qpid::management::ManagementAgent*   agent;
     mutable qpid::sys::Mutex             dataLock;
+    qpid::sys::AtomicValue<uint32_t>     generation; // of data, changed with dataLock held
     boost::shared_ptr<ConnectionCounter> connectionCounter;
     boost::shared_ptr<ResourceCounter>   resourceCounter;
     bool                                 userRules;
@@ -106,6 +108,12 @@ public:
         const std::string&               ExchangeName,
         const std::string&               RoutingKey);
 
+    virtual bool authorisePublish(
+        const std::string&               id,
+        const std::string&               ExchangeName,
+        const std::string&               RoutingKey,
+        broker::AclPublishCache&         cache);
+
     // Resource quota tracking
     virtual bool approveConnection(const broker::Connection& connection);
     virtual bool approveCreateQueue(const std::string& userId, const std::string& queueName);
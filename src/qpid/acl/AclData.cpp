@@ -22,6 +22,7 @@
 #include "qpid/sys/IntegerTypes.h"
 #include <boost/lexical_cast.hpp>
 #include <boost/shared_ptr.hpp>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 
@@ -53,6 +54,7 @@ AclData::AclData():
     transferAcl(false),
     aclSource("UNKNOWN"),
     connectionDecisionMode(qpid::acl::ALLOW),
+    compiled(false),
     connQuotaRuleSettings(new quotaRuleSet),
     queueQuotaRuleSettings(new quotaRuleSet),
     connBWHostsGlobalRules(new bwHostRuleSet),
@@ -76,7 +78,12 @@ void AclData::clear ()
             }
         }
         delete[] actionList[cnt];
+        actionList[cnt] = 0;
+        for (unsigned int cnt1=0; cnt1< qpid::acl::OBJECTSIZE; cnt1++) {
+            compiledList[cnt][cnt1].reset();
+        }
     }
+    compiled = false;
     transferAcl = false;
     connectionDecisionMode = qpid::acl::ALLOW;
     connQuotaRuleSettings->clear();
@@ -360,12 +367,12 @@ bool AclData::lookupMatchRule(
 }
 
 //
-// lookup - general ACL lookup
+// lookupLinear - general ACL lookup over the uncompiled rules
 //
 // The ACL main business logic function of matching rules and declaring
 // an allow or deny result.
 //
-AclResult AclData::lookup(
+AclResult AclData::lookupLinear(
     const std::string&               id,
     const Action&                    action,
     const ObjectType&                objType,
@@ -420,6 +427,352 @@ AclResult AclData::lookup(
 }
 
 
+//
+// lookup - general ACL lookup
+//
+// Same decision as lookupLinear but only the rules whose name can
+// match the lookup name are evaluated.
+//
+AclResult AclData::lookup(
+    const std::string&               id,
+    const Action&                    action,
+    const ObjectType&                objType,
+    const std::string&               name,
+    std::map<Property, std::string>* params)
+{
+    if (!compiled) {
+        return lookupLinear(id, action, objType, name, params);
+    }
+
+    QPID_LOG(debug, "ACL: Lookup for id:" << id
+             << " action:" << AclHelper::getActionStr((Action) action)
+             << " objectType:" << AclHelper::getObjectTypeStr((ObjectType) objType)
+             << " name:" << name
+             << " with params " << AclHelper::propertyMapToString(params));
+
+    AclResult aclresult = decisionMode;
+
+    const boost::shared_ptr<compiledObject>& rules = compiledList[action][objType];
+    if (rules) {
+        compiledObject::const_iterator itrRule = rules->find(id);
+        if (itrRule == rules->end()) {
+            itrRule = rules->find(ACL_KEYWORD_WILDCARD);
+        }
+        if (itrRule != rules->end()) {
+            const CompiledRuleSet& compiledSet = itrRule->second;
+            std::vector<uint32_t> candidates;
+            compiledSet.findCandidates(name, candidates);
+            for (std::vector<uint32_t>::const_iterator i = candidates.begin();
+                 i != candidates.end(); ++i) {
+                if (lookupMatchCompiledRule(compiledSet.rules[*i], id, name, params, aclresult)) {
+                    return aclresult;
+                }
+            }
+        }
+    }
+
+    QPID_LOG(debug,"ACL: No successful match, defaulting to the decision mode "
+             << AclHelper::getAclResultStr(aclresult));
+    return aclresult;
+}
+
+
+//
+// lookupMatchCompiledRule
+//
+// Check a single compiled rule. The caller has already matched the
+// rule name unless it needs user substitution.
+//
+bool AclData::lookupMatchCompiledRule(
+    const CompiledRule&              cRule,
+    const std::string&               id,
+    const std::string&               name,
+    const std::map<Property, std::string>* params,
+    AclResult&                       aclresult)
+{
+    const Rule& rule = *cRule.rule;
+    QPID_LOG(debug, "ACL: checking rule " <<  rule.toString());
+
+    if (cRule.nameUserSubst) {
+        std::string sName(cRule.name);
+        substituteUserId(sName, id);
+        if (!matchProp(sName, name)) {
+            QPID_LOG(debug, "ACL: lookup name '" << name
+                        << "' didn't match with rule name '" << cRule.name << "'");
+            return false;
+        }
+    }
+
+    // As for lookupMatchRule, properties other than the name are
+    // only checked when the lookup supplies parameters.
+    bool limitChecked = true;
+    if (params) {
+        for (std::vector<CompiledProperty>::const_iterator pItr = cRule.props.begin();
+             pItr != cRule.props.end(); ++pItr) {
+            propertyMapItr lookupParamItr = params->find(pItr->lookupProperty);
+            if (lookupParamItr == params->end()) {
+                QPID_LOG(debug, "ACL: lookup parameter map doesn't contain the rule property '"
+                            << AclHelper::getPropertyStr(pItr->specProperty) << "'");
+                return false;
+            }
+            bool result = true;
+            switch (pItr->kind) {
+            case CompiledProperty::UPPER_LIMIT:
+            case CompiledProperty::LOWER_LIMIT:
+                limitChecked &= compareLimit(*pItr, lookupParamItr->second);
+                break;
+
+            case CompiledProperty::ROUTINGKEY:
+                if (rule.ruleHasUserSub[PROP_ROUTINGKEY]) {
+                    std::string sKey(lookupParamItr->second);
+                    substituteKeywords(sKey, id);
+                    result = rule.matchRoutingKey(sKey);
+                } else {
+                    result = rule.matchRoutingKey(lookupParamItr->second);
+                }
+                break;
+
+            case CompiledProperty::MATCH_USER_SUBST: {
+                std::string sValue(pItr->value);
+                substituteUserId(sValue, id);
+                result = matchProp(sValue, lookupParamItr->second);
+                break;
+            }
+
+            case CompiledProperty::MATCH:
+                result = matchProp(pItr->value, lookupParamItr->second);
+                break;
+            }
+            if (!result) {
+                QPID_LOG(debug, "ACL: the pair("
+                         << AclHelper::getPropertyStr(lookupParamItr->first)
+                         << "," << lookupParamItr->second
+                         << ") given in lookup doesn't match the pair("
+                         << AclHelper::getPropertyStr(pItr->specProperty)
+                         << "," << pItr->value
+                         << ") given in the rule");
+                return false;
+            }
+        }
+    }
+
+    aclresult = rule.ruleMode;
+    if (!limitChecked) {
+        // Demote allow rules to corresponding deny rules.
+        switch (aclresult) {
+        case acl::ALLOW:
+            aclresult = acl::DENY;
+            break;
+        case acl::ALLOWLOG:
+            aclresult = acl::DENYLOG;
+            break;
+        default:
+            break;
+        };
+    }
+    QPID_LOG(debug,"ACL: Successful match, the decision is:"
+             << AclHelper::getAclResultStr(aclresult));
+    return true;
+}
+
+
+//
+// compile
+//
+// Build the compiled form of every rule set. Called by the reader once
+// all rules are loaded; the compiled rules refer to the loaded ones.
+//
+void AclData::compile()
+{
+    for (int act=0; act<acl::ACTIONSIZE; act++) {
+        for (int obj=0; obj<acl::OBJECTSIZE; obj++) {
+            compiledList[act][obj].reset();
+            if (actionList[act] == NULL || actionList[act][obj] == NULL) {
+                continue;
+            }
+            boost::shared_ptr<compiledObject> rules(new compiledObject);
+            for (actObjItr aoitr = actionList[act][obj]->begin();
+                 aoitr != actionList[act][obj]->end();
+                 aoitr++) {
+                CompiledRuleSet& compiledSet = (*rules)[aoitr->first];
+                // Rule sets are searched from the back
+                for (ruleSet::const_reverse_iterator rsItr = aoitr->second.rbegin();
+                     rsItr != aoitr->second.rend(); ++rsItr) {
+                    compiledSet.add(*rsItr);
+                }
+            }
+            compiledList[act][obj] = rules;
+        }
+    }
+    compiled = true;
+}
+
+
+void AclData::CompiledRuleSet::add(const Rule& rule)
+{
+    uint32_t index = rules.size();
+    rules.push_back(CompiledRule());
+    CompiledRule& cRule = rules.back();
+    cRule.rule = &rule;
+    cRule.nameUserSubst = false;
+
+    bool indexed = false;
+    for (specPropertyMapItr pItr = rule.props.begin(); pItr != rule.props.end(); pItr++) {
+        if (pItr->first == acl::SPECPROP_NAME) {
+            cRule.name = pItr->second;
+            if (rule.ruleHasUserSub[PROP_NAME]) {
+                cRule.nameUserSubst = true;
+            } else {
+                addName(pItr->second, index);
+                indexed = true;
+            }
+            continue;
+        }
+
+        CompiledProperty property;
+        property.kind = CompiledProperty::MATCH;
+        property.specProperty = pItr->first;
+        property.lookupProperty = (Property) pItr->first;
+        property.value = pItr->second;
+        property.limit = 0;
+        property.limitValid = false;
+
+        switch (pItr->first) {
+        case acl::SPECPROP_MAXPAGESUPPERLIMIT:
+        case acl::SPECPROP_MAXPAGESLOWERLIMIT:
+            property.lookupProperty = PROP_MAXPAGES;
+            break;
+        case acl::SPECPROP_MAXPAGEFACTORUPPERLIMIT:
+        case acl::SPECPROP_MAXPAGEFACTORLOWERLIMIT:
+            property.lookupProperty = PROP_MAXPAGEFACTOR;
+            break;
+        case acl::SPECPROP_MAXQUEUECOUNTUPPERLIMIT:
+        case acl::SPECPROP_MAXQUEUECOUNTLOWERLIMIT:
+            property.lookupProperty = PROP_MAXQUEUECOUNT;
+            break;
+        case acl::SPECPROP_MAXQUEUESIZEUPPERLIMIT:
+        case acl::SPECPROP_MAXQUEUESIZELOWERLIMIT:
+            property.lookupProperty = PROP_MAXQUEUESIZE;
+            break;
+        case acl::SPECPROP_MAXFILECOUNTUPPERLIMIT:
+        case acl::SPECPROP_MAXFILECOUNTLOWERLIMIT:
+            property.lookupProperty = PROP_MAXFILECOUNT;
+            break;
+        case acl::SPECPROP_MAXFILESIZEUPPERLIMIT:
+        case acl::SPECPROP_MAXFILESIZELOWERLIMIT:
+            property.lookupProperty = PROP_MAXFILESIZE;
+            break;
+        default:
+            break;
+        }
+
+        switch (pItr->first) {
+        case acl::SPECPROP_MAXQUEUECOUNTUPPERLIMIT:
+        case acl::SPECPROP_MAXQUEUESIZEUPPERLIMIT:
+        case acl::SPECPROP_MAXFILECOUNTUPPERLIMIT:
+        case acl::SPECPROP_MAXFILESIZEUPPERLIMIT:
+        case acl::SPECPROP_MAXPAGESUPPERLIMIT:
+        case acl::SPECPROP_MAXPAGEFACTORUPPERLIMIT:
+            property.kind = CompiledProperty::UPPER_LIMIT;
+            break;
+        case acl::SPECPROP_MAXQUEUECOUNTLOWERLIMIT:
+        case acl::SPECPROP_MAXQUEUESIZELOWERLIMIT:
+        case acl::SPECPROP_MAXFILECOUNTLOWERLIMIT:
+        case acl::SPECPROP_MAXFILESIZELOWERLIMIT:
+        case acl::SPECPROP_MAXPAGESLOWERLIMIT:
+        case acl::SPECPROP_MAXPAGEFACTORLOWERLIMIT:
+            property.kind = CompiledProperty::LOWER_LIMIT;
+            break;
+        case acl::SPECPROP_ROUTINGKEY:
+            property.kind = CompiledProperty::ROUTINGKEY;
+            break;
+        case acl::SPECPROP_ALTERNATE:
+        case acl::SPECPROP_QUEUENAME:
+            if (rule.ruleHasUserSub[pItr->first]) {
+                property.kind = CompiledProperty::MATCH_USER_SUBST;
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (property.kind == CompiledProperty::UPPER_LIMIT ||
+            property.kind == CompiledProperty::LOWER_LIMIT) {
+            try {
+                property.limit = boost::lexical_cast<uint64_t>(property.value);
+                property.limitValid = true;
+            }
+            catch(const boost::bad_lexical_cast&) {
+                QPID_LOG(error, "ACL: Illegal limit in rule " << rule.rawRuleNum
+                         << " for property '" << AclHelper::getPropertyStr(pItr->first)
+                         << "' : " << property.value);
+            }
+        }
+        cRule.props.push_back(property);
+    }
+    if (!indexed) {
+        unindexed.push_back(index);
+    }
+}
+
+
+void AclData::CompiledRuleSet::addName(const std::string& name, uint32_t index)
+{
+    bool wildcard = !name.empty() && name[name.size()-1] == ACL_SYMBOL_WILDCARD;
+    size_t length = wildcard ? name.size()-1 : name.size();
+    uint32_t node = 0;
+    for (size_t i = 0; i < length; ++i) {
+        NameNode::children_t& children = names[node].children;
+        NameNode::children_t::iterator child =
+            std::lower_bound(children.begin(), children.end(), std::make_pair(name[i], uint32_t(0)));
+        if (child != children.end() && child->first == name[i]) {
+            node = child->second;
+        } else {
+            uint32_t next = names.size();
+            children.insert(child, std::make_pair(name[i], next));
+            names.push_back(NameNode()); // invalidates children
+            node = next;
+        }
+    }
+    if (wildcard) {
+        names[node].prefix.push_back(index);
+    } else {
+        names[node].exact.push_back(index);
+    }
+}
+
+
+//
+// findCandidates
+//
+// Collect, in first-match order, the rules that may match a lookup
+// name: rules without a plain name, rules whose name is a prefix of
+// the lookup name followed by a wildcard, and rules naming it exactly.
+//
+void AclData::CompiledRuleSet::findCandidates(const std::string& name,
+                                              std::vector<uint32_t>& candidates) const
+{
+    candidates = unindexed;
+    uint32_t node = 0;
+    for (size_t i = 0; ; ++i) {
+        const NameNode& current = names[node];
+        candidates.insert(candidates.end(), current.prefix.begin(), current.prefix.end());
+        if (i == name.size()) {
+            candidates.insert(candidates.end(), current.exact.begin(), current.exact.end());
+            break;
+        }
+        NameNode::children_t::const_iterator child =
+            std::lower_bound(current.children.begin(), current.children.end(),
+                             std::make_pair(name[i], uint32_t(0)));
+        if (child == current.children.end() || child->first != name[i]) {
+            break;
+        }
+        node = child->second;
+    }
+    std::sort(candidates.begin(), candidates.end());
+}
+
+
 //
 // lookupMatchPublishExchangeRule
 //
@@ -737,6 +1090,40 @@ AclData::~AclData()
 }
 
 
+//
+// Limit check a compiled int limit
+//
+bool AclData::compareLimit(const CompiledProperty& theProperty,
+                           const std::string&      theLookupValue)
+{
+    if (!theProperty.limitValid) {
+        return false;
+    }
+    if (theProperty.limit == 0) {
+        QPID_LOG(debug, "ACL: Comparison is always true when ACL rule value is zero");
+        return true;
+    }
+    uint64_t lookupValue(0);
+    try {
+        lookupValue = boost::lexical_cast<uint64_t>(theLookupValue);
+    }
+    catch(const boost::bad_lexical_cast&) {
+        QPID_LOG(error,"ACL: Illegal value given in lookup for property '"
+                 << AclHelper::getPropertyStr(theProperty.specProperty)
+                 << "' : " << theLookupValue);
+        return false;
+    }
+    bool exceeded = (theProperty.kind == CompiledProperty::UPPER_LIMIT ?
+                     lookupValue > theProperty.limit : lookupValue < theProperty.limit);
+    if (exceeded) {
+        QPID_LOG(debug, "ACL: Limit exceeded for property '"
+                 << AclHelper::getPropertyStr(theProperty.specProperty) << "'");
+        return false;
+    }
+    return true;
+}
+
+
 //
 // Limit check an int limit
 //
@@ -57,7 +57,7 @@ private:
 };
 
 
-class AclData {
+class QPID_BROKER_CLASS_EXTERN AclData {
 
 
 public:
@@ -175,14 +175,23 @@ public:
     std::string          aclSource;
     qpid::acl::AclResult connectionDecisionMode;
 
-    AclResult lookup(
+    QPID_BROKER_EXTERN AclResult lookup(
         const std::string&               id,        // actor id
         const Action&                    action,
         const ObjectType&                objType,
         const std::string&               name,      // object name
         std::map<Property, std::string>* params=0);
 
-    AclResult lookup(
+    // Evaluates every rule for the actor in turn rather than using
+    // the compiled rules. Kept as the reference for lookup().
+    QPID_BROKER_EXTERN AclResult lookupLinear(
+        const std::string&               id,        // actor id
+        const Action&                    action,
+        const ObjectType&                objType,
+        const std::string&               name,      // object name
+        std::map<Property, std::string>* params=0);
+
+    QPID_BROKER_EXTERN AclResult lookup(
         const std::string&               id,        // actor id
         const Action&                    action,
         const ObjectType&                objType,
@@ -199,6 +208,7 @@ public:
 
     bool matchProp(const std::string & src, const std::string& src1);
     void clear ();
+    void compile ();
     void printDecisionRules(int userFieldWidth);
 
     static const std::string ACL_KEYWORD_USER_SUBST;
@@ -281,11 +291,74 @@ public:
         return connectionDecisionMode;
     }
 
-    AclData();
-    virtual ~AclData();
+    QPID_BROKER_EXTERN AclData();
+    QPID_BROKER_EXTERN virtual ~AclData();
 
 private:
 
+    //
+    // Compiled rules
+    //
+    // Built by compile() once the reader has loaded the rule sets.
+    // Each property is resolved to the lookup parameter it is checked
+    //  against and numeric limits are parsed once. Rule names are
+    //  held in a trie so that a lookup only evaluates the rules whose
+    //  name can match, in the same first-match order as the rule set.
+    //
+    struct CompiledProperty {
+        enum Kind { MATCH, MATCH_USER_SUBST, ROUTINGKEY, UPPER_LIMIT, LOWER_LIMIT };
+
+        Kind                  kind;
+        SpecProperty          specProperty;
+        Property              lookupProperty;
+        std::string           value;
+        uint64_t              limit;
+        bool                  limitValid;
+    };
+
+    struct CompiledRule {
+        const Rule*           rule;
+        bool                  nameUserSubst; // name matched after substitution
+        std::string           name;
+        std::vector<CompiledProperty> props;
+    };
+
+    // Names are stored with any trailing wildcard removed; a rule is
+    //  listed as exact or prefix at the node reached by its name.
+    struct NameNode {
+        typedef std::vector<std::pair<char, uint32_t> > children_t;
+
+        children_t            children;     // sorted by character
+        std::vector<uint32_t> exact;
+        std::vector<uint32_t> prefix;
+    };
+
+    struct CompiledRuleSet {
+        std::vector<CompiledRule> rules;    // in first-match order
+        std::vector<uint32_t>     unindexed;// rules without a plain name
+        std::vector<NameNode>     names;    // names[0] is the root
+
+        CompiledRuleSet() : names(1) {}
+        void add(const Rule& rule);
+        void addName(const std::string& name, uint32_t index);
+        void findCandidates(const std::string& name, std::vector<uint32_t>& candidates) const;
+    };
+
+    typedef std::map<std::string, CompiledRuleSet> compiledObject; // user
+
+    boost::shared_ptr<compiledObject> compiledList[qpid::acl::ACTIONSIZE][qpid::acl::OBJECTSIZE];
+    bool compiled;
+
+    bool lookupMatchCompiledRule(
+        const CompiledRule&              cRule,
+        const std::string&               id,
+        const std::string&               name,
+        const std::map<Property, std::string>* params,
+        AclResult&                       aclresult);
+
+    bool compareLimit(const CompiledProperty& theProperty,
+                      const std::string&      theLookupValue);
+
     inline bool lookupMatchRule(
         const ruleSetItr&                rsItr,
         const std::string&               id,
@@ -278,6 +278,8 @@ namespace acl {
         d->setConnGlobalRules(globalHostRules);
         // user B/W connection rules
         d->setConnUserRules(userHostRules);
+        // indexed form of the rule sets used for lookups
+        d->compile();
     }
 
 
@@ -35,7 +35,7 @@
 namespace qpid {
 namespace acl {
 
-class AclReader {
+class QPID_BROKER_CLASS_EXTERN AclReader {
     typedef std::set<std::string>               nameSet;
     typedef nameSet::const_iterator             nsCitr;
     typedef boost::shared_ptr<nameSet>          nameSetPtr;
@@ -101,10 +101,10 @@ class AclReader {
     std::ostringstream      errorStream;
 
   public:
-    AclReader(uint16_t cliMaxConnPerUser, uint16_t cliMaxQueuesPerUser);
-    virtual ~AclReader();
-    int read(const std::string& fn, boost::shared_ptr<AclData> d); // return=0 for success
-    std::string getError();
+    QPID_BROKER_EXTERN AclReader(uint16_t cliMaxConnPerUser, uint16_t cliMaxQueuesPerUser);
+    QPID_BROKER_EXTERN virtual ~AclReader();
+    QPID_BROKER_EXTERN int read(const std::string& fn, boost::shared_ptr<AclData> d); // return=0 for success
+    QPID_BROKER_EXTERN std::string getError();
 
   private:
     bool processLine(char* line);
@@ -21,6 +21,8 @@
  */
 
 #include "qpid/acl/AclLexer.h"
+#include "qpid/sys/IntegerTypes.h"
+#include "qpid/sys/unordered_map.h"
 #include <map>
 #include <string>
 
@@ -29,6 +31,51 @@ namespace broker {
 
     class Connection;
 
+    /**
+     * The results of publish checks made for a single user, kept by a
+     * session so that the rules need only be consulted once for each
+     * exchange and routing key. Results are only valid for the
+     * generation of the rules they were looked up in, and the number
+     * kept is bounded.
+     */
+    class AclPublishCache
+    {
+      public:
+        AclPublishCache() : generation(0), size(0) {}
+
+        bool get(uint32_t g, const std::string& exchange, const std::string& routingKey,
+                 acl::AclResult& result) const
+        {
+            if (g != generation) return false;
+            Exchanges::const_iterator i = exchanges.find(exchange);
+            if (i == exchanges.end()) return false;
+            Results::const_iterator j = i->second.find(routingKey);
+            if (j == i->second.end()) return false;
+            result = j->second;
+            return true;
+        }
+
+        void put(uint32_t g, const std::string& exchange, const std::string& routingKey,
+                 acl::AclResult result)
+        {
+            if (g != generation || size >= MAX_SIZE) {
+                exchanges.clear();
+                size = 0;
+                generation = g;
+            }
+            if (exchanges[exchange].insert(Results::value_type(routingKey, result)).second) ++size;
+        }
+
+      private:
+        enum { MAX_SIZE = 1024 };
+        typedef qpid::sys::unordered_map<std::string, acl::AclResult> Results;
+        typedef qpid::sys::unordered_map<std::string, Results> Exchanges;
+
+        uint32_t generation;
+        size_t size;
+        Exchanges exchanges;
+    };
+
     class AclModule
     {
 
@@ -56,6 +103,15 @@ namespace broker {
             const std::string&      ExchangeName,
             const std::string&      RoutingKey)=0;
 
+        /** As authorise() for publishing to an exchange, using and
+         *  updating the given cache, which must only be used for this id.
+         */
+        virtual bool authorisePublish(
+            const std::string&      id,
+            const std::string&      ExchangeName,
+            const std::string&      RoutingKey,
+            AclPublishCache&        cache)=0;
+
         // Add specialized authorise() methods as required.
 
         /** Approve connection by counting connections total, per-IP, and
@@ -126,6 +126,7 @@ BrokerOptions::BrokerOptions(const std::string& name) :
     noDataDir(0),
     port(DEFAULT_PORT),
     workerThreads(5),
+    timerThreads(1),
     connectionBacklog(10),
     enableMgmt(1),
     mgmtPublish(1),
@@ -146,6 +147,7 @@ BrokerOptions::BrokerOptions(const std::string& name) :
     queueThresholdEventRatio(80),
     defaultMsgGroup("qpid.no-group"),
     timestampRcvMsgs(false),    // set the 0.10 timestamp delivery property
+    histograms(false),
     linkMaintenanceInterval(2*sys::TIME_SEC),
     linkHeartbeatInterval(120*sys::TIME_SEC),
     dtxDefaultTimeout(60),      // 60s
@@ -172,6 +174,7 @@ BrokerOptions::BrokerOptions(const std::string& name) :
         ("listen-disable", optValue(listenDisabled, "<transport name>"), "Transports to disable listening")
         ("protocols", optValue(protocols, "<protocol name+version>"), "Which protocol versions to allow")
         ("worker-threads", optValue(workerThreads, "N"), "Sets the broker thread pool size")
+        ("timer-threads", optValue(timerThreads, "N"), "Sets the number of threads firing the broker's timer tasks")
         ("connection-backlog", optValue(connectionBacklog, "N"), "Sets the connection backlog limit for the server socket")
         ("mgmt-enable,m", optValue(enableMgmt,"yes|no"), "Enable Management")
         ("mgmt-publish", optValue(mgmtPublish,"yes|no"), "Enable Publish of Management Data ('no' implies query-only)")
@@ -193,6 +196,7 @@ BrokerOptions::BrokerOptions(const std::string& name) :
         ("default-event-threshold-ratio", optValue(queueThresholdEventRatio, "%age of limit"), "The ratio of any specified queue limit at which an event will be raised")
         ("default-message-group", optValue(defaultMsgGroup, "GROUP-IDENTIFER"), "Group identifier to assign to messages delivered to a message group queue that do not contain an identifier.")
         ("enable-timestamp", optValue(timestampRcvMsgs, "yes|no"), "Add current time to each received message.")
+        ("enable-histograms", optValue(histograms, "yes|no"), "Keep latency and message size histograms for every queue and connection.")
         ("link-maintenance-interval", optValue(linkMaintenanceInterval, "SECONDS"),
          "Interval to check federation link health and re-connect if need be")
         ("link-heartbeat-interval", optValue(linkHeartbeatInterval, "SECONDS"),
@@ -223,7 +227,7 @@ Broker::LogPrefix::~LogPrefix() { QPID_LOG(notice, *this << "shut-down"); }
 
 Broker::Broker(const BrokerOptions& conf) :
     poller(new Poller),
-    timer(new qpid::sys::Timer),
+    timer(new qpid::sys::Timer(conf.timerThreads)),
     config(conf),
     managementAgent(conf.enableMgmt ? new ManagementAgent(conf.qmf1Support,
                                                           conf.qmf2Support)
@@ -440,6 +444,11 @@ bool Broker::getTcpNoDelay() const
     return config.tcpNoDelay;
 }
 
+bool Broker::isKeepingHistograms() const
+{
+    return config.histograms;
+}
+
 uint32_t Broker::getMaxNegotiateTime() const
 {
     return config.maxNegotiateTime;
@@ -632,7 +641,7 @@ Manageable::status_t Broker::ManagementMethod (uint32_t methodId,
             dynamic_cast<_qmf::ArgsBrokerQueueMoveMessages&>(args);
         QPID_LOG (debug, "Broker::queueMoveMessages()");
         if (queueMoveMessages(moveArgs.i_srcQueue, moveArgs.i_destQueue, moveArgs.i_qty,
-                              moveArgs.i_filter, getCurrentPublisher()) >=0)
+                              moveArgs.i_filter, getCurrentPublisher(), moveArgs.i_background) >=0)
             status = Manageable::STATUS_OK;
         else
             return Manageable::STATUS_PARAMETER_INVALID;
@@ -1373,7 +1382,8 @@ int32_t Broker::queueMoveMessages(
      const std::string& destQueue,
      uint32_t  qty,
      const Variant::Map& filter,
-     const Connection* context)
+     const Connection* context,
+     bool background)
 {
     Queue::shared_ptr src_queue = queues.find(srcQueue);
     if (!src_queue)
@@ -1389,6 +1399,8 @@ int32_t Broker::queueMoveMessages(
             throw framing::UnauthorizedAccessException(QPID_MSG("ACL denied move request from " << ((context)?context->getUserId():"(uknown)")));
     }
 
+    if (background)
+        return src_queue->moveInBackground(getTimer(), dest_queue, qty, &filter) ? 0 : -1;
     return (int32_t) src_queue->move(dest_queue, qty, &filter);
 }
 
@@ -246,13 +246,17 @@ class Broker : public sys::Runnable, public Plugin::Target,
         A zero quantity means to move all messages
         Return -1 if one of the queues does not exist, otherwise
                the number of messages moved.
+        If background is true, return 0 at once and move the
+        messages on the broker timer, or -1 if a background
+        purge, reroute or move is already running on srcQueue.
     */
     QPID_BROKER_EXTERN int32_t queueMoveMessages(
         const std::string& srcQueue,
         const std::string& destQueue,
         uint32_t  qty,
         const qpid::types::Variant::Map& filter,
-        const Connection* context);
+        const Connection* context,
+        bool background=false);
 
     QPID_BROKER_EXTERN const TransportInfo& getTransportInfo(
         const std::string& name = TCP_TRANSPORT) const;
@@ -331,6 +335,7 @@ class Broker : public sys::Runnable, public Plugin::Target,
     QPID_BROKER_EXTERN std::string getRealm() const;
     QPID_BROKER_EXTERN std::string getSaslServiceName() const;
     QPID_BROKER_EXTERN bool getTcpNoDelay() const;
+    QPID_BROKER_EXTERN bool isKeepingHistograms() const;
     QPID_BROKER_EXTERN uint16_t getPortOption() const;
     QPID_BROKER_EXTERN const std::vector<std::string>& getListenInterfaces() const;
     QPID_BROKER_EXTERN int getConnectionBacklog() const;
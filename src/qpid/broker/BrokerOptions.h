@@ -50,6 +50,7 @@ struct BrokerOptions : public qpid::Options
     std::vector<std::string> listenDisabled;
     std::vector<std::string> protocols;
     int workerThreads;
+    size_t timerThreads;
     int connectionBacklog;
     bool enableMgmt;
     bool mgmtPublish;
@@ -72,6 +73,7 @@ struct BrokerOptions : public qpid::Options
     uint16_t queueThresholdEventRatio;
     std::string defaultMsgGroup;
     bool timestampRcvMsgs;
+    bool histograms;
     sys::Duration linkMaintenanceInterval;
     sys::Duration linkHeartbeatInterval;
     uint32_t dtxDefaultTimeout; // Default timeout of a DTX transaction
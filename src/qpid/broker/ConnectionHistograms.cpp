@@ -0,0 +1,61 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/ConnectionHistograms.h"
+
+namespace qpid {
+namespace broker {
+
+namespace {
+const std::string MESSAGE_SIZE_FROM_CLIENT("messageSizeFromClient");
+const std::string MESSAGE_SIZE_TO_CLIENT("messageSizeToClient");
+
+void encode(const Histogram& histogram, const std::string& name, qpid::types::Variant::Map& map)
+{
+    qpid::types::Variant::Map encoded;
+    histogram.mapEncode(encoded);
+    map[name] = encoded;
+}
+}
+
+void ConnectionHistograms::fromClient(uint64_t size)
+{
+    sys::Mutex::ScopedLock l(lock);
+    messageSizeFromClient.record(size);
+}
+
+void ConnectionHistograms::toClient(uint64_t size)
+{
+    sys::Mutex::ScopedLock l(lock);
+    messageSizeToClient.record(size);
+}
+
+void ConnectionHistograms::mapEncode(qpid::types::Variant::Map& map, bool reset)
+{
+    sys::Mutex::ScopedLock l(lock);
+    encode(messageSizeFromClient, MESSAGE_SIZE_FROM_CLIENT, map);
+    encode(messageSizeToClient, MESSAGE_SIZE_TO_CLIENT, map);
+    if (reset) {
+        messageSizeFromClient.reset();
+        messageSizeToClient.reset();
+    }
+}
+
+}} // namespace qpid::broker
@@ -0,0 +1,56 @@
+#ifndef QPID_BROKER_CONNECTIONHISTOGRAMS_H
+#define QPID_BROKER_CONNECTIONHISTOGRAMS_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/BrokerImportExport.h"
+#include "qpid/broker/Histogram.h"
+#include "qpid/sys/Mutex.h"
+#include "qpid/types/Variant.h"
+
+namespace qpid {
+namespace broker {
+
+/**
+ * Sizes of the messages a connection receives from and sends to its
+ * client, whichever protocol it speaks.
+ *
+ * Recorded on the connection's IO thread and read by management, so
+ * each call takes the histograms' own lock.
+ */
+class ConnectionHistograms
+{
+  public:
+    QPID_BROKER_EXTERN void fromClient(uint64_t size);
+    QPID_BROKER_EXTERN void toClient(uint64_t size);
+
+    /** Encode the histograms, resetting them if asked to, in one step */
+    QPID_BROKER_EXTERN void mapEncode(qpid::types::Variant::Map&, bool reset);
+
+  private:
+    sys::Mutex lock;
+    Histogram messageSizeFromClient;
+    Histogram messageSizeToClient;
+};
+
+}} // namespace qpid::broker
+
+#endif  /*!QPID_BROKER_CONNECTIONHISTOGRAMS_H*/
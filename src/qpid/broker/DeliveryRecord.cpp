@@ -43,18 +43,36 @@ DeliveryRecord::DeliveryRecord(const QueueCursor& _msg,
                                bool accepted,
                                bool _windowing,
                                uint32_t _credit) : msg(_msg),
-                                                   queue(_queue),
-                                                   tag(_tag),
-                                                   consumer(_consumer),
+                                                   context(new Context(_queue, _tag, _consumer)),
+                                                   credit(_credit),
+                                                   msgId(_msgId),
+                                                   replicationId(_replicationId),
                                                    acquired(_acquired),
                                                    acceptExpected(!accepted),
                                                    cancelled(false),
                                                    completed(false),
                                                    ended(accepted && acquired),
-                                                   windowing(_windowing),
+                                                   windowing(_windowing)
+{}
+
+DeliveryRecord::DeliveryRecord(const QueueCursor& _msg,
+                               framing::SequenceNumber _msgId,
+                               framing::SequenceNumber _replicationId,
+                               const Context::shared_ptr& _context,
+                               bool _acquired,
+                               bool accepted,
+                               bool _windowing,
+                               uint32_t _credit) : msg(_msg),
+                                                   context(_context),
                                                    credit(_credit),
                                                    msgId(_msgId),
-                                                   replicationId(_replicationId)
+                                                   replicationId(_replicationId),
+                                                   acquired(_acquired),
+                                                   acceptExpected(!accepted),
+                                                   cancelled(false),
+                                                   completed(false),
+                                                   ended(accepted && acquired),
+                                                   windowing(_windowing)
 {}
 
 bool DeliveryRecord::setEnded()
@@ -67,14 +85,14 @@ bool DeliveryRecord::setEnded()
 void DeliveryRecord::requeue()
 {
     if (acquired && !ended) {
-        queue->release(msg);
+        context->queue->release(msg);
     }
 }
 
 void DeliveryRecord::release(bool setRedelivered)
 {
     if (acquired && !ended) {
-        queue->release(msg, setRedelivered);
+        context->queue->release(msg, setRedelivered);
         acquired = false;
         setEnded();
     } else {
@@ -89,8 +107,8 @@ void DeliveryRecord::complete()
 
 bool DeliveryRecord::accept(TransactionContext* ctxt) {
     if (!ended) {
-        if (consumer) consumer->acknowledged(*this);
-        if (acquired) queue->dequeue(ctxt, msg);
+        if (context->consumer) context->consumer->acknowledged(*this);
+        if (acquired) context->queue->dequeue(ctxt, msg);
         setEnded();
         QPID_LOG(debug, "Accepted " << id);
     }
@@ -100,21 +118,21 @@ bool DeliveryRecord::accept(TransactionContext* ctxt) {
 void DeliveryRecord::dequeue(TransactionContext* ctxt) const
 {
     if (acquired && !ended) {
-        queue->dequeue(ctxt, msg);
+        context->queue->dequeue(ctxt, msg);
     }
 }
 
 void DeliveryRecord::committed() const
 {
     if (acquired && !ended) {
-        queue->dequeueCommitted(msg);
+        context->queue->dequeueCommitted(msg);
     }
 }
 
 void DeliveryRecord::reject()
 {
     if (acquired && !ended) {
-        queue->reject(msg);
+        context->queue->reject(msg);
         setEnded();
     }
 }
@@ -125,12 +143,12 @@ uint32_t DeliveryRecord::getCredit() const
 }
 
 void DeliveryRecord::acquire(DeliveryIds& results) {
-    if (queue->acquire(msg, tag)) {
+    if (context->queue->acquire(msg, context->tag)) {
         acquired = true;
         results.push_back(id);
         if (!acceptExpected) {
             if (ended) { QPID_LOG(error, "Can't dequeue ended message"); }
-            else { queue->dequeue(0, msg); setEnded(); }
+            else { context->queue->dequeue(0, msg); setEnded(); }
         }
     } else {
         QPID_LOG(info, "Message already acquired " << id.getValue());
@@ -139,7 +157,7 @@ void DeliveryRecord::acquire(DeliveryIds& results) {
 
 void DeliveryRecord::cancel(const std::string& cancelledTag)
 {
-    if (tag == cancelledTag)
+    if (context->tag == cancelledTag)
         cancelled = true;
 }
 
@@ -159,8 +177,8 @@ namespace broker {
 std::ostream& operator<<(std::ostream& out, const DeliveryRecord& r)
 {
     out << "{" << "id=" << r.id.getValue();
-    out << ", tag=" << r.tag << "}";
-    out << ", queue=" << r.queue->getName() << "}";
+    out << ", tag=" << r.context->tag << "}";
+    out << ", queue=" << r.context->queue->getName() << "}";
     return out;
 }
 
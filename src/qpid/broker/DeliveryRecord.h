@@ -47,17 +47,29 @@ class Consumer;
  */
 class DeliveryRecord
 {
+  public:
+    /**
+     * The queue, consumer tag and consumer a delivery was made
+     * for. These are the same for every delivery on a subscription,
+     * so one Context is shared by all of its outstanding records
+     * rather than each record holding copies.
+     */
+    struct Context
+    {
+        typedef boost::shared_ptr<Context> shared_ptr;
+
+        const boost::shared_ptr<Queue> queue;
+        const std::string tag;    // name of consumer
+        const boost::shared_ptr<Consumer> consumer;
+
+        Context(const boost::shared_ptr<Queue>& q, const std::string& t,
+                const boost::shared_ptr<Consumer>& c) : queue(q), tag(t), consumer(c) {}
+    };
+
+  private:
     QueueCursor msg;
-    mutable boost::shared_ptr<Queue> queue;
-    std::string tag;    // name of consumer
-    boost::shared_ptr<Consumer> consumer;
+    Context::shared_ptr context;
     DeliveryId id;
-    bool acquired : 1;
-    bool acceptExpected : 1;
-    bool cancelled : 1;
-    bool completed : 1;
-    bool ended : 1;
-    bool windowing : 1;
 
     /**
      * Record required credit on construction as the pointer to the
@@ -70,6 +82,13 @@ class DeliveryRecord
     framing::SequenceNumber msgId;
     framing::SequenceNumber replicationId;
 
+    bool acquired : 1;
+    bool acceptExpected : 1;
+    bool cancelled : 1;
+    bool completed : 1;
+    bool ended : 1;
+    bool windowing : 1;
+
   public:
     QPID_BROKER_EXTERN DeliveryRecord(const QueueCursor& msgCursor,
                                       framing::SequenceNumber msgId,
@@ -82,6 +101,15 @@ class DeliveryRecord
                                       bool windowing,
                                       uint32_t credit=0 // Only used if msg is empty.
     );
+    QPID_BROKER_EXTERN DeliveryRecord(const QueueCursor& msgCursor,
+                                      framing::SequenceNumber msgId,
+                                      framing::SequenceNumber replicationId,
+                                      const Context::shared_ptr& context,
+                                      bool acquired,
+                                      bool accepted,
+                                      bool windowing,
+                                      uint32_t credit=0
+    );
 
     bool coveredBy(const framing::SequenceSet* const range) const { return range->contains(id); }
 
@@ -105,7 +133,7 @@ class DeliveryRecord
     bool isWindowing() const { return windowing; }
 
     uint32_t getCredit() const;
-    const std::string& getTag() const { return tag; }
+    const std::string& getTag() const { return context->tag; }
 
     void setId(DeliveryId _id) { id = _id; }
 
@@ -115,7 +143,7 @@ class DeliveryRecord
     framing::SequenceNumber getId() const { return id; }
     framing::SequenceNumber getMessageId() const { return msgId; }
     framing::SequenceNumber getReplicationId() const { return replicationId; }
-    boost::shared_ptr<Queue> getQueue() const { return queue; }
+    boost::shared_ptr<Queue> getQueue() const { return context->queue; }
 
     friend std::ostream& operator<<(std::ostream&, const DeliveryRecord&);
 };
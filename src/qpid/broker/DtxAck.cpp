@@ -28,7 +28,9 @@ using namespace qpid::broker;
 
 DtxAck::DtxAck(const qpid::framing::SequenceSet& acked, DeliveryRecords& unacked)
 {
-    remove_copy_if(unacked.begin(), unacked.end(), inserter(pending, pending.end()), 
+    if (acked.empty()) return;
+    AckRange r = DeliveryRecord::findRange(unacked, acked.front(), acked.back());
+    remove_copy_if(r.start, r.end, inserter(pending, pending.end()),
                    not1(bind2nd(mem_fun_ref(&DeliveryRecord::coveredBy), &acked)));
 }
 
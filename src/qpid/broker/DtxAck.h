@@ -25,6 +25,7 @@
 #include <functional>
 #include <list>
 #include "qpid/framing/SequenceSet.h"
+#include "qpid/broker/BrokerImportExport.h"
 #include "qpid/broker/DeliveryRecord.h"
 #include "qpid/broker/TxOp.h"
 
@@ -34,7 +35,7 @@ class DtxAck : public TxOp{
     DeliveryRecords pending;
 
   public:
-    DtxAck(const framing::SequenceSet& acked, DeliveryRecords& unacked);
+    QPID_BROKER_EXTERN DtxAck(const framing::SequenceSet& acked, DeliveryRecords& unacked);
     DtxAck(DeliveryRecords& unacked);
     virtual bool prepare(TransactionContext* ctxt) throw();
     virtual void commit() throw();
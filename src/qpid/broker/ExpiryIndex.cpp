@@ -0,0 +1,74 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/ExpiryIndex.h"
+#include "qpid/broker/Message.h"
+#include <algorithm>
+
+namespace qpid {
+namespace broker {
+
+namespace {
+const size_t MIN_COMPACTION(64);
+}
+
+ExpiryIndex::ExpiryIndex() : limit(MIN_COMPACTION) {}
+
+void ExpiryIndex::add(const Message& m, const Predicate& held)
+{
+    sys::AbsTime expiration = m.getExpiration();
+    if (expiration < sys::FAR_FUTURE) {
+        if (entries.size() >= limit) compact(held);
+        entries.push_back(Entry(expiration, m.getSequence()));
+        std::push_heap(entries.begin(), entries.end());
+    }
+}
+
+bool ExpiryIndex::next(sys::AbsTime now, framing::SequenceNumber& position)
+{
+    if (entries.empty() || !(entries.front().expiration < now)) return false;
+    position = entries.front().position;
+    std::pop_heap(entries.begin(), entries.end());
+    entries.pop_back();
+    return true;
+}
+
+// Orders by position, earliest expiration first for the same position
+bool ExpiryIndex::ByPosition::operator()(const Entry& a, const Entry& b) const
+{
+    uint32_t x(a.position), y(b.position);
+    return x < y || (x == y && a.expiration < b.expiration);
+}
+
+void ExpiryIndex::compact(const Predicate& held)
+{
+    std::vector<Entry> kept;
+    std::sort(entries.begin(), entries.end(), ByPosition());
+    for (std::vector<Entry>::iterator i = entries.begin(); i != entries.end(); ++i) {
+        if ((kept.empty() || !(kept.back().position == i->position)) && held(i->position)) {
+            kept.push_back(*i);
+        }
+    }
+    std::make_heap(kept.begin(), kept.end());
+    entries.swap(kept);
+    limit = std::max(MIN_COMPACTION, 2 * entries.size());
+}
+
+}} // namespace qpid::broker
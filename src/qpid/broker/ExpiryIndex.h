@@ -0,0 +1,91 @@
+#ifndef QPID_BROKER_EXPIRYINDEX_H
+#define QPID_BROKER_EXPIRYINDEX_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/BrokerImportExport.h"
+#include "qpid/framing/SequenceNumber.h"
+#include "qpid/sys/Time.h"
+#include <vector>
+#include <boost/function.hpp>
+
+namespace qpid {
+namespace broker {
+
+class Message;
+
+/**
+ * Index of the positions on a queue of messages that carry a TTL,
+ * ordered by expiration, so that expired messages can be found
+ * without scanning the whole queue.
+ *
+ * Entries are not removed when their message leaves the queue; the
+ * caller is expected to look each position up again and ignore any
+ * that are no longer there. So that such entries do not accumulate on
+ * a queue whose messages are consumed before they expire, the index is
+ * compacted whenever it has doubled in size since it was last
+ * compacted.
+ *
+ * Called by the Queue with its messageLock held; no further locking.
+ */
+class ExpiryIndex
+{
+  public:
+    /** Tests whether the message at a position is still to be indexed */
+    typedef boost::function1<bool, framing::SequenceNumber> Predicate;
+
+    QPID_BROKER_EXTERN ExpiryIndex();
+    /**
+     * Records the message's position if it has an expiration. If the
+     * index needs compacting, entries for positions where held() is
+     * false, and duplicate entries, are dropped first.
+     */
+    QPID_BROKER_EXTERN void add(const Message&, const Predicate& held);
+    /**
+     * Removes the earliest entry if it expired before now.
+     * @returns false if no entry has yet expired
+     */
+    QPID_BROKER_EXTERN bool next(sys::AbsTime now, framing::SequenceNumber& position);
+    size_t size() const { return entries.size(); }
+
+  private:
+    struct Entry
+    {
+        sys::AbsTime expiration;
+        framing::SequenceNumber position;
+
+        Entry(sys::AbsTime e, framing::SequenceNumber p) : expiration(e), position(p) {}
+        bool operator<(const Entry& o) const { return expiration > o.expiration; }
+    };
+    struct ByPosition
+    {
+        bool operator()(const Entry& a, const Entry& b) const;
+    };
+    //a heap with the earliest expiration at the front
+    std::vector<Entry> entries;
+    size_t limit;
+
+    void compact(const Predicate& held);
+};
+
+}} // namespace qpid::broker
+
+#endif  /*!QPID_BROKER_EXPIRYINDEX_H*/
@@ -38,6 +38,11 @@ bool FifoDistributor::acquire(const std::string&, Message& msg)
     }
 }
 
+Message* FifoDistributor::next(const std::string&, QueueCursor& cursor)
+{
+    return messages.next(cursor);
+}
+
 void FifoDistributor::query(qpid::types::Variant::Map&) const
 {
     // nothing to see here....
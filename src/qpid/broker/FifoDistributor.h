@@ -39,6 +39,7 @@ class FifoDistributor : public MessageDistributor
     FifoDistributor(Messages& container);
 
     bool acquire(const std::string& consumer, Message& target);
+    Message* next(const std::string& consumer, QueueCursor& cursor);
     void query(qpid::types::Variant::Map&) const;
 
  private:
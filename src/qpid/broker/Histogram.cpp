@@ -0,0 +1,147 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/Histogram.h"
+#include <algorithm>
+#include <limits>
+
+namespace qpid {
+namespace broker {
+
+namespace {
+const std::string COUNT("count");
+const std::string MIN("min");
+const std::string MAX("max");
+const std::string MEAN("mean");
+const std::string P50("p50");
+const std::string P90("p90");
+const std::string P99("p99");
+const std::string P999("p999");
+const std::string BUCKET_COUNTS("buckets");
+
+uint32_t highestBit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    uint32_t bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+}
+
+Histogram::Histogram() : count(0), total(0), min(std::numeric_limits<uint64_t>::max()), max(0) {}
+
+uint32_t Histogram::bucketFor(uint64_t value)
+{
+    // Values below SUB_BUCKETS are counted exactly; above that each
+    // power of two range [2^n, 2^(n+1)) has SUB_BUCKETS equal buckets.
+    if (value < SUB_BUCKETS) return value;
+    uint32_t shift = highestBit(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t Histogram::lowerBound(uint32_t bucket)
+{
+    uint32_t range = bucket / SUB_BUCKETS;
+    uint64_t offset = bucket % SUB_BUCKETS;
+    if (range == 0) return offset;
+    return (SUB_BUCKETS + offset) << (range - 1);
+}
+
+uint64_t Histogram::upperBound(uint32_t bucket)
+{
+    uint32_t range = bucket / SUB_BUCKETS;
+    uint64_t width = range == 0 ? 1 : uint64_t(1) << (range - 1);
+    return lowerBound(bucket) + (width - 1);
+}
+
+void Histogram::record(uint64_t value)
+{
+    if (buckets.empty()) buckets.resize(BUCKETS);
+    ++buckets[bucketFor(value)];
+    ++count;
+    total += value;
+    if (value < min) min = value;
+    if (value > max) max = value;
+}
+
+void Histogram::reset()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    total = 0;
+    min = std::numeric_limits<uint64_t>::max();
+    max = 0;
+}
+
+void Histogram::add(const Histogram& other)
+{
+    if (!other.count) return;
+    if (buckets.empty()) buckets.resize(BUCKETS);
+    for (uint32_t i = 0; i < other.buckets.size(); ++i)
+        buckets[i] += other.buckets[i];
+    count += other.count;
+    total += other.total;
+    if (other.min < min) min = other.min;
+    if (other.max > max) max = other.max;
+}
+
+uint64_t Histogram::getPercentile(double percent) const
+{
+    if (!count) return 0;
+    uint64_t target = uint64_t((percent / 100.0) * count + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            // Report the bucket bound but never beyond what was seen.
+            uint64_t bound = upperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+void Histogram::mapEncode(qpid::types::Variant::Map& map) const
+{
+    map[COUNT] = count;
+    map[MIN] = getMin();
+    map[MAX] = max;
+    map[MEAN] = count ? total / count : 0;
+    map[P50] = getPercentile(50);
+    map[P90] = getPercentile(90);
+    map[P99] = getPercentile(99);
+    map[P999] = getPercentile(99.9);
+    qpid::types::Variant::List list;
+    for (uint32_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i]) {
+            qpid::types::Variant::List bucket;
+            bucket.push_back(upperBound(i));
+            bucket.push_back(buckets[i]);
+            list.push_back(bucket);
+        }
+    }
+    map[BUCKET_COUNTS] = list;
+}
+
+}} // namespace qpid::broker
@@ -0,0 +1,84 @@
+#ifndef QPID_BROKER_HISTOGRAM_H
+#define QPID_BROKER_HISTOGRAM_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/BrokerImportExport.h"
+#include "qpid/sys/IntegerTypes.h"
+#include "qpid/types/Variant.h"
+#include <vector>
+
+namespace qpid {
+namespace broker {
+
+/**
+ * Log-linear (HDR style) histogram of unsigned 64 bit values.
+ *
+ * Each power of two range is split into SUB_BUCKETS linear buckets,
+ * so any recorded value is reported with a relative error of at most
+ * 1/SUB_BUCKETS whatever its magnitude. Recording is O(1) and does not
+ * allocate once the first value has been seen.
+ *
+ * Not thread safe: callers serialise access.
+ */
+class Histogram
+{
+  public:
+    static const uint32_t SUB_BUCKET_BITS = 3;
+    static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const uint32_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    QPID_BROKER_EXTERN Histogram();
+
+    QPID_BROKER_EXTERN void record(uint64_t value);
+    QPID_BROKER_EXTERN void reset();
+    /** Add all the values recorded in another histogram to this one */
+    QPID_BROKER_EXTERN void add(const Histogram&);
+
+    uint64_t getCount() const { return count; }
+    uint64_t getMin() const { return count ? min : 0; }
+    uint64_t getMax() const { return max; }
+    uint64_t getTotal() const { return total; }
+    /** @return the value below which the given percentage of values lie */
+    QPID_BROKER_EXTERN uint64_t getPercentile(double percent) const;
+
+    /**
+     * Encode as a map holding count, min, max, mean, selected
+     * percentiles and a list of [upper bound, count] pairs for each
+     * non-empty bucket.
+     */
+    QPID_BROKER_EXTERN void mapEncode(qpid::types::Variant::Map&) const;
+
+    QPID_BROKER_EXTERN static uint32_t bucketFor(uint64_t value);
+    QPID_BROKER_EXTERN static uint64_t lowerBound(uint32_t bucket);
+    QPID_BROKER_EXTERN static uint64_t upperBound(uint32_t bucket);
+
+  private:
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+};
+
+}} // namespace qpid::broker
+
+#endif  /*!QPID_BROKER_HISTOGRAM_H*/
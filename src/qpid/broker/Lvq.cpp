@@ -20,6 +20,7 @@
  */
 #include "Lvq.h"
 #include "MessageMap.h"
+#include "QueueHistograms.h"
 #include "qpid/sys/Monitor.h"
 
 namespace qpid {
@@ -38,6 +39,7 @@ void Lvq::push(Message& message, bool isRecovery)
     {
         qpid::sys::Mutex::ScopedLock locker(messageLock);
         message.setSequence(++sequence);
+        if (histograms) histograms->enqueued(message);
         interceptors.publish(message);
         removed = messageMap.update(message, old);
         listeners.populate(copy);
@@ -208,6 +208,14 @@ void Message::setState(MessageState s)
 {
     state = s;
 }
+sys::AbsTime Message::getQueueTime() const
+{
+    return queueTime;
+}
+void Message::setQueueTime(sys::AbsTime t)
+{
+    queueTime = t;
+}
 namespace {
 const qpid::types::Variant::Map EMPTY_MAP;
 }
@@ -237,6 +245,11 @@ Message::SharedState& Message::getSharedState()
 {
     return *sharedState;
 }
+
+const Message::SharedState& Message::getSharedState() const
+{
+    return *sharedState;
+}
 const Message::Encoding& Message::getEncoding() const
 {
     return *sharedState;
@@ -297,7 +310,7 @@ class PropertyRetriever : public MapHandler
 qpid::types::Variant Message::getProperty(const std::string& key) const
 {
     PropertyRetriever r(key);
-    sharedState->processProperties(r);
+    sharedState->processProperty(key, r);
     return r.getResult();
 }
 
@@ -383,4 +396,19 @@ void Message::SharedStateImpl::setIsManagementMessage(bool b)
     isManagementMessage = b;
 }
 
+boost::intrusive_ptr<const RefCounted> Message::SharedStateImpl::getTranslation(const std::string& protocol) const
+{
+    sys::Mutex::ScopedLock l(translationLock);
+    Translations::const_iterator i = translations.find(protocol);
+    if (i != translations.end()) return i->second;
+    else return boost::intrusive_ptr<const RefCounted>();
+}
+
+boost::intrusive_ptr<const RefCounted> Message::SharedStateImpl::cacheTranslation(const std::string& protocol,
+                                                                                  boost::intrusive_ptr<const RefCounted> translation) const
+{
+    sys::Mutex::ScopedLock l(translationLock);
+    return translations.insert(Translations::value_type(protocol, translation)).first->second;
+}
+
 }} // namespace qpid::broker
@@ -26,11 +26,13 @@
 #include "qpid/broker/PersistableMessage.h"
 //TODO: move the following out of framing or replace it
 #include "qpid/framing/SequenceNumber.h"
+#include "qpid/sys/Mutex.h"
 #include "qpid/sys/Time.h"
 #include "qpid/types/Variant.h"
 
 #include "qpid/broker/BrokerImportExport.h"
 
+#include <map>
 #include <string>
 #include <vector>
 #include <boost/intrusive_ptr.hpp>
@@ -76,6 +78,11 @@ public:
         virtual bool getTtl(uint64_t&) const = 0;
         virtual std::string getContent() const = 0;
         virtual void processProperties(qpid::amqp::MapHandler&) const = 0;
+        /**
+         * Pass the named property to the handler; other properties
+         * may also be passed where the encoding cannot pick it out.
+         */
+        virtual void processProperty(const std::string&, qpid::amqp::MapHandler& handler) const { processProperties(handler); }
         virtual std::string getUserId() const = 0;
         virtual uint64_t getTimestamp() const = 0;
         virtual std::string getTo() const = 0;
@@ -98,13 +105,29 @@ public:
 
         virtual bool getIsManagementMessage() const = 0;
         virtual void setIsManagementMessage(bool b) = 0;
+
+        /**
+         * Translations of this message into other protocols are cached
+         * here, keyed by protocol, so that a message delivered many
+         * times need only be translated once.
+         */
+        virtual boost::intrusive_ptr<const RefCounted> getTranslation(const std::string& protocol) const = 0;
+        /**
+         * @returns the cached translation, which is the one passed in
+         * unless another was cached first
+         */
+        virtual boost::intrusive_ptr<const RefCounted> cacheTranslation(const std::string& protocol,
+                                                                        boost::intrusive_ptr<const RefCounted>) const = 0;
     };
 
     class SharedStateImpl : public SharedState
     {
+        typedef std::map<std::string, boost::intrusive_ptr<const RefCounted> > Translations;
         const Connection* publisher;
         qpid::sys::AbsTime expiration;
         bool isManagementMessage;
+        mutable qpid::sys::Mutex translationLock;
+        mutable Translations translations;
       public:
         QPID_BROKER_EXTERN SharedStateImpl();
         virtual ~SharedStateImpl() {}
@@ -116,6 +139,9 @@ public:
         QPID_BROKER_EXTERN void computeExpiration();
         QPID_BROKER_EXTERN bool getIsManagementMessage() const;
         QPID_BROKER_EXTERN void setIsManagementMessage(bool b);
+        QPID_BROKER_EXTERN boost::intrusive_ptr<const RefCounted> getTranslation(const std::string& protocol) const;
+        QPID_BROKER_EXTERN boost::intrusive_ptr<const RefCounted> cacheTranslation(const std::string& protocol,
+                                                                                  boost::intrusive_ptr<const RefCounted>) const;
     };
 
     QPID_BROKER_EXTERN Message(boost::intrusive_ptr<SharedState>, boost::intrusive_ptr<PersistableMessage>);
@@ -161,14 +187,18 @@ public:
     QPID_BROKER_EXTERN const Encoding& getEncoding() const;
     QPID_BROKER_EXTERN operator bool() const;
     QPID_BROKER_EXTERN SharedState& getSharedState();
+    QPID_BROKER_EXTERN const SharedState& getSharedState() const;
 
     bool getIsManagementMessage() const;
 
     QPID_BROKER_EXTERN qpid::framing::SequenceNumber getSequence() const;
     QPID_BROKER_EXTERN void setSequence(const qpid::framing::SequenceNumber&);
 
-    MessageState getState() const;
-    void setState(MessageState);
+    QPID_BROKER_EXTERN MessageState getState() const;
+    QPID_BROKER_EXTERN void setState(MessageState);
+    /** Time this copy last changed state on its queue; only set for queues keeping histograms */
+    QPID_BROKER_EXTERN sys::AbsTime getQueueTime() const;
+    QPID_BROKER_EXTERN void setQueueTime(sys::AbsTime);
 
     QPID_BROKER_EXTERN qpid::types::Variant getAnnotation(const std::string& key) const;
     QPID_BROKER_EXTERN const qpid::types::Variant::Map& getAnnotations() const;
@@ -223,6 +253,7 @@ public:
     bool alreadyAcquired;
     Optional<qpid::types::Variant::Map> annotations;
     MessageState state;
+    sys::AbsTime queueTime;
     qpid::framing::SequenceNumber sequence;
     framing::SequenceNumber replicationId;
     bool isReplicationIdSet:1;
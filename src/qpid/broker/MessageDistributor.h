@@ -30,6 +30,7 @@ namespace qpid {
 namespace broker {
 
 class Message;
+class QueueCursor;
 
 class MessageDistributor
 {
@@ -44,6 +45,15 @@ class MessageDistributor
      */
     virtual bool acquire(const std::string& consumer, Message& target) = 0;
 
+    /**
+     * Locate the next message the named consumer should be offered, and
+     * move the consumer's cursor to it.
+     * @param consumer the name of the consumer requesting a message
+     * @param cursor the consumer's position in the queue
+     * @return the message, or 0 if there is nothing the consumer could acquire
+     */
+    virtual Message* next(const std::string& consumer, QueueCursor& cursor) = 0;
+
     /** hook to add any interesting management state to the status map */
     virtual void query(qpid::types::Variant::Map&) const = 0;
 };
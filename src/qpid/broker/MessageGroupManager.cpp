@@ -57,28 +57,65 @@ MessageGroupManager::GroupState::findMsg(const qpid::framing::SequenceNumber &po
 {
     MessageState mState(position);
     MessageFifo::iterator found = std::lower_bound(members.begin(), members.end(), mState);
-    return (found->position == position) ? found : members.end();
+    return (found != members.end() && found->position == position) ? found : members.end();
 }
 
-void MessageGroupManager::unFree( const GroupState& state )
+const std::string& MessageGroupManager::GroupState::ownerName() const
 {
-    GroupFifo::iterator pos = freeGroups.find( state.members.front().position );
-    assert( pos != freeGroups.end() && pos->second == &state );
-    freeGroups.erase( pos );
+    static const std::string none;
+    return owner ? *owner->name : none;
+}
+
+MessageGroupManager::GroupFifo& MessageGroupManager::readyFifo( GroupState& state )
+{
+    return state.owned() ? state.owner->ready : freeGroups;
+}
+
+/** (re)index the group by its oldest unacquired message at or after from, if any */
+void MessageGroupManager::schedule( GroupState& state, GroupState::MessageFifo::iterator from )
+{
+    unschedule(state);
+    while (from != state.members.end() && from->acquired) ++from;
+    if (from != state.members.end()) {
+        state.readyAt = from->position;
+        state.ready = true;
+        assert(readyFifo(state).find(state.readyAt) == readyFifo(state).end());
+        readyFifo(state)[state.readyAt] = &state;
+    }
+}
+
+void MessageGroupManager::unschedule( GroupState& state )
+{
+    if (state.ready) {
+        GroupFifo::iterator pos = readyFifo(state).find( state.readyAt );
+        assert( pos != readyFifo(state).end() && pos->second == &state );
+        readyFifo(state).erase( pos );
+        state.ready = false;
+    }
 }
 
 void MessageGroupManager::own( GroupState& state, const std::string& owner )
 {
-    state.owner = owner;
-    unFree( state );
+    unschedule( state );
+    OwnerMap::iterator i = owners.insert(OwnerMap::value_type(owner, OwnerState())).first;
+    if (!i->second.name) i->second.name = &i->first;    // new owner, assign name
+    i->second.groups += 1;
+    state.owner = &i->second;
+    schedule( state, state.members.begin() );
 }
 
 void MessageGroupManager::disown( GroupState& state )
 {
-    state.owner.clear();
-    assert(state.members.size());
-    assert(freeGroups.find(state.members.front().position) == freeGroups.end());
-    freeGroups[state.members.front().position] = &state;
+    assert(state.owned());
+    unschedule( state );
+    OwnerState& owner = *state.owner;
+    state.owner = 0;
+    if (--owner.groups == 0) {
+        assert(owner.ready.empty());
+        std::string key(*owner.name);
+        owners.erase( key );
+    }
+    if (state.members.size()) schedule( state, state.members.begin() );
 }
 
 MessageGroupManager::GroupState& MessageGroupManager::findGroup( const Message& m )
@@ -100,9 +137,10 @@ MessageGroupManager::GroupState& MessageGroupManager::findGroup( const Message&
 
     misses++;
 
-    GroupState& found = messageGroups[group];
-    if (found.group.empty())
-        found.group = group;    // new group, assign name
+    GroupMap::iterator i = messageGroups.insert(GroupMap::value_type(group, GroupState())).first;
+    GroupState& found = i->second;
+    if (!found.group)
+        found.group = &i->first;    // new group, assign name
     lastMsg = thisMsg;
     lastGroup = group;
     cachedGroup = &found;
@@ -119,11 +157,10 @@ void MessageGroupManager::enqueued( const Message& m )
     state.members.push_back(mState);
     uint32_t total = state.members.size();
     QPID_LOG( trace, "group queue " << qName <<
-              ": added message to group id=" << state.group << " total=" << total );
-    if (total == 1) {
-        // newly created group, no owner
-        assert(freeGroups.find(m.getSequence()) == freeGroups.end());
-        freeGroups[m.getSequence()] = &state;
+              ": added message to group id=" << *state.group << " total=" << total );
+    if (!state.ready) {
+        // no older message in the group is waiting to be acquired
+        schedule(state, state.members.end() - 1);
     }
 }
 
@@ -137,8 +174,11 @@ void MessageGroupManager::acquired( const Message& m )
     assert(gm != state.members.end());
     gm->acquired = true;
     state.acquired += 1;
+    if (state.ready && state.readyAt == gm->position) {
+        schedule(state, gm);
+    }
     QPID_LOG( trace, "group queue " << qName <<
-              ": acquired message in group id=" << state.group << " acquired=" << state.acquired );
+              ": acquired message in group id=" << *state.group << " acquired=" << state.acquired );
 }
 
 
@@ -154,11 +194,13 @@ void MessageGroupManager::requeued( const Message& m )
     i->acquired = false;
     if (state.acquired == 0 && state.owned()) {
         QPID_LOG( trace, "group queue " << qName <<
-                  ": consumer name=" << state.owner << " released group id=" << state.group);
+                  ": consumer name=" << state.ownerName() << " released group id=" << *state.group);
         disown(state);
+    } else if (!state.ready || i->position < state.readyAt) {
+        schedule(state, i);
     }
     QPID_LOG( trace, "group queue " << qName <<
-              ": requeued message to group id=" << state.group << " acquired=" << state.acquired );
+              ": requeued message to group id=" << *state.group << " acquired=" << state.acquired );
 }
 
 
@@ -174,35 +216,32 @@ void MessageGroupManager::dequeued( const Message& m )
         state.acquired -= 1;
     }
 
-    // special case if qm is first (oldest) message in the group:
-    // may need to re-insert it back on the freeGroups list, as the index will change
-    bool reFreeNeeded = false;
+    // if the group is indexed by this message (e.g. mgmt is dequeueing rather
+    // than a consumer), it must be re-indexed by the next unacquired message
+    bool reindex = state.ready && state.readyAt == i->position;
+    if (reindex) unschedule(state);
     if (i == state.members.begin()) {
-        if (!state.owned()) {
-            // will be on the freeGroups list if mgmt is dequeueing rather than a consumer!
-            // if on freelist, it is indexed by first member, which is about to be removed!
-            unFree(state);
-            reFreeNeeded = true;
-        }
         state.members.pop_front();
+        i = state.members.begin();
     } else {
-        state.members.erase(i);
+        i = state.members.erase(i);
     }
 
     uint32_t total = state.members.size();
     QPID_LOG( trace, "group queue " << qName <<
-              ": dequeued message from group id=" << state.group << " total=" << total );
+              ": dequeued message from group id=" << *state.group << " total=" << total );
 
     if (total == 0) {
-        QPID_LOG( trace, "group queue " << qName << ": deleting group id=" << state.group);
+        QPID_LOG( trace, "group queue " << qName << ": deleting group id=" << *state.group);
+        if (state.owned()) disown(state);
         if (cachedGroup == &state) {
             cachedGroup = 0;
         }
-        std::string key(state.group);
+        std::string key(*state.group);
         messageGroups.erase( key );
     } else if (state.acquired == 0 && state.owned()) {
         QPID_LOG( trace, "group queue " << qName <<
-                  ": consumer name=" << state.owner << " released group id=" << state.group);
+                  ": consumer name=" << state.ownerName() << " released group id=" << *state.group);
         disown(state);
         MessageDeque* md = dynamic_cast<MessageDeque*>(&messages);
         if (md) {
@@ -210,11 +249,16 @@ void MessageGroupManager::dequeued( const Message& m )
         } else {
             QPID_LOG(warning, "Could not reset cursors for message group, unexpected container type");
         }
-    } else if (reFreeNeeded) {
-        disown(state);
+    } else if (reindex) {
+        schedule(state, i);
     }
 }
 
+bool MessageGroupManager::isFifo( Messages& container )
+{
+    return dynamic_cast<MessageDeque*>(&container) != 0;
+}
+
 MessageGroupManager::~MessageGroupManager()
 {
     QPID_LOG( debug, "group queue " << qName << " cache results: hits=" << hits << " misses=" << misses );
@@ -229,9 +273,9 @@ bool MessageGroupManager::acquire(const std::string& consumer, Message& m)
         if (!state.owned()) {
             own( state, consumer );
             QPID_LOG( trace, "group queue " << qName <<
-                      ": consumer name=" << consumer << " has acquired group id=" << state.group);
+                      ": consumer name=" << consumer << " has acquired group id=" << *state.group);
         }
-        if (state.owner == consumer) {
+        if (state.ownerName() == consumer) {
             m.setState(ACQUIRED);
             return true;
         } else {
@@ -242,6 +286,32 @@ bool MessageGroupManager::acquire(const std::string& consumer, Message& m)
     }
 }
 
+/**
+ * The next message for a consumer is the oldest unacquired message of either
+ * a group it already owns or a free group; both are at the head of a ready
+ * fifo, so blocked groups are never visited. That only holds when the
+ * container is itself in sequence order: other containers (e.g. priority
+ * queues) are walked from the consumer's cursor as before.
+ */
+Message* MessageGroupManager::next(const std::string& consumer, QueueCursor& cursor)
+{
+    if (!fifo) return messages.next(cursor);
+    GroupState* candidate = freeGroups.empty() ? 0 : freeGroups.begin()->second;
+    OwnerMap::iterator o = owners.find(consumer);
+    if (o != owners.end() && !o->second.ready.empty()) {
+        GroupState* owned = o->second.ready.begin()->second;
+        if (!candidate || owned->readyAt < candidate->readyAt) candidate = owned;
+    }
+    if (!candidate) return 0;
+    Message* m = messages.find(candidate->readyAt, &cursor);
+    if (!m) {
+        QPID_LOG(warning, "group queue " << qName << ": no message at " << candidate->readyAt
+                 << " for group id=" << *candidate->group << ", scanning");
+        m = messages.next(cursor);
+    }
+    return m;
+}
+
 void MessageGroupManager::query(qpid::types::Variant::Map& status) const
 {
     /** Add a description of the current state of the message groups for this queue.
@@ -277,7 +347,7 @@ void MessageGroupManager::query(qpid::types::Variant::Map& status) const
                 info[GROUP_TIMESTAMP] = m->getTimestamp();
             }
         }
-        info[GROUP_CONSUMER] = g->second.owner;
+        info[GROUP_CONSUMER] = g->second.ownerName();
         groups.push_back(info);
     }
     state[GROUP_STATE_KEY] = groups;
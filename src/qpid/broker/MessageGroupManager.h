@@ -32,6 +32,7 @@
 
 #include "boost/shared_ptr.hpp"
 #include <deque>
+#include <map>
 
 namespace qpid {
 namespace broker {
@@ -50,6 +51,21 @@ class MessageGroupManager : public QueueObserver, public MessageDistributor
     const unsigned int timestamp;       // mark messages with timestamp if set
     Messages& messages;                 // parent Queue's in memory message container
     const std::string qName;            // name of parent queue (for logs)
+    const bool fifo;                    // container hands out messages in sequence order
+
+    struct GroupState;
+    typedef std::map<qpid::framing::SequenceNumber, struct GroupState *> GroupFifo;
+
+    // a consumer that owns at least one group; the consumer name is held once,
+    // as the key in the owners map, rather than copied into every owned group
+    struct OwnerState {
+        const std::string* name;
+        uint32_t groups;    // count of groups owned by this consumer
+        GroupFifo ready;    // owned groups with unacquired msgs, by oldest unacquired msg
+
+        OwnerState() : name(0), groups(0) {}
+    };
+    typedef sys::unordered_map<std::string, OwnerState> OwnerMap;
 
     struct GroupState {
         // note: update getState()/setState() when changing this object's state implementation
@@ -64,22 +80,24 @@ class MessageGroupManager : public QueueObserver, public MessageDistributor
         };
         typedef std::deque<MessageState> MessageFifo;
 
-        std::string group;  // group identifier
-        std::string owner;  // consumer with outstanding acquired messages
+        const std::string* group;  // group identifier (the key in messageGroups)
+        OwnerState* owner;  // consumer with outstanding acquired messages
         uint32_t acquired;  // count of outstanding acquired messages
         MessageFifo members;   // msgs belonging to this group, in enqueue order
+        bool ready;         // true if on a ready fifo, indexed by readyAt
+        qpid::framing::SequenceNumber readyAt; // oldest unacquired msg when ready
 
-        GroupState() : acquired(0) {}
-        bool owned() const {return !owner.empty();}
+        GroupState() : group(0), owner(0), acquired(0), ready(false) {}
+        bool owned() const {return owner != 0;}
+        const std::string& ownerName() const;
         MessageFifo::iterator findMsg(const qpid::framing::SequenceNumber &);
     };
 
     typedef sys::unordered_map<std::string, struct GroupState> GroupMap;
-    typedef std::map<qpid::framing::SequenceNumber, struct GroupState *> GroupFifo;
 
     GroupMap messageGroups; // index: group name
-    GroupFifo freeGroups;   // ordered by oldest free msg
-    //Consumers consumers;    // index: consumer name
+    GroupFifo freeGroups;   // unowned groups, ordered by oldest free msg
+    OwnerMap owners;        // index: consumer name
 
     GroupState& findGroup( const Message& m );
     unsigned long hits, misses; // for debug
@@ -87,7 +105,10 @@ class MessageGroupManager : public QueueObserver, public MessageDistributor
     std::string lastGroup;
     GroupState *cachedGroup;
 
-    void unFree( const GroupState& state );
+    GroupFifo& readyFifo( GroupState& state );
+    void schedule( GroupState& state, GroupState::MessageFifo::iterator from );
+    void unschedule( GroupState& state );
+    static bool isFifo( Messages& container );
     void own( GroupState& state, const std::string& owner );
     void disown( GroupState& state );
 
@@ -97,14 +118,14 @@ class MessageGroupManager : public QueueObserver, public MessageDistributor
     static const std::string qpidMessageGroupTimestamp;
 
     static QPID_BROKER_EXTERN void setDefaults(const std::string& groupId);
-    static boost::shared_ptr<MessageGroupManager> create( const std::string& qName,
-                                                          Messages& messages,
-                                                          const QueueSettings& settings );
+    static QPID_BROKER_EXTERN boost::shared_ptr<MessageGroupManager> create( const std::string& qName,
+                                                                             Messages& messages,
+                                                                             const QueueSettings& settings );
 
     MessageGroupManager(const std::string& header, const std::string& _qName,
                         Messages& container, unsigned int _timestamp=0 )
       : groupIdHeader( header ), timestamp(_timestamp), messages(container),
-        qName(_qName),
+        qName(_qName), fifo(isFifo(container)),
         hits(0), misses(0),
         lastMsg(0), cachedGroup(0) {}
     virtual ~MessageGroupManager();
@@ -119,6 +140,7 @@ class MessageGroupManager : public QueueObserver, public MessageDistributor
 
     // MessageDistributor iface
     bool acquire(const std::string& c, Message& );
+    Message* next(const std::string& c, QueueCursor& );
     void query(qpid::types::Variant::Map&) const;
 
     bool match(const qpid::types::Variant::Map*, const Message&) const;
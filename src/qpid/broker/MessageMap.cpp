@@ -28,6 +28,13 @@ namespace qpid {
 namespace broker {
 namespace {
 const std::string EMPTY;
+//tombstones are only compacted away once there are at least this many
+const size_t MIN_COMPACTION(1024);
+
+bool sequenceLess(const Message& m, const framing::SequenceNumber& s)
+{
+    return m.getSequence() < s;
+}
 }
 
 
@@ -36,23 +43,31 @@ std::string MessageMap::getKey(const Message& message)
     return message.getPropertyAsString(key);
 }
 
+bool MessageMap::isTombstone(const Message& message)
+{
+    return message.getState() == DELETED;
+}
+
 size_t MessageMap::size()
 {
     size_t count(0);
     for (Ordering::iterator i = messages.begin(); i != messages.end(); ++i) {
-        if (i->second.getState() == AVAILABLE) ++count;
+        if (i->getState() == AVAILABLE) ++count;
     }
     return count;
 }
 
 bool MessageMap::empty()
 {
-    return size() == 0;//TODO: more efficient implementation
+    for (Ordering::iterator i = messages.begin(); i != messages.end(); ++i) {
+        if (i->getState() == AVAILABLE) return false;
+    }
+    return true;
 }
 
 bool MessageMap::deleted(const QueueCursor& cursor)
 {
-    Ordering::iterator i = messages.find(cursor.position);
+    Ordering::iterator i = locate(cursor.position);
     if (i != messages.end()) {
         erase(i);
         return true;
@@ -69,10 +84,11 @@ Message* MessageMap::find(const QueueCursor& cursor)
 
 Message* MessageMap::find(const framing::SequenceNumber& position, QueueCursor* cursor)
 {
-    Ordering::iterator i = messages.lower_bound(position);
+    Ordering::iterator i = lowerBound(position);
+    while (i != messages.end() && isTombstone(*i)) ++i;
     if (i != messages.end()) {
-        if (cursor) cursor->setPosition(i->first, version);
-        if (i->first == position) return &(i->second);
+        if (cursor) cursor->setPosition(i->getSequence(), version);
+        if (i->getSequence() == position) return &(*i);
         else return 0;
     } else {
         //there is no message whose sequence is greater than position,
@@ -91,26 +107,50 @@ Message* MessageMap::next(QueueCursor& cursor)
 {
     Ordering::iterator i;
     if (reset(cursor)) i = messages.begin(); //start with oldest message
-    else i = messages.upper_bound(cursor.position); //get first message that is greater than position
+    else {
+        //get first message that is greater than position
+        i = lowerBound(cursor.position);
+        if (i != messages.end() && i->getSequence() == framing::SequenceNumber(cursor.position)) ++i;
+    }
 
     while (i != messages.end()) {
-        Message& m = i->second;
-        cursor.setPosition(m.getSequence(), version);
-        if (cursor.check(m)) {
-            return &m;
-        } else {
-            ++i;
+        Message& m = *i;
+        if (!isTombstone(m)) {
+            cursor.setPosition(m.getSequence(), version);
+            if (cursor.check(m)) {
+                return &m;
+            }
         }
+        ++i;
     }
     return 0;
 }
 
-const Message& MessageMap::replace(const Message& original, const Message& update)
+MessageMap::Ordering::iterator MessageMap::at(size_t slot)
 {
-    messages.erase(original.getSequence());
-    std::pair<Ordering::iterator, bool> i = messages.insert(Ordering::value_type(update.getSequence(), update));
-    i.first->second.setState(AVAILABLE);
-    return i.first->second;
+    return messages.begin() + (slot - offset);
+}
+
+/**
+ * @return the slot the message was added at
+ */
+size_t MessageMap::insert(const Message& added)
+{
+    Ordering::iterator i;
+    if (messages.empty() || messages.back().getSequence() < added.getSequence()) {
+        messages.push_back(added);
+        i = messages.end() - 1;
+    } else {
+        //only expected if the queue's position has been moved back; each
+        //later message moves up a slot
+        i = messages.insert(lowerBound(added.getSequence()), added);
+        size_t inserted = offset + (i - messages.begin());
+        for (Index::iterator j = index.begin(); j != index.end(); ++j) {
+            if (j->second >= inserted) ++(j->second);
+        }
+    }
+    i->setState(AVAILABLE);
+    return offset + (i - messages.begin());
 }
 
 void MessageMap::publish(const Message& added)
@@ -121,29 +161,32 @@ void MessageMap::publish(const Message& added)
 
 bool MessageMap::update(const Message& added, Message& removed)
 {
-    std::pair<Index::iterator, bool> result = index.insert(Index::value_type(getKey(added), added));
+    if (tombstones > MIN_COMPACTION && tombstones > messages.size() / 2) compact();
+    std::pair<Index::iterator, bool> result = index.insert(Index::value_type(getKey(added), 0));
     if (result.second) {
         //there was no previous message for this key; nothing needs to
         //be removed, just add the message into its correct position
-        messages.insert(Ordering::value_type(added.getSequence(), added)).first->second.setState(AVAILABLE);
+        result.first->second = insert(added);
         return false;
     } else {
         //there is already a message with that key which needs to be replaced
-        removed = result.first->second;
-        result.first->second = replace(result.first->second, added);
-        result.first->second.setState(AVAILABLE);
-        QPID_LOG(debug, "Displaced message at " << removed.getSequence() << " with " << result.first->second.getSequence() << ": " << result.first->first);
+        Ordering::iterator i = at(result.first->second);
+        assert(!isTombstone(*i));
+        removed = *i;
+        bury(i);
+        result.first->second = insert(added);
+        QPID_LOG(debug, "Displaced message at " << removed.getSequence() << " with " << added.getSequence() << ": " << result.first->first);
         return true;
     }
 }
 
 Message* MessageMap::release(const QueueCursor& cursor)
 {
-    Ordering::iterator i = messages.find(cursor.position);
+    Ordering::iterator i = locate(cursor.position);
     if (i != messages.end()) {
-        i->second.setState(AVAILABLE);
+        i->setState(AVAILABLE);
         version++;
-        return &i->second;
+        return &(*i);
     } else {
         return 0;
     }
@@ -152,16 +195,68 @@ Message* MessageMap::release(const QueueCursor& cursor)
 void MessageMap::foreach(Functor f)
 {
     for (Ordering::iterator i = messages.begin(); i != messages.end(); ++i) {
-        if (i->second.getState() == AVAILABLE) f(i->second);
+        if (i->getState() == AVAILABLE) f(*i);
     }
 }
 
 void MessageMap::erase(Ordering::iterator i)
 {
-    index.erase(getKey(i->second));
-    messages.erase(i);
+    index.erase(getKey(*i));
+    bury(i);
+}
+
+/**
+ * Replace a message with a tombstone holding only its sequence, then
+ * drop any tombstones at the front.
+ */
+void MessageMap::bury(Ordering::iterator i)
+{
+    framing::SequenceNumber sequence = i->getSequence();
+    *i = Message();
+    i->setSequence(sequence);
+    i->setState(DELETED);
+    ++tombstones;
+    while (!messages.empty() && isTombstone(messages.front())) {
+        messages.pop_front();
+        --tombstones;
+        ++offset;
+    }
+}
+
+void MessageMap::compact()
+{
+    std::vector<size_t> moved(messages.size());
+    Ordering::iterator live = messages.begin();
+    for (Ordering::iterator i = messages.begin(); i != messages.end(); ++i) {
+        if (!isTombstone(*i)) {
+            moved[i - messages.begin()] = offset + (live - messages.begin());
+            if (live != i) std::swap(*live, *i);
+            ++live;
+        }
+    }
+    messages.erase(live, messages.end());
+    for (Index::iterator i = index.begin(); i != index.end(); ++i) {
+        i->second = moved[i->second - offset];
+    }
+    tombstones = 0;
+}
+
+MessageMap::Ordering::iterator MessageMap::lowerBound(const framing::SequenceNumber& position)
+{
+    return std::lower_bound(messages.begin(), messages.end(), position, sequenceLess);
+}
+
+/**
+ * @return the live message at the given position, or end() if there
+ * is none
+ */
+MessageMap::Ordering::iterator MessageMap::locate(const framing::SequenceNumber& position)
+{
+    Ordering::iterator i = lowerBound(position);
+    if (i != messages.end() && i->getSequence() == position && !isTombstone(*i)) return i;
+    else return messages.end();
 }
 
-MessageMap::MessageMap(const std::string& k) : key(k), version(0) {}
+MessageMap::MessageMap(const std::string& k) : key(k), offset(0), tombstones(0), version(0) {}
 
 }} // namespace qpid::broker
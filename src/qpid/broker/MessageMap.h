@@ -24,8 +24,10 @@
 #include "qpid/broker/Messages.h"
 #include "qpid/broker/Message.h"
 #include "qpid/framing/SequenceNumber.h"
-#include <map>
+#include "qpid/sys/unordered_map.h"
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace qpid {
 namespace broker {
@@ -34,6 +36,19 @@ namespace broker {
  * Provides a last value queue behaviour, whereby a messages replace
  * any previous message with the same value for a defined property
  * (i.e. the key).
+ *
+ * Each message is held once, in a deque ordered by sequence number.
+ * A hash index maps each key to the slot of its current message. Slots
+ * are numbered from the first message the map held, so dropping
+ * messages from the front of the deque only moves the offset of the
+ * first slot. Removed messages are left in the deque as tombstones,
+ * which are dropped from the front as they reach it and compacted away
+ * when they outnumber the live messages.
+ *
+ * Compaction moves the live messages, so it is only done when a
+ * message is published. Pointers returned by find() and next() remain
+ * valid while the queue's lock is held, as long as nothing is
+ * published and the queue's position is not moved back.
  */
 class MessageMap : public Messages
 {
@@ -55,17 +70,25 @@ class MessageMap : public Messages
     bool update(const Message& added, Message& removed);
 
   protected:
-    typedef std::map<std::string, Message> Index;
-    typedef std::map<framing::SequenceNumber, Message> Ordering;
+    typedef qpid::sys::unordered_map<std::string, size_t> Index; // key to slot
+    typedef std::deque<Message> Ordering;
     const std::string key;
     Index index;
     Ordering messages;
+    size_t offset;              // slot of the front of messages
+    size_t tombstones;
     int32_t version;
 
     std::string getKey(const Message&);
-    virtual const Message& replace(const Message&, const Message&);
+    Ordering::iterator at(size_t slot);
+    size_t insert(const Message&);
     void erase(Ordering::iterator);
+    void bury(Ordering::iterator);
+    void compact();
+    Ordering::iterator lowerBound(const framing::SequenceNumber&);
+    Ordering::iterator locate(const framing::SequenceNumber&);
     bool reset(const QueueCursor& cursor);
+    static bool isTombstone(const Message&);
 };
 }} // namespace qpid::broker
 
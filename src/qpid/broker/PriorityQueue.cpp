@@ -36,6 +36,30 @@ class PriorityContext : public CursorContext {
     std::vector<QueueCursor> position;
     PriorityContext(size_t levels, SubscriptionType type) : position(levels, QueueCursor(type)) {}
 };
+
+const int BITS = 64;
+
+int highestBit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+int lowestBit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int bit = 0;
+    while (!(value & 1)) { value >>= 1; ++bit; }
+    return bit;
+#endif
+}
 }
 
 
@@ -43,6 +67,8 @@ PriorityQueue::PriorityQueue(int l) :
     levels(l),
     messages(levels, Deque(boost::bind(&PriorityQueue::priorityPadding, this, _1))),
     counters(levels, framing::SequenceNumber()),
+    depths(levels, 0),
+    occupied((levels + BITS - 1) / BITS, 0),
     fifo(boost::bind(&PriorityQueue::fifoPadding, this, _1)),
     frontLevel(0), haveFront(false), cached(false)
 {
@@ -55,8 +81,11 @@ bool PriorityQueue::deleted(const QueueCursor& c)
         //mark the message as deleted
         ptr->holder->message.setState(DELETED);
         //clean the deque for the relevant priority level
-        boost::shared_ptr<PriorityContext> ctxt = boost::dynamic_pointer_cast<PriorityContext>(c.context);
-        messages[ptr->holder->priority].clean();
+        int priority = ptr->holder->priority;
+        messages[priority].clean();
+        if (--depths[priority] == 0) {
+            occupied[priority / BITS] &= ~(uint64_t(1) << (priority % BITS));
+        }
         //stop referencing that message holder (it may now have been
         //deleted)
         ptr->holder = 0;
@@ -87,7 +116,7 @@ Message* PriorityQueue::next(QueueCursor& cursor)
     } else if (cursor.type == PURGE) {
         //iterate over message in reverse priority order (i.e. purge lowest priority message first)
         //ignore any fairshare configuration here as well
-        for (int p = 0; p < levels; ++p) {
+        for (int p = lowestOccupied(0); p >= 0; p = lowestOccupied(p + 1)) {
             MessageHolder* holder = messages[p].next(ctxt->position[p]);
             if (holder) {
                 cursor.setPosition(holder->message.getSequence(), 0);
@@ -96,9 +125,12 @@ Message* PriorityQueue::next(QueueCursor& cursor)
         }
         return 0;
     } else {
-        //check each level in turn, in priority order, for any more messages
+        //check each level holding messages in turn, in priority order,
+        //for any more messages
         Priority p = firstLevel();
+        if (p.current < 0) return 0;
         do {
+            if (!isOccupied(p.current)) continue;
             MessageHolder* holder = messages[p.current].next(ctxt->position[p.current]);
             if (holder) {
                 cursor.setPosition(holder->message.getSequence(), 0);
@@ -126,6 +158,9 @@ void PriorityQueue::publish(const Message& published)
     holder.message = published;
     holder.priority = getPriorityLevel(published);
     holder.id = ++(counters[holder.priority]);
+    if (depths[holder.priority]++ == 0) {
+        occupied[holder.priority / BITS] |= uint64_t(1) << (holder.priority % BITS);
+    }
     MessagePointer pointer;
     pointer.holder = &(messages[holder.priority].publish(holder));
     pointer.id = published.getSequence();
@@ -175,16 +210,43 @@ PriorityQueue::MessageHolder PriorityQueue::priorityPadding(qpid::framing::Seque
 
 PriorityQueue::Priority PriorityQueue::firstLevel()
 {
-    return Priority(levels - 1);
+    return Priority(highestOccupied(levels - 1));
 }
 bool PriorityQueue::nextLevel(Priority& p)
 {
-    if (p.current > 0) {
-        --(p.current);
-        return true;
-    } else {
-        return false;
+    p.current = highestOccupied(p.current - 1);
+    return p.current >= 0;
+}
+
+bool PriorityQueue::isOccupied(int level) const
+{
+    return occupied[level / BITS] & (uint64_t(1) << (level % BITS));
+}
+
+int PriorityQueue::highestOccupied(int level) const
+{
+    if (level < 0) return -1;
+    int word = level / BITS;
+    //ignore the levels above the one given
+    uint64_t bits = occupied[word] & (~uint64_t(0) >> (BITS - 1 - level % BITS));
+    while (!bits) {
+        if (word == 0) return -1;
+        bits = occupied[--word];
+    }
+    return word * BITS + highestBit(bits);
+}
+
+int PriorityQueue::lowestOccupied(int level) const
+{
+    if (level >= levels) return -1;
+    int word = level / BITS;
+    //ignore the levels below the one given
+    uint64_t bits = occupied[word] & (~uint64_t(0) << (level % BITS));
+    while (!bits) {
+        if (++word == int(occupied.size())) return -1;
+        bits = occupied[word];
     }
+    return word * BITS + lowestBit(bits);
 }
 
 framing::SequenceNumber PriorityQueue::MessageHolder::getSequence() const
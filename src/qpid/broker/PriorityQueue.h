@@ -21,6 +21,7 @@
  * under the License.
  *
  */
+#include "qpid/broker/BrokerImportExport.h"
 #include "qpid/broker/MessageDeque.h"
 #include "qpid/broker/IndexedDeque.h"
 #include "qpid/sys/IntegerTypes.h"
@@ -33,7 +34,9 @@ namespace broker {
 /**
  * Basic priority queue with a configurable number of recognised
  * priority levels. This is implemented as a separate deque per
- * priority level.
+ * priority level, with a bitmap of the levels holding messages so
+ * that the next level to look at is found without visiting the
+ * empty ones in between.
  *
  * Browsing is FIFO not priority order. There is a MessageDeque
  * for fast browsing.
@@ -41,7 +44,7 @@ namespace broker {
 class PriorityQueue : public Messages
 {
   public:
-    PriorityQueue(int levels);
+    QPID_BROKER_EXTERN PriorityQueue(int levels);
     virtual ~PriorityQueue() {}
     size_t size();
 
@@ -65,6 +68,12 @@ class PriorityQueue : public Messages
     virtual Priority firstLevel();
     virtual bool nextLevel(Priority& );
 
+    bool isOccupied(int level) const;
+    /** @return the highest level at or below the one given that holds messages, or -1 */
+    int highestOccupied(int level) const;
+    /** @return the lowest level at or above the one given that holds messages, or -1 */
+    int lowestOccupied(int level) const;
+
   private:
     struct MessageHolder
     {
@@ -88,11 +97,16 @@ class PriorityQueue : public Messages
     typedef IndexedDeque<MessageHolder> Deque;
     typedef std::vector<Deque> PriorityLevels;
     typedef std::vector<framing::SequenceNumber> Counters;
+    typedef std::vector<uint64_t> Bitmap;
 
     /** Holds pointers to messages (stored in the fifo index) separated by priority.
      */
     PriorityLevels messages;
     Counters counters;
+    /** Number of messages not yet deleted at each level */
+    std::vector<uint32_t> depths;
+    /** One bit per level, set while that level's depth is non-zero */
+    Bitmap occupied;
     /** FIFO index of messages for fast browsing and indexing */
     IndexedDeque<MessagePointer> fifo;
     uint frontLevel;
@@ -25,6 +25,7 @@
 #include "qpid/broker/AclModule.h"
 #include "qpid/broker/QueueCursor.h"
 #include "qpid/broker/QueueDepth.h"
+#include "qpid/broker/QueueHistograms.h"
 #include "qpid/broker/QueueSettings.h"
 #include "qpid/broker/Exchange.h"
 #include "qpid/broker/DeliverableMessage.h"
@@ -52,6 +53,7 @@
 #include "qpid/sys/Time.h"
 #include "qpid/sys/Timer.h"
 #include "qpid/types/Variant.h"
+#include "qmf/org/apache/qpid/broker/ArgsQueueGetHistograms.h"
 #include "qmf/org/apache/qpid/broker/ArgsQueuePurge.h"
 #include "qmf/org/apache/qpid/broker/ArgsQueueReroute.h"
 #include "qmf/org/apache/qpid/broker/EventQueueDelete.h"
@@ -64,6 +66,8 @@
 
 #include <boost/bind.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 
 
 namespace qpid {
@@ -84,6 +88,12 @@ namespace _qmf = qmf::org::apache::qpid::broker;
 
 namespace
 {
+// Limits the time the messageLock is held when purging expired messages
+const uint32_t EXPIRY_SLICE(1000);
+// Limits the time the messageLock is held, and the number of messages
+// held in memory, when purging, moving or re-routing messages
+const uint32_t REMOVE_SLICE(1000);
+const std::string BACKGROUND_REMOVAL_RUNNING("A background purge, reroute or move is already running on this queue");
 
 inline void mgntEnqStats(const Message& msg,
 			 _qmf::Queue::shared_ptr mgmtObject,
@@ -147,6 +157,7 @@ QueueSettings merge(const QueueSettings& inputs, const Broker& broker)
     } else if (broker.getQueueLimit()) {
         settings.maxDepth.setSize(broker.getQueueLimit());
     }
+    if (broker.isKeepingHistograms()) settings.histograms = true;
     return settings;
 }
 
@@ -233,6 +244,9 @@ Queue::Queue(const string& _name, const QueueSettings& _settings,
         selector.reset(new Selector(settings.filter));
         QPID_LOG (info, "Queue " << name << " using filter: " << settings.filter);
     }
+    if (settings.histograms) {
+        histograms.reset(new QueueHistograms());
+    }
 }
 
 Queue::~Queue()
@@ -430,11 +444,13 @@ bool Queue::getNextMessage(Message& m, Consumer::shared_ptr& c)
     QueueListeners::NotificationSet set;
     ScopedAutoDelete autodelete(*this);
     bool messageFound(false);
+    bool scan(false); // set once a message offered by the allocator is passed over
     while (true) {
         //TODO: reduce lock scope
         Mutex::ScopedLock locker(messageLock);
         QueueCursor cursor = c->getCursor(); // Save current position.
-        Message* msg = messages->next(*c);   // Advances c.
+        Message* msg = c->preAcquires() && !scan ?
+            allocator->next(c->getName(), *c) : messages->next(*c); // Advances c.
         if (msg) {
             if (isExpired(name, *msg,  sys::AbsTime::now())) {
                 QPID_LOG(debug, "Message expired from queue '" << name << "'");
@@ -465,6 +481,7 @@ bool Queue::getNextMessage(Message& m, Consumer::shared_ptr& c)
                             msg->deliver();
                         } else {
                             QPID_LOG(debug, "Could not acquire message from '" << name << "'");
+                            scan = true;
                             continue; //try another message
                         }
                     }
@@ -486,6 +503,7 @@ bool Queue::getNextMessage(Message& m, Consumer::shared_ptr& c)
             } else {
                 //consumer will never want this message, try another one
                 QPID_LOG(debug, "Consumer doesn't want message from '" << name << "'");
+                scan = true;
                 if (c->preAcquires()) {
                     //let someone else try to take this one
                     listeners.populate(set);
@@ -664,7 +682,8 @@ void Queue::purgeExpired(sys::Duration lapse) {
     int seconds = int64_t(lapse)/qpid::sys::TIME_SEC;
     if (seconds == 0 || count / seconds < 1) {
         sys::AbsTime time = sys::AbsTime::now();
-        uint32_t count = remove(0, boost::bind(&isExpired, name, _1, time), 0, CONSUMER, settings.autodelete);
+        uint32_t count(0);
+        while (removeExpired(time, EXPIRY_SLICE, count)) {}
         QPID_LOG(debug, "Purged " << count << " expired messages from " << getName());
         //
         // Report the count of discarded-by-ttl messages
@@ -678,6 +697,49 @@ void Queue::purgeExpired(sys::Duration lapse) {
     }
 }
 
+/**
+ * Removes messages found through the expiry index that expired before
+ * now, looking at no more than maxEntries index entries.
+ *@returns true if there may be further expired messages
+ */
+bool Queue::removeExpired(sys::AbsTime now, uint32_t maxEntries, uint32_t& count)
+{
+    ScopedAutoDelete autodelete(*this);
+    std::deque<Message> removed;
+    bool more(false);
+    {
+        Mutex::ScopedLock locker(messageLock);
+        framing::SequenceNumber position;
+        uint32_t entries(0);
+        while (expiryIndex.next(now, position)) {
+            QueueCursor c(CONSUMER);
+            Message* m = messages->find(position, &c);
+            //entries for messages since removed are simply dropped, as
+            //are those for acquired messages, which are re-indexed if
+            //released
+            if (m && m->getState() == AVAILABLE && isExpired(name, *m, now)) {
+                //don't actually acquire, just act as if we did
+                observeAcquire(*m, locker);
+                observeDequeue(*m, locker, settings.autodelete ? &autodelete : 0);
+                removed.push_back(*m);//takes a copy of the message
+                if (!messages->deleted(c)) {
+                    QPID_LOG(warning, "Failed to correctly remove message from " << name << "; state is not consistent!");
+                    assert(false);
+                }
+            }
+            if (++entries >= maxEntries) {
+                more = true;
+                break;
+            }
+        }
+    }
+    for (std::deque<Message>::iterator i = removed.begin(); i != removed.end(); ++i) {
+        if (i->isPersistent()) dequeueFromStore(i->getPersistentContext());
+    }
+    count += removed.size();
+    return more;
+}
+
 namespace {
     // for use with purge/move below - collect messages that match a given filter
     //
@@ -759,41 +821,151 @@ namespace {
     }
 } // end namespace
 
+Queue::Removal::Removal(uint32_t m, MessagePredicate p, MessageFunctor f, SubscriptionType type,
+                        bool t, uint32_t mt, bool c)
+    : cursor(type), maxCount(m), predicate(p), function(f), triggerAutoDelete(t), maxTests(mt),
+      cancellable(c), cancelled(false), count(0), tests(0), total(0) {}
+
 uint32_t Queue::remove(const uint32_t maxCount, MessagePredicate p, MessageFunctor f,
                        SubscriptionType type, bool triggerAutoDelete, uint32_t maxTests)
+{
+    Removal removal(maxCount, p, f, type, triggerAutoDelete, maxTests, false);
+    return remove(removal);
+}
+
+uint32_t Queue::remove(Removal& removal)
+{
+    {
+        Mutex::ScopedLock locker(messageLock);
+        removal.last = sequence;
+    }
+    while (removeSlice(removal)) {
+        QPID_LOG(debug, "Removed " << removal.total << " messages from " << name << " so far");
+    }
+    return removal.total;
+}
+
+/**
+ * Removes the next slice of messages, holding the messageLock only
+ * while they are taken off the queue. A cancellable removal stops
+ * here once it has been cancelled, the queue has been deleted or the
+ * broker is shutting down.
+ *@return true if there may be more messages to remove
+ */
+bool Queue::removeSlice(Removal& r)
 {
     ScopedAutoDelete autodelete(*this);
     std::deque<Message> removed;
+    bool more(false);
     {
-        QueueCursor c(type);
-        uint32_t count(0), tests(0);
         Mutex::ScopedLock locker(messageLock);
-        Message* m = messages->next(c);
+        if (r.cancellable && (r.cancelled || deleted || (broker && broker->getPoller()->hasShutdown()))) {
+            QPID_LOG(info, "Stopped removing messages from " << name << " after " << r.total << ": "
+                     << (r.cancelled ? "cancelled" : deleted ? "queue deleted" : "broker shutting down"));
+            return false;
+        }
+        Message* m = messages->next(r.cursor);
         while (m){
-            if (maxTests && tests++ >= maxTests) break;
-            if (!p || p(*m)) {
-                if (maxCount && count++ >= maxCount) break;
+            if (r.maxTests && r.tests++ >= r.maxTests) break;
+            //anything enqueued since we started, including messages
+            //re-routed back onto this queue by the function, is left alone
+            if (m->getSequence() <= r.last && (!r.predicate || r.predicate(*m))) {
+                if (r.maxCount && r.count++ >= r.maxCount) break;
                 if (m->getState() == AVAILABLE) {
                     //don't actually acquire, just act as if we did
                     observeAcquire(*m, locker);
                 }
-                observeDequeue(*m, locker, triggerAutoDelete ? &autodelete : 0);
+                observeDequeue(*m, locker, r.triggerAutoDelete ? &autodelete : 0);
                 removed.push_back(*m);//takes a copy of the message
-                if (!messages->deleted(c)) {
+                if (!messages->deleted(r.cursor)) {
                     QPID_LOG(warning, "Failed to correctly remove message from " << name << "; state is not consistent!");
                     assert(false);
                 }
+                if (removed.size() >= REMOVE_SLICE) {
+                    more = true;
+                    break;
+                }
             }
-            m = messages->next(c);
+            m = messages->next(r.cursor);
         }
     }
     for (std::deque<Message>::iterator i = removed.begin(); i != removed.end(); ++i) {
-        if (f) f(*i);//ERROR? need to clear old persistent context?
+        if (r.function) r.function(*i);//ERROR? need to clear old persistent context?
         if (i->isPersistent()) dequeueFromStore(i->getPersistentContext());//do this outside of lock and after any re-routing
     }
-    return removed.size();
+    r.total += removed.size();
+    return more;
 }
 
+/**
+ * Runs a removal one slice per firing, so that other timer tasks get a
+ * turn in between. Holds only a weak reference to the queue, which
+ * refers to the task while it runs.
+ */
+class Queue::RemoveTask : public sys::TimerTask
+{
+  public:
+    RemoveTask(Queue::shared_ptr q, std::auto_ptr<Removal> r, sys::Timer& t)
+        : sys::TimerTask(sys::Duration(0), "QueueRemove:" + q->getName()), queue(q), removal(r), timer(t) {}
+
+    void cancel(const Mutex::ScopedLock&) { removal->cancelled = true; }
+
+    void fire()
+    {
+        Queue::shared_ptr q = queue.lock();
+        if (!q) return;
+        bool more = q->removeSlice(*removal);
+        q->removedInBackground(*removal, !more);
+        if (more) {
+            restart();
+            timer.add(this);
+        }
+    }
+
+  private:
+    boost::weak_ptr<Queue> queue;
+    boost::scoped_ptr<Removal> removal;
+    sys::Timer& timer;
+};
+
+bool Queue::removeInBackground(sys::Timer& timer, std::auto_ptr<Removal> removal)
+{
+    boost::intrusive_ptr<RemoveTask> task;
+    {
+        Mutex::ScopedLock locker(messageLock);
+        if (removeTask || deleted) return false;
+        removal->last = sequence;
+        task = removeTask = new RemoveTask(shared_from_this(), removal, timer);
+    }
+    if (mgmtObject) {
+        mgmtObject->set_removalProcessed(0);
+        mgmtObject->set_removalInProgress(true);
+    }
+    QPID_LOG(info, "Removing messages from " << name << " in the background");
+    timer.add(task);
+    return true;
+}
+
+void Queue::removedInBackground(const Removal& removal, bool finished)
+{
+    if (mgmtObject) mgmtObject->set_removalProcessed(removal.total);
+    if (finished) {
+        {
+            Mutex::ScopedLock locker(messageLock);
+            removeTask = boost::intrusive_ptr<RemoveTask>();
+        }
+        if (mgmtObject) mgmtObject->set_removalInProgress(false);
+        QPID_LOG(info, "Removed " << removal.total << " messages from " << name << " in the background");
+    }
+}
+
+bool Queue::cancelRemoval()
+{
+    Mutex::ScopedLock locker(messageLock);
+    if (!removeTask) return false;
+    removeTask->cancel(locker);
+    return true;
+}
 
 /**
  * purge - for purging all or some messages on a queue
@@ -813,34 +985,59 @@ uint32_t Queue::remove(const uint32_t maxCount, MessagePredicate p, MessageFunct
 uint32_t Queue::purge(const uint32_t qty, boost::shared_ptr<Exchange> dest,
                       const qpid::types::Variant::Map *filter)
 {
-    std::auto_ptr<MessageFilter> mf(MessageFilter::create(filter));
-    uint32_t count = remove(qty, boost::bind(&MessageFilter::match, mf.get(), _1), boost::bind(&reroute, dest, _1), CONSUMER/*?*/, settings.autodelete);
+    boost::shared_ptr<MessageFilter> mf(MessageFilter::create(filter));
+    Removal removal(qty, boost::bind(&MessageFilter::match, mf, _1), boost::bind(&Queue::purged, this, dest, _1), CONSUMER/*?*/, settings.autodelete, 0, true);
+    return remove(removal);
+}
+
+bool Queue::purgeInBackground(sys::Timer& timer, const uint32_t qty, boost::shared_ptr<Exchange> dest,
+                              const qpid::types::Variant::Map *filter)
+{
+    boost::shared_ptr<MessageFilter> mf(MessageFilter::create(filter));
+    return removeInBackground(timer, std::auto_ptr<Removal>(
+        new Removal(qty, boost::bind(&MessageFilter::match, mf, _1), boost::bind(&Queue::purged, this, dest, _1), CONSUMER, settings.autodelete, 0, true)));
+}
 
-    if (mgmtObject && count) {
-        mgmtObject->inc_acquires(count);
+/**
+ * Counts each purged message as it is processed, so that the
+ * statistics show the progress of a purge that runs over several
+ * slices.
+ */
+void Queue::purged(boost::shared_ptr<Exchange> dest, const Message& message)
+{
+    reroute(dest, message);
+    if (mgmtObject) {
+        mgmtObject->inc_acquires();
         if (dest.get()) {
-            mgmtObject->inc_reroutes(count);
+            mgmtObject->inc_reroutes();
             if (brokerMgmtObject) {
-                brokerMgmtObject->inc_acquires(count);
-                brokerMgmtObject->inc_reroutes(count);
+                brokerMgmtObject->inc_acquires();
+                brokerMgmtObject->inc_reroutes();
             }
         } else {
-            mgmtObject->inc_discardsPurge(count);
+            mgmtObject->inc_discardsPurge();
             if (brokerMgmtObject) {
-                brokerMgmtObject->inc_acquires(count);
-                brokerMgmtObject->inc_discardsPurge(count);
+                brokerMgmtObject->inc_acquires();
+                brokerMgmtObject->inc_discardsPurge();
             }
         }
     }
-
-    return count;
 }
 
 uint32_t Queue::move(const Queue::shared_ptr destq, uint32_t qty,
                      const qpid::types::Variant::Map *filter)
 {
-    std::auto_ptr<MessageFilter> mf(MessageFilter::create(filter));
-    return remove(qty, boost::bind(&MessageFilter::match, mf.get(), _1), boost::bind(&moveTo, destq, _1), CONSUMER/*?*/, settings.autodelete);
+    boost::shared_ptr<MessageFilter> mf(MessageFilter::create(filter));
+    Removal removal(qty, boost::bind(&MessageFilter::match, mf, _1), boost::bind(&moveTo, destq, _1), CONSUMER/*?*/, settings.autodelete, 0, true);
+    return remove(removal);
+}
+
+bool Queue::moveInBackground(sys::Timer& timer, const Queue::shared_ptr destq, uint32_t qty,
+                             const qpid::types::Variant::Map *filter)
+{
+    boost::shared_ptr<MessageFilter> mf(MessageFilter::create(filter));
+    return removeInBackground(timer, std::auto_ptr<Removal>(
+        new Removal(qty, boost::bind(&MessageFilter::match, mf, _1), boost::bind(&moveTo, destq, _1), CONSUMER, settings.autodelete, 0, true)));
 }
 
 void Queue::push(Message& message, bool /*isRecovery*/)
@@ -850,6 +1047,7 @@ void Queue::push(Message& message, bool /*isRecovery*/)
         Mutex::ScopedLock locker(messageLock);
         message.setSequence(++sequence);
         if (settings.sequencing) message.addAnnotation(settings.sequenceKey, (uint32_t)sequence);
+        if (histograms) histograms->enqueued(message);
         interceptors.publish(message);
         messages->publish(message);
         listeners.populate(copy);
@@ -1058,6 +1256,7 @@ void Queue::observeDequeue(const Message& msg, const Mutex::ScopedLock& lock, Sc
 {
     current -= QueueDepth(1, msg.getMessageSize());
     mgntDeqStats(msg, mgmtObject, brokerMgmtObject);
+    if (histograms) histograms->dequeued(msg);
     observers.dequeued(msg, lock);
     if (autodelete && isEmpty(lock)) autodelete->check(lock);
 }
@@ -1065,16 +1264,19 @@ void Queue::observeDequeue(const Message& msg, const Mutex::ScopedLock& lock, Sc
 /** updates queue observers when a message has become unavailable for transfer.
  * Requires messageLock be held by caller.
  */
-void Queue::observeAcquire(const Message& msg, const Mutex::ScopedLock& l)
+void Queue::observeAcquire(Message& msg, const Mutex::ScopedLock& l)
 {
+    if (histograms) histograms->acquired(msg);
     observers.acquired(msg, l);
 }
 
 /** updates queue observers when a message has become re-available for transfer
  *  Requires messageLock be held by caller.
  */
-void Queue::observeRequeue(const Message& msg, const Mutex::ScopedLock& l)
+void Queue::observeRequeue(Message& msg, const Mutex::ScopedLock& l)
 {
+    if (histograms) histograms->requeued(msg);
+    expiryIndex.add(msg, boost::bind(&Queue::isAvailable, this, _1));
     observers.requeued(msg, l);
 }
 
@@ -1463,7 +1665,13 @@ Manageable::status_t Queue::ManagementMethod (uint32_t methodId, Args& args, str
                 throw framing::UnauthorizedAccessException(QPID_MSG("ACL denied purge request from " << _userId));
             }
             _qmf::ArgsQueuePurge& purgeArgs = (_qmf::ArgsQueuePurge&) args;
-            purge(purgeArgs.i_request, boost::shared_ptr<Exchange>(), &purgeArgs.i_filter);
+            if (!purgeArgs.i_background) {
+                purge(purgeArgs.i_request, boost::shared_ptr<Exchange>(), &purgeArgs.i_filter);
+            } else if (!purgeInBackground(broker->getTimer(), purgeArgs.i_request, boost::shared_ptr<Exchange>(), &purgeArgs.i_filter)) {
+                status = Manageable::STATUS_PARAMETER_INVALID;
+                etext = BACKGROUND_REMOVAL_RUNNING;
+                break;
+            }
             status = Manageable::STATUS_OK;
         }
         break;
@@ -1497,7 +1705,33 @@ Manageable::status_t Queue::ManagementMethod (uint32_t methodId, Args& args, str
                 }
             }
 
-            purge(rerouteArgs.i_request, dest, &rerouteArgs.i_filter);
+            if (!rerouteArgs.i_background) {
+                purge(rerouteArgs.i_request, dest, &rerouteArgs.i_filter);
+            } else if (!purgeInBackground(broker->getTimer(), rerouteArgs.i_request, dest, &rerouteArgs.i_filter)) {
+                status = Manageable::STATUS_PARAMETER_INVALID;
+                etext = BACKGROUND_REMOVAL_RUNNING;
+                break;
+            }
+            status = Manageable::STATUS_OK;
+        }
+        break;
+
+    case _qmf::Queue::METHOD_CANCELREMOVAL :
+        cancelRemoval();
+        status = Manageable::STATUS_OK;
+        break;
+
+    case _qmf::Queue::METHOD_GETHISTOGRAMS :
+        {
+            if (!histograms) {
+                status = Manageable::STATUS_FEATURE_NOT_IMPLEMENTED;
+                etext = "Histograms are not enabled for this queue";
+                break;
+            }
+            _qmf::ArgsQueueGetHistograms& histogramArgs = (_qmf::ArgsQueueGetHistograms&) args;
+            Mutex::ScopedLock locker(messageLock);
+            histograms->mapEncode(histogramArgs.o_histograms);
+            if (histogramArgs.i_reset) histograms->reset();
             status = Manageable::STATUS_OK;
         }
         break;
@@ -1571,10 +1805,18 @@ void Queue::recoveryComplete(ExchangeRegistry& exchanges)
  */
 void Queue::observeEnqueue(const Message& m, const Mutex::ScopedLock& l)
 {
+    expiryIndex.add(m, boost::bind(&Queue::isAvailable, this, _1));
     observers.enqueued(m, l);
     mgntEnqStats(m, mgmtObject, brokerMgmtObject);
 }
 
+/** Requires messageLock be held by caller. */
+bool Queue::isAvailable(framing::SequenceNumber position)
+{
+    Message* m = messages->find(position, 0);
+    return m && m->getState() == AVAILABLE;
+}
+
 bool Queue::checkNotDeleted(const Consumer::shared_ptr& c)
 {
     if (deleted && !c->hideDeletedError())
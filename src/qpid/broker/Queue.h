@@ -25,6 +25,7 @@
 #include "qpid/broker/BrokerImportExport.h"
 #include "qpid/broker/OwnershipToken.h"
 #include "qpid/broker/Consumer.h"
+#include "qpid/broker/ExpiryIndex.h"
 #include "qpid/broker/Message.h"
 #include "qpid/broker/Messages.h"
 #include "qpid/broker/MessageInterceptor.h"
@@ -59,6 +60,7 @@
 
 namespace qpid {
 namespace sys {
+class Timer;
 class TimerTask;
 }
 namespace broker {
@@ -69,6 +71,7 @@ class QueueDepth;
 class QueueEvents;
 class QueueRegistry;
 class QueueFactory;
+class QueueHistograms;
 class Selector;
 class TransactionContext;
 class TxBuffer;
@@ -220,6 +223,8 @@ class Queue : public boost::enable_shared_from_this<Queue>,
     boost::intrusive_ptr<qpid::sys::TimerTask> autoDeleteTask;
     boost::shared_ptr<MessageDistributor> allocator;
     boost::scoped_ptr<Selector> selector;
+    boost::scoped_ptr<QueueHistograms> histograms;
+    ExpiryIndex expiryIndex;
     qpid::sys::AtomicCount version;
 
     // Redirect source and target refer to each other. Only one is source.
@@ -242,22 +247,27 @@ class Queue : public boost::enable_shared_from_this<Queue>,
     /** update queue observers, stats, policy, etc when the messages' state changes. Lock
      * must be held by caller */
     void observeEnqueue(const Message& msg, const sys::Mutex::ScopedLock& lock);
-    void observeAcquire(const Message& msg, const sys::Mutex::ScopedLock& lock);
-    void observeRequeue(const Message& msg, const sys::Mutex::ScopedLock& lock);
+    void observeAcquire(Message& msg, const sys::Mutex::ScopedLock& lock);
+    void observeRequeue(Message& msg, const sys::Mutex::ScopedLock& lock);
     void observeDequeue(const Message& msg, const sys::Mutex::ScopedLock& lock, ScopedAutoDelete*);
     void observeConsumerAdd( const Consumer&, const sys::Mutex::ScopedLock& lock);
     void observeConsumerRemove( const Consumer&, const sys::Mutex::ScopedLock& lock);
 
     bool acquire(const qpid::framing::SequenceNumber& position, Message& msg,
                  const qpid::sys::Mutex::ScopedLock& locker);
+    bool removeExpired(qpid::sys::AbsTime now, uint32_t maxEntries, uint32_t& count);
 
     int getEventMode();
     void dequeueFromStore(boost::intrusive_ptr<PersistableMessage>);
     void abandoned(const Message& message);
+    void purged(boost::shared_ptr<Exchange> dest, const Message& message);
     bool checkNotDeleted(const Consumer::shared_ptr&);
+    bool isAvailable(framing::SequenceNumber position);
     void notifyDeleted();
 
-    /** Remove messages from the queue:
+    /** Remove messages from the queue, in slices so that the
+     * messageLock is released periodically. Only messages already on
+     * the queue when the call starts are considered.
      *@param maxCount Maximum number of messages to remove, 0 means unlimited.
      *@param p Only remove messages for which p(msg) is true.
      *@param f Call f on each message that is removed.
@@ -272,6 +282,33 @@ class Queue : public boost::enable_shared_from_this<Queue>,
                     bool triggerAutoDelete,
                     uint32_t maxTests=0);
 
+    /** The position and counts of a removal that runs over several slices */
+    struct Removal
+    {
+        QueueCursor cursor;
+        const uint32_t maxCount;
+        const MessagePredicate predicate;
+        const MessageFunctor function;
+        const bool triggerAutoDelete;
+        const uint32_t maxTests;
+        const bool cancellable;//by cancelRemoval(), queue deletion or broker shutdown
+        bool cancelled;//guarded by messageLock
+        framing::SequenceNumber last;
+        uint32_t count;
+        uint32_t tests;
+        uint32_t total;
+
+        Removal(uint32_t maxCount, MessagePredicate p, MessageFunctor f, SubscriptionType st,
+                bool triggerAutoDelete, uint32_t maxTests, bool cancellable);
+    };
+    class RemoveTask;
+    boost::intrusive_ptr<RemoveTask> removeTask;//background purge, reroute or move, if any; guarded by messageLock
+
+    uint32_t remove(Removal&);
+    bool removeSlice(Removal&);
+    bool removeInBackground(sys::Timer&, std::auto_ptr<Removal>);
+    void removedInBackground(const Removal&, bool finished);
+
     virtual bool checkDepth(const QueueDepth& increment, const Message&);
     void tryAutoDelete(long expectedVersion);
   public:
@@ -383,6 +420,25 @@ class Queue : public boost::enable_shared_from_this<Queue>,
         const Queue::shared_ptr destq, uint32_t qty,
         const qpid::types::Variant::Map *filter=0);
 
+    /**
+     * Purge or move messages as above, but return at once and do the
+     * work in slices run on the given timer. Progress is shown by the
+     * removalInProgress and removalProcessed management statistics.
+     *@return false if a background purge, reroute or move is already
+     * running on this queue
+     */
+    QPID_BROKER_EXTERN bool purgeInBackground(sys::Timer&, uint32_t purge_request,
+                                              boost::shared_ptr<Exchange> dest=boost::shared_ptr<Exchange>(),
+                                              const ::qpid::types::Variant::Map *filter=0);
+    QPID_BROKER_EXTERN bool moveInBackground(sys::Timer&, const Queue::shared_ptr destq, uint32_t qty,
+                                             const qpid::types::Variant::Map *filter=0);
+    /**
+     * Stop a background purge, reroute or move once its current slice
+     * is done.
+     *@return false if none was running
+     */
+    QPID_BROKER_EXTERN bool cancelRemoval();
+
     QPID_BROKER_EXTERN uint32_t getMessageCount() const;
     QPID_BROKER_EXTERN uint32_t getConsumerCount() const;
     inline const std::string& getName() const { return name; }
@@ -0,0 +1,95 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/QueueHistograms.h"
+#include "qpid/broker/Message.h"
+#include "qpid/sys/Time.h"
+
+namespace qpid {
+namespace broker {
+
+namespace {
+const std::string ENQUEUE_TO_ACQUIRE("enqueueToAcquire");
+const std::string ACQUIRE_TO_ACCEPT("acquireToAccept");
+const std::string MESSAGE_SIZE("messageSize");
+
+/** Record the nanoseconds from the message's queue time until now */
+void recordElapsed(Histogram& histogram, const Message& message, sys::AbsTime now)
+{
+    sys::AbsTime start = message.getQueueTime();
+    // Messages already on the queue when histograms were enabled are
+    // unstamped and contribute nothing.
+    if (start == sys::ZERO) return;
+    int64_t elapsed = sys::Duration(start, now);
+    histogram.record(elapsed > 0 ? elapsed : 0);
+}
+
+void encode(const Histogram& histogram, const std::string& name, qpid::types::Variant::Map& map)
+{
+    qpid::types::Variant::Map encoded;
+    histogram.mapEncode(encoded);
+    map[name] = encoded;
+}
+}
+
+void QueueHistograms::enqueued(Message& message)
+{
+    message.setQueueTime(sys::AbsTime::now());
+    messageSize.record(message.getMessageSize());
+}
+
+void QueueHistograms::acquired(Message& message)
+{
+    // The queue also reports messages it removes (e.g. on purge) as
+    // acquired; only those actually acquired by a consumer count.
+    if (message.getState() == ACQUIRED) {
+        sys::AbsTime now = sys::AbsTime::now();
+        recordElapsed(enqueueToAcquire, message, now);
+        message.setQueueTime(now);
+    }
+}
+
+void QueueHistograms::requeued(Message& message)
+{
+    message.setQueueTime(sys::AbsTime::now());
+}
+
+void QueueHistograms::dequeued(const Message& message)
+{
+    if (message.getState() == ACQUIRED) {
+        recordElapsed(acquireToAccept, message, sys::AbsTime::now());
+    }
+}
+
+void QueueHistograms::mapEncode(qpid::types::Variant::Map& map) const
+{
+    encode(enqueueToAcquire, ENQUEUE_TO_ACQUIRE, map);
+    encode(acquireToAccept, ACQUIRE_TO_ACCEPT, map);
+    encode(messageSize, MESSAGE_SIZE, map);
+}
+
+void QueueHistograms::reset()
+{
+    enqueueToAcquire.reset();
+    acquireToAccept.reset();
+    messageSize.reset();
+}
+
+}} // namespace qpid::broker
@@ -0,0 +1,65 @@
+#ifndef QPID_BROKER_QUEUEHISTOGRAMS_H
+#define QPID_BROKER_QUEUEHISTOGRAMS_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/BrokerImportExport.h"
+#include "qpid/broker/Histogram.h"
+#include "qpid/types/Variant.h"
+
+namespace qpid {
+namespace broker {
+
+class Message;
+
+/**
+ * Latency and message size histograms for a single queue.
+ *
+ * Messages are stamped with the time they entered their current state
+ * on the queue, from which the time spent available before being
+ * acquired, and acquired before being accepted, is recorded.
+ *
+ * Called by the Queue with its messageLock held; no further locking.
+ */
+class QueueHistograms
+{
+  public:
+    QPID_BROKER_EXTERN void enqueued(Message&);
+    QPID_BROKER_EXTERN void acquired(Message&);
+    QPID_BROKER_EXTERN void requeued(Message&);
+    QPID_BROKER_EXTERN void dequeued(const Message&);
+
+    QPID_BROKER_EXTERN void mapEncode(qpid::types::Variant::Map&) const;
+    QPID_BROKER_EXTERN void reset();
+
+    const Histogram& getEnqueueToAcquire() const { return enqueueToAcquire; }
+    const Histogram& getAcquireToAccept() const { return acquireToAccept; }
+    const Histogram& getMessageSize() const { return messageSize; }
+
+  private:
+    Histogram enqueueToAcquire;
+    Histogram acquireToAccept;
+    Histogram messageSize;
+};
+
+}} // namespace qpid::broker
+
+#endif  /*!QPID_BROKER_QUEUEHISTOGRAMS_H*/
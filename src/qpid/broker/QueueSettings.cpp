@@ -70,6 +70,7 @@ const std::string LVQ_LEGACY_KEY("qpid.LVQ_key");
 const std::string LVQ_LEGACY_NOBROWSE("qpid.last_value_queue_no_browse");
 
 const std::string SEQUENCING("qpid.queue_msg_sequence");
+const std::string HISTOGRAMS("qpid.histograms");
 
 bool handleFairshareSetting(const std::string& basename, const std::string& key, const qpid::types::Variant& value, QueueSettings& settings)
 {
@@ -109,7 +110,8 @@ QueueSettings::QueueSettings(bool d, bool a) :
     alertRepeatInterval(60),
     maxFileSize(0),
     maxFileCount(0),
-    sequencing(false)
+    sequencing(false),
+    histograms(false)
 {}
 
 bool QueueSettings::handle(const std::string& key, const qpid::types::Variant& value)
@@ -223,6 +225,9 @@ bool QueueSettings::handle(const std::string& key, const qpid::types::Variant& v
         sequenceKey = value.getString();
         sequencing = !sequenceKey.empty();
         return true;
+    } else if (key == HISTOGRAMS) {
+        histograms = value;
+        return true;
     } else if (key == FILTER) {
         filter = value.asString();
         return true;
@@ -100,6 +100,9 @@ struct QueueSettings
     // store bool to avoid testing string value
     bool sequencing;
 
+    //latency and message size histograms (see QueueHistograms)
+    bool histograms;
+
     std::string filter;
 
     //yuck, yuck
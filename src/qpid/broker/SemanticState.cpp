@@ -384,8 +384,19 @@ bool SemanticStateConsumerImpl::deliver(const QueueCursor& cursor, const Message
 {
     allocateCredit(msg);
     boost::intrusive_ptr<const amqp_0_10::MessageTransfer> transfer = protocols.translate(msg);
-    DeliveryRecord record(cursor, msg.getSequence(), msg.getReplicationId(), queue, getTag(),
-                          consumer, acquire, !ackExpected, credit.isWindowMode(), transfer->getRequiredCredit());
+    //a record is only kept if it may yet be accepted, acquired or
+    //used to replenish credit; only such records need a context
+    bool retain = credit.isWindowMode() || ackExpected || !acquire;
+    DeliveryRecord::Context::shared_ptr context;
+    if (retain) {
+        context = deliveryContext.lock();
+        if (!context || context->consumer != consumer) {
+            context.reset(new DeliveryRecord::Context(queue, getTag(), consumer));
+            deliveryContext = context;
+        }
+    }
+    DeliveryRecord record(cursor, msg.getSequence(), msg.getReplicationId(), context,
+                          acquire, !ackExpected, credit.isWindowMode(), transfer->getRequiredCredit());
     bool sync = syncFrequency && ++deliveryCount >= syncFrequency;
     if (sync) deliveryCount = 0;//reset
 
@@ -394,7 +405,7 @@ bool SemanticStateConsumerImpl::deliver(const QueueCursor& cursor, const Message
                                          acquire ? message::ACQUIRE_MODE_PRE_ACQUIRED : message::ACQUIRE_MODE_NOT_ACQUIRED,
                                          msg.getAnnotations(),
                                          sync));
-    if (credit.isWindowMode() || ackExpected || !acquire) {
+    if (retain) {
         parent->record(record);
     }
     if (acquire && !ackExpected) {  // auto acquire && auto accept
@@ -498,7 +509,7 @@ void SemanticState::route(Message& msg, Deliverable& strategy) {
     AclModule* acl = getSession().getBroker().getAcl();
     if (acl && acl->doTransferAcl())
     {
-        if (!acl->authorise(getSession().getConnection().getUserId(),acl::ACT_PUBLISH,acl::OBJ_EXCHANGE,exchangeName, msg.getRoutingKey() ))
+        if (!acl->authorisePublish(getSession().getConnection().getUserId(), exchangeName, msg.getRoutingKey(), aclPublishCache))
             throw UnauthorizedAccessException(QPID_MSG(userID << " cannot publish to " <<
                                                exchangeName << " with routing-key " << msg.getRoutingKey()));
     }
@@ -790,29 +801,38 @@ void SemanticState::accepted(const SequenceSet& commands) {
             //mark the relevant messages as 'ended' in unacked
             //if the messages are already completed, they can be
             //removed from the record
-            DeliveryRecords::iterator removed =
-                remove_if(unacked.begin(), unacked.end(),
-                          isInSequenceSetAnd(commands,
-                                             bind(&DeliveryRecord::setEnded, _1)));
-            unacked.erase(removed, unacked.end());
+            if (!commands.empty()) {
+                AckRange range = findRange(commands.front(), commands.back());
+                DeliveryRecords::iterator removed =
+                    remove_if(range.start, range.end,
+                              isInSequenceSetAnd(commands,
+                                                 bind(&DeliveryRecord::setEnded, _1)));
+                unacked.erase(removed, range.end);
+            }
         }
-    } else {
+    } else if (!commands.empty()) {
+        //only the records between the first and last ids in the set
+        //need be visited, not the whole of what may be a large window
+        AckRange range = findRange(commands.front(), commands.back());
         DeliveryRecords::iterator removed =
-            remove_if(unacked.begin(), unacked.end(),
+            remove_if(range.start, range.end,
                       isInSequenceSetAnd(commands,
                                          bind(&DeliveryRecord::accept, _1,
                                               (TransactionContext*) 0)));
-        unacked.erase(removed, unacked.end());
+        unacked.erase(removed, range.end);
     }
     getSession().setUnackedCount(unacked.size());
 }
 
 void SemanticState::completed(const SequenceSet& commands) {
-    DeliveryRecords::iterator removed =
-        remove_if(unacked.begin(), unacked.end(),
-                  isInSequenceSetAnd(commands,
-                                     bind(&SemanticState::complete, this, _1)));
-    unacked.erase(removed, unacked.end());
+    if (!commands.empty()) {
+        AckRange range = findRange(commands.front(), commands.back());
+        DeliveryRecords::iterator removed =
+            remove_if(range.start, range.end,
+                      isInSequenceSetAnd(commands,
+                                         bind(&SemanticState::complete, this, _1)));
+        unacked.erase(removed, range.end);
+    }
     requestDispatch();
     getSession().setUnackedCount(unacked.size());
 }
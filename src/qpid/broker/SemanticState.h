@@ -53,6 +53,7 @@
 #include <boost/cast.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 
 namespace qpid {
 namespace broker {
@@ -101,6 +102,7 @@ class SemanticState : private boost::noncopyable {
     DtxBufferMap suspendedXids;
     framing::SequenceSet accumulatedAck;
     boost::shared_ptr<Exchange> cacheExchange;
+    AclPublishCache aclPublishCache;
     const bool authMsg;
     const std::string userID;
     bool closeComplete;
@@ -218,6 +220,9 @@ class SemanticStateConsumerImpl : public Consumer, public sys::OutputTask,
     int deliveryCount;
     qmf::org::apache::qpid::broker::Subscription::shared_ptr mgmtObject;
     ProtocolRegistry& protocols;
+    // shared by the records of unacked deliveries; not held once they
+    // have all gone, as the context refers back to this consumer
+    boost::weak_ptr<DeliveryRecord::Context> deliveryContext;
 
     bool checkCredit(const Message& msg);
     void allocateCredit(const Message& msg);
@@ -230,6 +230,7 @@ void SessionState::handleContent(AMQFrame& frame)
         msg->getIngressCompletion().begin();
         // This call should come before routing, because it calcs required credit.
         msgBuilder.end();
+        getConnection().recordMessageFromClient(msg->getMessageSize());
         semanticState.route(deliverable.getMessage(), deliverable);
         msg->getIngressCompletion().end(xfer);  // allows msg to complete xfer
     }
@@ -317,6 +318,7 @@ DeliveryId SessionState::deliver(const qpid::broker::amqp_0_10::MessageTransfer&
     getProxy().getHandler().handle(method);
     message.sendHeader(getProxy().getHandler(), maxFrameSize, isRedelivered, ttl, annotations);
     message.sendContent(getProxy().getHandler(), maxFrameSize);
+    getConnection().recordMessageToClient(message.getMessageSize());
 
     assert(senderGetCommandPoint() == SessionPoint(commandId+1, 0)); // Delivery has moved sendPoint.
     if (sync) {
@@ -36,7 +36,8 @@ TxAccept::TxAccept(const SequenceSet& _acked, DeliveryRecords& _unacked) :
 {}
 
 void TxAccept::each(boost::function<void(DeliveryRecord&)> f) {
-    DeliveryRecords::iterator dr = unacked.begin();
+    if (acked.empty()) return;
+    DeliveryRecords::iterator dr = lower_bound(unacked.begin(), unacked.end(), acked.front());
     SequenceSet::iterator seq = acked.begin();
     while(dr != unacked.end() && seq != acked.end()) {
         if (dr->getId() == *seq) {
@@ -122,7 +122,7 @@ void Authorise::outgoing(boost::shared_ptr<Queue> queue)
 void Authorise::route(boost::shared_ptr<Exchange> exchange, const Message& msg)
 {
     if (acl && acl->doTransferAcl()) {
-        if (!acl->authorise(user, acl::ACT_PUBLISH, acl::OBJ_EXCHANGE, exchange->getName(), msg.getRoutingKey()))
+        if (!acl->authorisePublish(user, exchange->getName(), msg.getRoutingKey(), publishCache))
             throw Exception(qpid::amqp::error_conditions::UNAUTHORIZED_ACCESS, QPID_MSG(user << " cannot publish to " << exchange->getName() << " with routing-key " << msg.getRoutingKey()));
     }
 }
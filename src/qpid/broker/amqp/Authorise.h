@@ -21,12 +21,12 @@
  * under the License.
  *
  */
+#include "qpid/broker/AclModule.h"
 #include <string>
 #include <boost/shared_ptr.hpp>
 
 namespace qpid {
 namespace broker {
-class AclModule;
 class Exchange;
 class Message;
 class Queue;
@@ -59,6 +59,7 @@ class Authorise
   private:
     const std::string user;
     AclModule* const acl;
+    AclPublishCache publishCache;
 
 };
 }}} // namespace qpid::broker::amqp
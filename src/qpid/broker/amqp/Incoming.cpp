@@ -128,6 +128,7 @@ void DecodingIncoming::readable(pn_delivery_t* delivery)
         partial = received;
     } else {
 	incomingMessageReceived();
+        session.getParent().recordMessageFromClient(received->getSize());
         if (offset) {
             QPID_LOG(debug, "Message complete: received " << pending << " bytes, " << received->getSize() << " in total");
         } else {
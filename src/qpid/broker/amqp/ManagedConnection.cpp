@@ -22,9 +22,11 @@
 #include "qpid/broker/amqp/Exception.h"
 #include "qpid/amqp/descriptors.h"
 #include "qpid/broker/Broker.h"
+#include "qpid/broker/ConnectionHistograms.h"
 #include "qpid/management/ManagementAgent.h"
 #include "qpid/log/Statement.h"
 #include "qpid/types/Variant.h"
+#include "qmf/org/apache/qpid/broker/ArgsConnectionGetHistograms.h"
 #include "qmf/org/apache/qpid/broker/EventClientConnect.h"
 #include "qmf/org/apache/qpid/broker/EventClientDisconnect.h"
 
@@ -47,7 +49,8 @@ template <typename T> T getProperty(const std::string& key, const qpid::types::V
     }
 }
 }
-ManagedConnection::ManagedConnection(Broker& broker, const std::string i, bool brokerInitiated) : id(i), agent(0)
+ManagedConnection::ManagedConnection(Broker& broker, const std::string i, bool brokerInitiated)
+    : id(i), agent(0), histograms(broker.isKeepingHistograms() ? new ConnectionHistograms : 0)
 {
     //management integration:
     agent = broker.getManagementAgent();
@@ -180,13 +183,21 @@ void ManagedConnection::incomingMessageReceived()
 {
     if (connection) connection->inc_msgsFromClient();
 }
+void ManagedConnection::recordMessageFromClient(uint64_t size)
+{
+    if (histograms) histograms->fromClient(size);
+}
+void ManagedConnection::recordMessageToClient(uint64_t size)
+{
+    if (histograms) histograms->toClient(size);
+}
 
 void ManagedConnection::closedByManagement()
 {
     throw Exception(qpid::amqp::error_conditions::NOT_IMPLEMENTED, QPID_MSG(id << "Connection close requested, but not implemented"));
 }
 
-qpid::management::Manageable::status_t ManagedConnection::ManagementMethod(uint32_t methodId, qpid::management::Args&, std::string& error)
+qpid::management::Manageable::status_t ManagedConnection::ManagementMethod(uint32_t methodId, qpid::management::Args& args, std::string& error)
 {
     qpid::management::Manageable::status_t status = qpid::management::Manageable::STATUS_UNKNOWN_METHOD;
 
@@ -198,6 +209,16 @@ qpid::management::Manageable::status_t ManagedConnection::ManagementMethod(uint3
             if (connection) connection->set_closing(true);
             status = qpid::management::Manageable::STATUS_OK;
             break;
+          case _qmf::Connection::METHOD_GETHISTOGRAMS :
+            if (histograms) {
+                _qmf::ArgsConnectionGetHistograms& a = (_qmf::ArgsConnectionGetHistograms&) args;
+                histograms->mapEncode(a.o_histograms, a.i_reset);
+                status = qpid::management::Manageable::STATUS_OK;
+            } else {
+                error = "Histograms are not enabled";
+                status = qpid::management::Manageable::STATUS_FEATURE_NOT_IMPLEMENTED;
+            }
+            break;
         }
     } catch (const Exception& e) {
         if (e.symbol() == qpid::amqp::error_conditions::NOT_IMPLEMENTED) {
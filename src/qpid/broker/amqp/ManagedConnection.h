@@ -25,6 +25,7 @@
 #include "qpid/broker/Connection.h"
 #include "qpid/types/Variant.h"
 #include "qmf/org/apache/qpid/broker/Connection.h"
+#include <boost/scoped_ptr.hpp>
 
 namespace qpid {
 namespace management {
@@ -33,6 +34,7 @@ class ManagementObject;
 }
 namespace broker {
 class Broker;
+class ConnectionHistograms;
 namespace amqp {
 
 class ManagedConnection : public qpid::management::Manageable, public qpid::broker::Connection
@@ -53,6 +55,9 @@ class ManagedConnection : public qpid::management::Manageable, public qpid::brok
     bool isLocal(const OwnershipToken* t) const;
     void incomingMessageReceived();
     void outgoingMessageSent();
+    /** Record message sizes, if histograms are enabled for the broker */
+    void recordMessageFromClient(uint64_t size);
+    void recordMessageToClient(uint64_t size);
 
     //ConnectionIdentity
     const management::ObjectId getObjectId() const;
@@ -74,6 +79,7 @@ class ManagedConnection : public qpid::management::Manageable, public qpid::brok
     qmf::org::apache::qpid::broker::Connection::shared_ptr connection;
     qpid::management::ManagementAgent* agent;
     std::map<std::string, types::Variant> peerProperties;
+    boost::scoped_ptr<ConnectionHistograms> histograms;
 };
 }}} // namespace qpid::broker::amqp
 
@@ -30,6 +30,7 @@
 #include "qpid/types/encodings.h"
 #include "qpid/log/Statement.h"
 #include "qpid/framing/Buffer.h"
+#include <algorithm>
 #include <string.h>
 #include <boost/lexical_cast.hpp>
 
@@ -147,7 +148,7 @@ class StringRetriever : public MapHandler
 std::string Message::getPropertyAsString(const std::string& key) const
 {
     StringRetriever sr(key);
-    processProperties(sr);
+    processProperty(key, sr);
     return sr.getValue();
 }
 
@@ -291,12 +292,128 @@ void processMapData(const CharSequence& source, MapHandler& handler)
     d.read(adapter);
 
 }
+
+/**
+ * Records, for each key in a map's elements, the extent of the
+ * encoded key and value. Nested values are skipped rather than
+ * decoded.
+ */
+class PropertyIndexer : public Reader
+{
+  public:
+    typedef std::vector<std::pair<CharSequence, CharSequence> > Index;
+
+    PropertyIndexer(const qpid::amqp::Decoder& d, const CharSequence& s, Index& i)
+        : decoder(d), source(s), index(i), current(0), elements(0), valid(true) {}
+
+    bool proceed()
+    {
+        if (elements % 2) {
+            // about to read a value; the key must have been a string
+            if (index.size() * 2 != elements + 1) valid = false;
+        } else if (elements) {
+            // finished a value; the entry ends here
+            index.back().second.size = decoder.getPosition() - (index.back().second.data - source.data);
+        }
+        current = source.data + decoder.getPosition();
+        ++elements;
+        return valid;
+    }
+
+    void onString(const CharSequence& s, const Descriptor*)
+    {
+        if (elements % 2) {
+            CharSequence encoded;
+            encoded.data = current;
+            encoded.size = 0;
+            index.push_back(std::make_pair(s, encoded));
+        }
+    }
+
+    bool onStartList(uint32_t, const CharSequence&, const CharSequence&, const Descriptor*) { return false; }
+    bool onStartMap(uint32_t, const CharSequence&, const CharSequence&, const Descriptor*) { return false; }
+    bool onStartArray(uint32_t, const CharSequence&, const Constructor&, const Descriptor*) { return false; }
+
+    bool finish()
+    {
+        if (valid && elements % 2 == 0 && index.size() * 2 == elements) {
+            if (elements) index.back().second.size = source.size - (index.back().second.data - source.data);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+  private:
+    const qpid::amqp::Decoder& decoder;
+    const CharSequence source;
+    Index& index;
+    const char* current;
+    size_t elements;
+    bool valid;
+};
+
+int compare(const char* a, size_t aSize, const char* b, size_t bSize)
+{
+    int result = ::memcmp(a, b, std::min(aSize, bSize));
+    if (result) return result;
+    else return aSize < bSize ? -1 : (aSize > bSize ? 1 : 0);
+}
+
+struct KeyLess
+{
+    bool operator()(const PropertyIndexer::Index::value_type& a, const PropertyIndexer::Index::value_type& b) const
+    {
+        return compare(a.first.data, a.first.size, b.first.data, b.first.size) < 0;
+    }
+    bool operator()(const std::string& a, const PropertyIndexer::Index::value_type& b) const
+    {
+        return compare(a.data(), a.size(), b.first.data, b.first.size) < 0;
+    }
+};
 }
 
 void Message::processProperties(MapHandler& mh) const {
     processMapData(applicationProperties, mh);
 }
 
+bool Message::indexProperties() const
+{
+    qpid::sys::Mutex::ScopedLock l(propertyLock);
+    if (!propertiesIndexed) {
+        qpid::amqp::Decoder decoder(applicationProperties.data, applicationProperties.size);
+        PropertyIndexer indexer(decoder, applicationProperties, propertyIndex);
+        try {
+            decoder.read(indexer);
+            propertiesIndexable = indexer.finish();
+        } catch (const std::exception& e) {
+            QPID_LOG(debug, "Could not index application-properties: " << e.what());
+            propertiesIndexable = false;
+        }
+        if (propertiesIndexable) {
+            // keep the order of duplicates, so that the last one is found
+            std::stable_sort(propertyIndex.begin(), propertyIndex.end(), KeyLess());
+        } else {
+            PropertyIndex().swap(propertyIndex);
+        }
+        propertiesIndexed = true;
+    }
+    return propertiesIndexable;
+}
+
+void Message::processProperty(const std::string& key, MapHandler& mh) const
+{
+    if (indexProperties()) {
+        // the index is not modified once built
+        PropertyIndex::const_iterator i = std::upper_bound(propertyIndex.begin(), propertyIndex.end(), key, KeyLess());
+        if (i != propertyIndex.begin() && compare(key.data(), key.size(), (i-1)->first.data, (i-1)->first.size) == 0) {
+            processMapData((i-1)->second, mh);
+        }
+    } else {
+        processProperties(mh);
+    }
+}
+
 std::string Message::getAnnotationAsString(const std::string& key) const
 {
     StringRetriever sr(key);
@@ -314,7 +431,7 @@ std::string Message::getContent() const
     return std::string(body.data, body.size);
 }
 
-Message::Message(size_t size) : data(size), bodyDescriptor(0)
+Message::Message(size_t size) : data(size), propertiesIndexed(false), propertiesIndexable(false), bodyDescriptor(0)
 {
     deliveryAnnotations.init();
     messageAnnotations.init();
@@ -380,9 +497,25 @@ qpid::amqp::CharSequence Message::getFooter() const
 {
     return footer;
 }
+qpid::amqp::CharSequence Message::getSectionsAfterHeader() const
+{
+    qpid::amqp::CharSequence sections;
+    if (deliveryAnnotations.size) sections.data = deliveryAnnotations.data;
+    else if (messageAnnotations.size) sections.data = messageAnnotations.data;
+    else if (bareMessage.size) sections.data = bareMessage.data;
+    else if (footer.size) sections.data = footer.data;
+    else sections.data = getData() + getSize();
+    sections.size = getSize() - (sections.data - getData());
+    return sections;
+}
 
 void Message::scan()
 {
+    {
+        qpid::sys::Mutex::ScopedLock l(propertyLock);
+        PropertyIndex().swap(propertyIndex);
+        propertiesIndexed = false;
+    }
     qpid::amqp::Decoder decoder(getData(), getSize());
     decoder.read(*this);
     bareMessage = qpid::amqp::MessageReader::getBareMessage();
@@ -21,12 +21,16 @@
  * under the License.
  *
  */
+#include "qpid/broker/BrokerImportExport.h"
 #include "qpid/broker/Message.h"
 #include "qpid/amqp/CharSequence.h"
 #include "qpid/amqp/Descriptor.h"
 #include "qpid/amqp/MessageId.h"
 #include "qpid/amqp/MessageReader.h"
+#include "qpid/sys/Mutex.h"
 #include <boost/optional.hpp>
+#include <utility>
+#include <vector>
 
 namespace qpid {
 namespace framing {
@@ -38,7 +42,7 @@ namespace amqp {
 /**
  * Represents an AMQP 1.0 format message
  */
-class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amqp::MessageReader, public qpid::broker::PersistableMessage
+class QPID_BROKER_CLASS_EXTERN Message : public qpid::broker::Message::SharedStateImpl, private qpid::amqp::MessageReader, public qpid::broker::PersistableMessage
 {
   public:
     //Encoding interface:
@@ -51,6 +55,7 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     bool getTtl(uint64_t&) const;
     std::string getContent() const;
     void processProperties(qpid::amqp::MapHandler&) const;
+    void processProperty(const std::string& key, qpid::amqp::MapHandler&) const;
     std::string printProperties() const;
     std::string getUserId() const;
     uint64_t getTimestamp() const;
@@ -70,6 +75,11 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     qpid::amqp::CharSequence getBareMessage() const;
     qpid::amqp::CharSequence getBody() const;
     qpid::amqp::CharSequence getFooter() const;
+    /**
+     * @returns the encoded annotations, bare message and footer, which
+     * directly follow any header and can be sent as they are
+     */
+    qpid::amqp::CharSequence getSectionsAfterHeader() const;
     bool isTypedBody() const;
     qpid::types::Variant getTypedBody() const;
     const qpid::amqp::Descriptor& getBodyDescriptor() const;
@@ -116,6 +126,16 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
 
     //application-properties:
     qpid::amqp::CharSequence applicationProperties;
+    /**
+     * Index over the application-properties, built on the first
+     * lookup of a single property. Each entry maps a key to the
+     * encoded key and value, sorted by key.
+     */
+    typedef std::vector<std::pair<qpid::amqp::CharSequence, qpid::amqp::CharSequence> > PropertyIndex;
+    mutable PropertyIndex propertyIndex;
+    mutable bool propertiesIndexed;
+    mutable bool propertiesIndexable;
+    mutable qpid::sys::Mutex propertyLock;
 
     //body:
     qpid::amqp::CharSequence body;
@@ -126,6 +146,8 @@ class Message : public qpid::broker::Message::SharedStateImpl, private qpid::amq
     //footer:
     qpid::amqp::CharSequence footer;
 
+    bool indexProperties() const;
+
     //header:
     void onDurable(bool b);
     void onPriority(uint8_t i);
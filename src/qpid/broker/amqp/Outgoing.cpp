@@ -22,6 +22,7 @@
 #include "qpid/broker/amqp/Outgoing.h"
 #include "qpid/broker/amqp/Exception.h"
 #include "qpid/broker/amqp/Header.h"
+#include "qpid/broker/amqp/ManagedConnection.h"
 #include "qpid/broker/amqp/Session.h"
 #include "qpid/broker/amqp/Translation.h"
 #include "qpid/broker/Broker.h"
@@ -232,6 +233,7 @@ bool OutgoingFromQueue::deliver(const QueueCursor& cursor, const qpid::broker::M
     if (pn_link_advance(link)) {
         if (unreliable) pn_delivery_settle(r.delivery);
         outgoingMessageSent();
+        session.getParent().recordMessageToClient(r.msg.getMessageSize());
         QPID_LOG(debug, "Sent message " << r.msg.getSequence() << " from " << queue->getName() << ", index=" << r.index);
     } else {
         QPID_LOG(error, "Failed to send message " << r.msg.getSequence() << " from " << queue->getName() << ", index=" << r.index);
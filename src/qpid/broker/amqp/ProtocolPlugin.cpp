@@ -52,12 +52,15 @@ struct Options : public qpid::Options {
     std::string domain;
     std::vector<std::string> queuePatterns;
     std::vector<std::string> topicPatterns;
+    uint64_t translationCacheLimit;
 
-    Options() : qpid::Options("AMQP 1.0 Options") {
+    Options() : qpid::Options("AMQP 1.0 Options"), translationCacheLimit(Translation::DEFAULT_CACHE_LIMIT) {
         addOptions()
             ("domain", optValue(domain, "DOMAIN"), "Domain of this broker")
             ("queue-patterns", optValue(queuePatterns, "PATTERN"), "Pattern for on-demand queues")
-            ("topic-patterns", optValue(topicPatterns, "PATTERN"), "Pattern for on-demand topics");
+            ("topic-patterns", optValue(topicPatterns, "PATTERN"), "Pattern for on-demand topics")
+            ("translation-cache-limit", optValue(translationCacheLimit, "BYTES"),
+             "Most bytes held by translations between AMQP 0-10 and 1.0 that are kept with messages for reuse (0 disables)");
     }
 };
 
@@ -92,6 +95,7 @@ struct ProtocolPlugin : public Plugin
         //need to register protocol before recovery from store
         broker::Broker* broker = dynamic_cast<qpid::broker::Broker*>(&target);
         if (broker) {
+            Translation::setCacheLimit(options.translationCacheLimit);
             policies = new NodePolicyRegistry();
             ProtocolImpl* impl = new ProtocolImpl(new Interconnects(), new TopicRegistry(), policies, *broker, options.domain);
             broker->getProtocolRegistry().add("amqp1.0", impl);//registry deletes on shutdown
@@ -19,6 +19,8 @@
  *
  */
 #include "Relay.h"
+#include "ManagedConnection.h"
+#include "Session.h"
 #include "qpid/Exception.h"
 #include "qpid/log/Statement.h"
 #include <algorithm>
@@ -146,6 +148,7 @@ void OutgoingFromRelay::handle(pn_delivery_t* delivery)
     if (pn_delivery_writable(delivery)) {
         if (transfer->write(link)) {
             outgoingMessageSent();
+            session.getParent().recordMessageToClient(transfer->getSize());
             QPID_LOG(debug, "Sent relayed message " << name << " [" << relay.get() << "]");
         } else {
             QPID_LOG(error, "Failed to send relayed message " << name << " [" << relay.get() << "]");
@@ -219,6 +222,7 @@ bool IncomingToRelay::haveWork()
 }
 void IncomingToRelay::readable(pn_delivery_t* delivery)
 {
+    session.getParent().recordMessageFromClient(pn_delivery_pending(delivery));
     relay->received(link, delivery);
     --window;
 }
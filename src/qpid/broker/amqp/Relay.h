@@ -51,6 +51,7 @@ class BufferedTransfer
     void initOut(pn_link_t* link);
     uint64_t updated();
     bool write(pn_link_t*);
+    size_t getSize() const { return data.size(); }
   private:
     std::vector<char> data;
     Delivery in;
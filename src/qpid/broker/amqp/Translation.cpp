@@ -30,6 +30,7 @@
 #include "qpid/types/encodings.h"
 #include "qpid/framing/MessageTransferBody.h"
 #include "qpid/log/Statement.h"
+#include "qpid/sys/AtomicValue.h"
 #include <boost/lexical_cast.hpp>
 
 namespace qpid {
@@ -42,6 +43,58 @@ const std::string FORWARD_SLASH("/");
 const std::string TEXT_PLAIN("text/plain");
 const std::string SUBJECT_KEY("qpid.subject");
 const std::string APP_ID("x-amqp-0-10.app-id");
+const std::string AMQP_0_10("amqp0-10");
+const std::string AMQP_1_0("amqp1.0");
+
+/**
+ * The AMQP 1.0 encoding of the bare message, translated from 0-10
+ */
+class EncodedMessage : public qpid::RefCounted
+{
+  public:
+    std::vector<char> data;
+};
+
+/**
+ * Translations kept with a message are not counted against the byte
+ * limits of the queues it is on, so the bytes they hold across the
+ * broker are bounded instead. Beyond the limit, messages are
+ * translated afresh for each delivery.
+ */
+uint64_t cacheLimit(Translation::DEFAULT_CACHE_LIMIT);
+qpid::sys::AtomicValue<uint64_t> cachedBytes;
+
+class CachedTranslation : public qpid::RefCounted
+{
+  public:
+    CachedTranslation(boost::intrusive_ptr<const qpid::RefCounted> t, size_t s) : translation(t), size(s) {}
+    ~CachedTranslation() { cachedBytes -= size; }
+    const boost::intrusive_ptr<const qpid::RefCounted> translation;
+    const size_t size;
+};
+
+boost::intrusive_ptr<const qpid::RefCounted> getCached(const qpid::broker::Message& message, const std::string& protocol)
+{
+    boost::intrusive_ptr<const qpid::RefCounted> cached = message.getSharedState().getTranslation(protocol);
+    if (cached) return static_cast<const CachedTranslation&>(*cached).translation;
+    else return cached;
+}
+
+/**
+ * @returns the translation to use, which is one already cached by
+ * another delivery, if any
+ */
+boost::intrusive_ptr<const qpid::RefCounted> cache(const qpid::broker::Message& message, const std::string& protocol,
+                                                   boost::intrusive_ptr<const qpid::RefCounted> translation, size_t size)
+{
+    if (cachedBytes.fetchAndAdd(size) + size > cacheLimit) {
+        cachedBytes -= size;
+        return translation;
+    }
+    boost::intrusive_ptr<const qpid::RefCounted> cached =
+        message.getSharedState().cacheTranslation(protocol, new CachedTranslation(translation, size));
+    return static_cast<const CachedTranslation&>(*cached).translation;
+}
 
 qpid::framing::ReplyTo translate(const std::string address, Broker* broker)
 {
@@ -153,8 +206,15 @@ class Properties_0_10 : public qpid::amqp::MessageEncoder::Properties
 };
 }
 
+const uint64_t Translation::DEFAULT_CACHE_LIMIT;
+
 Translation::Translation(const qpid::broker::Message& m, Broker* b) : original(m), broker(b) {}
 
+void Translation::setCacheLimit(uint64_t bytes)
+{
+    cacheLimit = bytes;
+}
+
 boost::intrusive_ptr<const qpid::broker::amqp_0_10::MessageTransfer> Translation::getTransfer()
 {
     boost::intrusive_ptr<const qpid::broker::amqp_0_10::MessageTransfer> t =
@@ -164,6 +224,8 @@ boost::intrusive_ptr<const qpid::broker::amqp_0_10::MessageTransfer> Translation
     } else {
         const Message* message = dynamic_cast<const Message*>(&original.getEncoding());
         if (message) {
+            boost::intrusive_ptr<const qpid::RefCounted> cached = getCached(original, AMQP_0_10);
+            if (cached) return dynamic_cast<const qpid::broker::amqp_0_10::MessageTransfer*>(cached.get());
             //translate 1.0 message into 0-10
             boost::intrusive_ptr<qpid::broker::amqp_0_10::MessageTransfer> transfer(new qpid::broker::amqp_0_10::MessageTransfer());
             qpid::framing::AMQFrame method((qpid::framing::MessageTransferBody(qpid::framing::ProtocolVersion(), EMPTY, 0, 0)));
@@ -270,70 +332,82 @@ boost::intrusive_ptr<const qpid::broker::amqp_0_10::MessageTransfer> Translation
                 props->getApplicationHeaders().setString(SUBJECT_KEY, message->getRoutingKey());
             }
 
-            return transfer.get();
+            //the same translation can be used for every delivery, so
+            //keep it with the message
+            cached = cache(original, AMQP_0_10, transfer.get(), transfer->getRequiredCredit());
+            return dynamic_cast<const qpid::broker::amqp_0_10::MessageTransfer*>(cached.get());
         } else {
             throw qpid::Exception("Could not write message data in AMQP 0-10 format");
         }
     }
 }
 
+namespace {
+boost::intrusive_ptr<EncodedMessage> encode(const qpid::broker::amqp_0_10::MessageTransfer& transfer)
+{
+    boost::intrusive_ptr<EncodedMessage> encoded(new EncodedMessage());
+    std::vector<char>& buffer = encoded->data;
+    Properties_0_10 properties(transfer);
+    qpid::types::Variant::Map applicationProperties;
+    qpid::amqp_0_10::translate(properties.getApplicationProperties(), applicationProperties);
+    if (properties.getContentType() == qpid::amqp_0_10::MapCodec::contentType) {
+        qpid::types::Variant::Map content;
+        qpid::amqp_0_10::MapCodec::decode(transfer.getContent(), content);
+        size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties);
+        size += qpid::amqp::MessageEncoder::getEncodedSize(applicationProperties, true) + 3;/*descriptor*/
+        size += qpid::amqp::MessageEncoder::getEncodedSize(content, true) + 3/*descriptor*/;
+        buffer.resize(size);
+        qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
+        encoder.writeProperties(properties);
+        encoder.writeApplicationProperties(applicationProperties);
+        encoder.writeMap(content, &qpid::amqp::message::AMQP_VALUE);
+        buffer.resize(encoder.getPosition());
+    } else if (properties.getContentType() == qpid::amqp_0_10::ListCodec::contentType) {
+        qpid::types::Variant::List content;
+        qpid::amqp_0_10::ListCodec::decode(transfer.getContent(), content);
+        size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties);
+        size += qpid::amqp::MessageEncoder::getEncodedSize(applicationProperties, true) + 3;/*descriptor*/
+        size += qpid::amqp::MessageEncoder::getEncodedSize(content, true) + 3/*descriptor*/;
+        buffer.resize(size);
+        qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
+        encoder.writeProperties(properties);
+        encoder.writeApplicationProperties(applicationProperties);
+        encoder.writeList(content, &qpid::amqp::message::AMQP_VALUE);
+        buffer.resize(encoder.getPosition());
+    } else {
+        std::string content = transfer.getContent();
+        size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties, applicationProperties, content);
+        buffer.resize(size);
+        qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
+        encoder.writeProperties(properties);
+        encoder.writeApplicationProperties(applicationProperties);
+        if (content.size()) encoder.writeBinary(content, &qpid::amqp::message::DATA);
+        buffer.resize(encoder.getPosition());
+    }
+    return encoded;
+}
+}
+
 void Translation::write(OutgoingFromQueue& out)
 {
     const Message* message = dynamic_cast<const Message*>(original.getPersistentContext().get());
     //persistent context will contain any newly added annotations
     if (!message) message = dynamic_cast<const Message*>(&original.getEncoding());
     if (message) {
-        //write annotations
-        qpid::amqp::CharSequence deliveryAnnotations = message->getDeliveryAnnotations();
-        qpid::amqp::CharSequence messageAnnotations = message->getMessageAnnotations();
-        if (deliveryAnnotations.size) out.write(deliveryAnnotations.data, deliveryAnnotations.size);
-        if (messageAnnotations.size) out.write(messageAnnotations.data, messageAnnotations.size);
-        //write bare message
-        qpid::amqp::CharSequence bareMessage = message->getBareMessage();
-        if (bareMessage.size) out.write(bareMessage.data, bareMessage.size);
-        //write footer:
-        qpid::amqp::CharSequence footer = message->getFooter();
-        if (footer.size) out.write(footer.data, footer.size);
+        //write annotations, bare message and footer straight from the
+        //message data, shared by every delivery, in one piece
+        qpid::amqp::CharSequence sections = message->getSectionsAfterHeader();
+        if (sections.size) out.write(sections.data, sections.size);
     } else {
         const qpid::broker::amqp_0_10::MessageTransfer* transfer = dynamic_cast<const qpid::broker::amqp_0_10::MessageTransfer*>(&original.getEncoding());
         if (transfer) {
-            Properties_0_10 properties(*transfer);
-            qpid::types::Variant::Map applicationProperties;
-            qpid::amqp_0_10::translate(properties.getApplicationProperties(), applicationProperties);
-            if (properties.getContentType() == qpid::amqp_0_10::MapCodec::contentType) {
-                qpid::types::Variant::Map content;
-                qpid::amqp_0_10::MapCodec::decode(transfer->getContent(), content);
-                size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties);
-                size += qpid::amqp::MessageEncoder::getEncodedSize(applicationProperties, true) + 3;/*descriptor*/
-                size += qpid::amqp::MessageEncoder::getEncodedSize(content, true) + 3/*descriptor*/;
-                std::vector<char> buffer(size);
-                qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
-                encoder.writeProperties(properties);
-                encoder.writeApplicationProperties(applicationProperties);
-                encoder.writeMap(content, &qpid::amqp::message::AMQP_VALUE);
-                out.write(&buffer[0], encoder.getPosition());
-            } else if (properties.getContentType() == qpid::amqp_0_10::ListCodec::contentType) {
-                qpid::types::Variant::List content;
-                qpid::amqp_0_10::ListCodec::decode(transfer->getContent(), content);
-                size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties);
-                size += qpid::amqp::MessageEncoder::getEncodedSize(applicationProperties, true) + 3;/*descriptor*/
-                size += qpid::amqp::MessageEncoder::getEncodedSize(content, true) + 3/*descriptor*/;
-                std::vector<char> buffer(size);
-                qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
-                encoder.writeProperties(properties);
-                encoder.writeApplicationProperties(applicationProperties);
-                encoder.writeList(content, &qpid::amqp::message::AMQP_VALUE);
-                out.write(&buffer[0], encoder.getPosition());
-            } else {
-                std::string content = transfer->getContent();
-                size_t size = qpid::amqp::MessageEncoder::getEncodedSize(properties, applicationProperties, content);
-                std::vector<char> buffer(size);
-                qpid::amqp::MessageEncoder encoder(&buffer[0], buffer.size());
-                encoder.writeProperties(properties);
-                encoder.writeApplicationProperties(applicationProperties);
-                if (content.size()) encoder.writeBinary(content, &qpid::amqp::message::DATA);
-                out.write(&buffer[0], encoder.getPosition());
+            boost::intrusive_ptr<const qpid::RefCounted> cached = getCached(original, AMQP_1_0);
+            if (!cached) {
+                boost::intrusive_ptr<EncodedMessage> encoded = encode(*transfer);
+                cached = cache(original, AMQP_1_0, encoded, encoded->data.size());
             }
+            const std::vector<char>& encoded = dynamic_cast<const EncodedMessage&>(*cached).data;
+            if (encoded.size()) out.write(&encoded[0], encoded.size());
         } else {
             QPID_LOG(error, "Could not write message data in AMQP 1.0 format");
         }
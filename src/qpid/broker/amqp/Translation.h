@@ -21,6 +21,7 @@
  * under the License.
  *
  */
+#include "qpid/sys/IntegerTypes.h"
 #include <boost/intrusive_ptr.hpp>
 
 namespace qpid {
@@ -51,6 +52,13 @@ class Translation
      * Writes the AMQP 1.0 bare message and any annotations, translating from 0-10 if necessary
      */
     void write(OutgoingFromQueue&);
+
+    static const uint64_t DEFAULT_CACHE_LIMIT = 64*1024*1024;
+    /**
+     * Sets the most bytes that translations kept with messages, for
+     * reuse by later deliveries, may hold in total (0 disables)
+     */
+    static void setCacheLimit(uint64_t bytes);
   private:
     const qpid::broker::Message& original;
     Broker* broker;
@@ -25,6 +25,7 @@
 #include "qpid/broker/SessionState.h"
 #include "qpid/broker/Bridge.h"
 #include "qpid/broker/Broker.h"
+#include "qpid/broker/ConnectionHistograms.h"
 #include "qpid/broker/Queue.h"
 #include "qpid/management/ManagementAgent.h"
 #include "qpid/sys/ConnectionOutputHandler.h"
@@ -38,6 +39,7 @@
 #include "qpid/framing/MessageTransferBody.h"
 #include "qmf/org/apache/qpid/broker/EventClientConnect.h"
 #include "qmf/org/apache/qpid/broker/EventClientDisconnect.h"
+#include "qmf/org/apache/qpid/broker/ArgsConnectionGetHistograms.h"
 
 #include <boost/bind.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -147,7 +149,8 @@ Connection::Connection(ConnectionOutputHandler* out_,
     links(broker_.getLinks()),
     agent(0),
     timer(broker_.getTimer()),
-    objectId(objectId_)
+    objectId(objectId_),
+    histograms(broker_.isKeepingHistograms() ? new ConnectionHistograms : 0)
 {
     broker.getConnectionObservers().connection(*this);
     assert(agent == 0);
@@ -247,6 +250,16 @@ void Connection::recordFromClient(const framing::AMQFrame& frame)
     }
 }
 
+void Connection::recordMessageFromClient(uint64_t size)
+{
+    if (histograms) histograms->fromClient(size);
+}
+
+void Connection::recordMessageToClient(uint64_t size)
+{
+    if (histograms) histograms->toClient(size);
+}
+
 string Connection::getAuthMechanism()
 {
     if (!link)
@@ -432,7 +445,7 @@ ManagementObject::shared_ptr Connection::GetManagementObject(void) const
     return mgmtObject;
 }
 
-Manageable::status_t Connection::ManagementMethod(uint32_t methodId, Args&, string&)
+Manageable::status_t Connection::ManagementMethod(uint32_t methodId, Args& args, string& etext)
 {
     Manageable::status_t status = Manageable::STATUS_UNKNOWN_METHOD;
 
@@ -446,6 +459,17 @@ Manageable::status_t Connection::ManagementMethod(uint32_t methodId, Args&, stri
         out->activateOutput();
         status = Manageable::STATUS_OK;
         break;
+
+    case _qmf::Connection::METHOD_GETHISTOGRAMS :
+        if (histograms) {
+            _qmf::ArgsConnectionGetHistograms& a = (_qmf::ArgsConnectionGetHistograms&) args;
+            histograms->mapEncode(a.o_histograms, a.i_reset);
+            status = Manageable::STATUS_OK;
+        } else {
+            etext = "Histograms are not enabled";
+            status = Manageable::STATUS_FEATURE_NOT_IMPLEMENTED;
+        }
+        break;
     }
 
     return status;
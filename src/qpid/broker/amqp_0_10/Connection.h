@@ -58,6 +58,7 @@ class TimerTask;
 namespace broker {
 
 class Broker;
+class ConnectionHistograms;
 class LinkRegistry;
 class Queue;
 class SecureConnection;
@@ -139,6 +140,9 @@ class Connection : public sys::ConnectionInputHandler, public qpid::broker::Conn
     void requestIOProcessing (boost::function0<void>);
     void recordFromServer (const framing::AMQFrame& frame);
     void recordFromClient (const framing::AMQFrame& frame);
+    /** Record message sizes, if histograms are enabled for the broker */
+    void recordMessageFromClient(uint64_t size);
+    void recordMessageToClient(uint64_t size);
 
     // gets for configured federation links
     std::string getAuthMechanism();
@@ -214,6 +218,7 @@ class Connection : public sys::ConnectionInputHandler, public qpid::broker::Conn
     boost::intrusive_ptr<ConnectionTimeoutTask> timeoutTimer;
     uint64_t objectId;
     types::Variant::Map clientProperties;
+    boost::scoped_ptr<ConnectionHistograms> histograms;
 
     void raiseConnectEvent();
 
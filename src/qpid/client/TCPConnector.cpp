@@ -34,7 +34,9 @@
 #include "qpid/sys/SecurityLayer.h"
 #include "qpid/Msg.h"
 
+#include <algorithm>
 #include <iostream>
+#include <string.h>
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
 
@@ -64,8 +66,8 @@ TCPConnector::TCPConnector(Poller::shared_ptr p,
                      const ConnectionSettings& settings,
                      ConnectionImpl* cimpl)
     : maxFrameSize(settings.maxFrameSize),
-      lastEof(0),
-      currentSize(0),
+      current(0),
+      currentEof(false),
       bounds(cimpl),
       version(ver),
       initiated(false),
@@ -185,15 +187,26 @@ void TCPConnector::handle(AMQFrame& frame) {
     bool notifyWrite = false;
     {
     Mutex::ScopedLock l(lock);
-    frames.push_back(frame);
+    // Frames handed over once closed would never be written
+    if (closed) return;
+    size_t size = frame.encodedSize();
+    if (current && size_t(current->byteCount - current->dataStart - current->dataCount) < size) {
+        ready.push_back(current);
+        current = 0;
+        currentEof = false;
+    }
+    if (!current) current = spareChunk(size);
+    framing::Buffer out(current->bytes + current->dataStart + current->dataCount, size);
+    frame.encode(out);
+    current->dataCount += size;
+    QPID_LOG(trace, "SENT [" << identifier << "]: " << frame);
     //only ask to write if this is the end of a frameset or if we
     //already have a buffers worth of data
-    currentSize += frame.encodedSize();
     if (frame.getEof()) {
-        lastEof = frames.size();
+        currentEof = true;
         notifyWrite = true;
     } else {
-        notifyWrite = (currentSize >= maxFrameSize);
+        notifyWrite = !ready.empty();
     }
     /*
       NOTE: Moving the following line into this mutex block
@@ -210,6 +223,42 @@ void TCPConnector::handle(AMQFrame& frame) {
     }
 }
 
+// Called with lock held.
+TCPConnector::Chunk* TCPConnector::spareChunk(size_t size)
+{
+    if (!spare.empty() && size <= size_t(spare.back()->byteCount)) {
+        Chunk* chunk = spare.back();
+        spare.pop_back();
+        return chunk;
+    }
+    size = std::max(size, size_t(maxFrameSize));
+    memory.push_back(boost::shared_array<char>(new char[size]));
+    chunks.push_back(new Chunk(memory.back().get(), size));
+    return &chunks.back();
+}
+
+// Called with lock held: the next chunk with bytes to write, if any.
+TCPConnector::Chunk* TCPConnector::writable()
+{
+    if (!ready.empty()) return ready.front();
+    else if (current && current->dataCount) return current;
+    else return 0;
+}
+
+// Called with lock held, once all of the chunk's bytes are written.
+void TCPConnector::written(Chunk* chunk)
+{
+    if (chunk == current) {
+        current = 0;
+        currentEof = false;
+    } else {
+        ready.pop_front();
+    }
+    chunk->dataStart = 0;
+    chunk->dataCount = 0;
+    spare.push_back(chunk);
+}
+
 void TCPConnector::writebuff(AsynchIO& /*aio*/) 
 {
     // It's possible to be disconnected and be writable
@@ -225,7 +274,7 @@ void TCPConnector::writebuff(AsynchIO& /*aio*/)
     AsynchIO::BufferBase* buffer = aio->getQueuedBuffer();
     if (buffer) {
 
-        size_t encoded = codec->encode(buffer->bytes, buffer->byteCount);
+        size_t encoded = securityLayer.get() ? codec->encode(buffer->bytes, buffer->byteCount) : handOver(*buffer);
 
         buffer->dataStart = 0;
         buffer->dataCount = encoded;
@@ -238,24 +287,47 @@ bool TCPConnector::canEncode()
 {
     Mutex::ScopedLock l(lock);
     //have at least one full frameset or a whole buffers worth of data
-    return lastEof || currentSize >= maxFrameSize;
+    return !ready.empty() || currentEof;
+}
+
+// Called in IO thread. Exchanges the memory of the next chunk with
+// that of the empty buffer, if they are the same size; otherwise falls
+// back to copying.
+size_t TCPConnector::handOver(AsynchIO::BufferBase& buffer)
+{
+    size_t bytesWritten(0);
+    {
+        Mutex::ScopedLock l(lock);
+        Chunk* chunk = writable();
+        if (chunk && chunk->dataStart == 0 && chunk->byteCount == buffer.byteCount) {
+            std::swap(chunk->bytes, buffer.bytes);
+            bytesWritten = chunk->dataCount;
+            written(chunk);
+        }
+    }
+    if (bytesWritten) {
+        if (bounds) bounds->reduce(bytesWritten);
+        return bytesWritten;
+    } else {
+        return encode(buffer.bytes, buffer.byteCount);
+    }
 }
 
 // Called in IO thread.
 size_t TCPConnector::encode(char* buffer, size_t size)
 {
-    framing::Buffer out(buffer, size);
     size_t bytesWritten(0);
     {
         Mutex::ScopedLock l(lock);
-        while (!frames.empty() && out.available() >= frames.front().encodedSize() ) {
-            frames.front().encode(out);
-            QPID_LOG(trace, "SENT [" << identifier << "]: " << frames.front());
-            frames.pop_front();
-            if (lastEof) --lastEof;
+        Chunk* chunk;
+        while (bytesWritten < size && (chunk = writable())) {
+            size_t count = std::min(size - bytesWritten, size_t(chunk->dataCount));
+            ::memcpy(buffer + bytesWritten, chunk->bytes + chunk->dataStart, count);
+            bytesWritten += count;
+            chunk->dataStart += count;
+            chunk->dataCount -= count;
+            if (!chunk->dataCount) written(chunk);
         }
-        bytesWritten = size - out.available();
-        currentSize -= bytesWritten;
     }
     if (bounds) bounds->reduce(bytesWritten);
     return bytesWritten;
@@ -34,10 +34,13 @@
 #include "qpid/sys/Socket.h"
 #include "qpid/sys/Thread.h"
 
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <deque>
 #include <string>
+#include <vector>
 
 namespace qpid {
 
@@ -49,14 +52,21 @@ namespace client {
 
 class TCPConnector : public Connector, public sys::Codec
 {
-    typedef std::deque<framing::AMQFrame> Frames;
-
     const uint16_t maxFrameSize;
 
+    // Outgoing frames are encoded as they are handed to the connector,
+    // in the sending thread, into chunks of maxFrameSize bytes. The IO
+    // thread hands a chunk over by exchanging its memory with that of
+    // an empty write buffer, so the bytes are not copied again.
+    typedef sys::AsynchIOBufferBase Chunk;
+
     sys::Mutex lock;
-    Frames frames; // Outgoing frame queue
-    size_t lastEof; // Position after last EOF in frames
-    uint64_t currentSize;
+    boost::ptr_vector<Chunk> chunks; // All chunks, in use or spare
+    std::vector<boost::shared_array<char> > memory; // Allocated for chunks
+    std::deque<Chunk*> ready; // Filled chunks, waiting to be written
+    std::vector<Chunk*> spare;
+    Chunk* current; // Chunk frames are being encoded into, if any
+    bool currentEof; // Current chunk holds the end of a frameset
     Bounds* bounds;
 
     framing::ProtocolVersion version;
@@ -92,6 +102,11 @@ class TCPConnector : public Connector, public sys::Codec
     size_t encode(char* buffer, size_t size);
     bool canEncode();
 
+    Chunk* spareChunk(size_t size);
+    Chunk* writable();
+    void written(Chunk*);
+    size_t handOver(sys::AsynchIOBufferBase&);
+
 protected:
     virtual ~TCPConnector();
     void connect(const std::string& host, const std::string& port);
@@ -74,6 +74,13 @@ bool ReceiverImpl::fetch(qpid::messaging::Message& message, qpid::messaging::Dur
     return f.result;
 }
 
+size_t ReceiverImpl::fetch(std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout)
+{
+    FetchBatch f(*this, messages, max, timeout);
+    while (!parent->execute(f)) {}
+    return f.fetched();
+}
+
 void ReceiverImpl::close()
 {
     execute<Close>();
@@ -220,6 +227,58 @@ bool ReceiverImpl::fetchImpl(qpid::messaging::Message& message, qpid::messaging:
     }
 }
 
+bool ReceiverImpl::getImpl(std::vector<qpid::messaging::Message>& messages, qpid::messaging::Duration timeout)
+{
+    messages.push_back(qpid::messaging::Message());
+    try {
+        if (getImpl(messages.back(), timeout)) return true;
+    } catch (...) {
+        messages.pop_back();
+        throw;
+    }
+    messages.pop_back();
+    return false;
+}
+
+void ReceiverImpl::fetchImpl(std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout)
+{
+    if (max == 0) return;
+    bool credit;
+    {
+        sys::Mutex::ScopedLock l(lock);
+        if (state == CANCELLED) return;
+
+        //issue credit for the whole batch at once
+        credit = capacity == 0 || state != STARTED;
+        if (credit) {
+            session.messageSetFlowMode(destination, FLOW_MODE_CREDIT);
+            session.messageFlow(destination, CREDIT_UNIT_MESSAGE, max);
+            session.messageFlow(destination, CREDIT_UNIT_BYTE, 0xFFFFFFFF);
+        }
+    }
+    size_t count = 0;
+    if (getImpl(messages, timeout)) {
+        for (++count; count < max && getImpl(messages, Duration::IMMEDIATE); ++count) {}
+    }
+    if (count == 0 || (credit && count < max)) {
+        //check with the server for any messages still to come, which
+        //also reclaims any unused credit
+        qpid::client::Session s;
+        {
+            sys::Mutex::ScopedLock l(lock);
+            if (state == CANCELLED) return; // Might have been closed during get.
+            s = sync(session);
+        }
+        s.messageFlush(destination);
+        {
+            sys::Mutex::ScopedLock l(lock);
+            startFlow(l); //reallocate credit
+            session.sendCompletion();//ensure previously received messages are signalled as completed
+        }
+        for (; count < max && getImpl(messages, Duration::IMMEDIATE); ++count) {}
+    }
+}
+
 void ReceiverImpl::closeImpl()
 {
     sys::Mutex::ScopedLock l(lock);
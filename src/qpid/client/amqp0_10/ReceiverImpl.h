@@ -55,6 +55,7 @@ class ReceiverImpl : public qpid::messaging::ReceiverImpl
     qpid::messaging::Message get(qpid::messaging::Duration timeout);
     bool fetch(qpid::messaging::Message& message, qpid::messaging::Duration timeout);
     qpid::messaging::Message fetch(qpid::messaging::Duration timeout);
+    size_t fetch(std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout);
     void close();
     void start();
     void stop();
@@ -86,6 +87,8 @@ class ReceiverImpl : public qpid::messaging::ReceiverImpl
     //implementation of public facing methods
     bool fetchImpl(qpid::messaging::Message& message, qpid::messaging::Duration timeout);
     bool getImpl(qpid::messaging::Message& message, qpid::messaging::Duration timeout);
+    void fetchImpl(std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout);
+    bool getImpl(std::vector<qpid::messaging::Message>& messages, qpid::messaging::Duration timeout);
     void closeImpl();
     void setCapacityImpl(uint32_t);
 
@@ -119,6 +122,24 @@ class ReceiverImpl : public qpid::messaging::ReceiverImpl
         void operator()() { result = impl.fetchImpl(message, timeout); }
     };
 
+    struct FetchBatch : Command
+    {
+        std::vector<qpid::messaging::Message>& messages;
+        const size_t start;
+        size_t max;
+        qpid::messaging::Duration timeout;
+
+        FetchBatch(ReceiverImpl& i, std::vector<qpid::messaging::Message>& m, size_t n, qpid::messaging::Duration t) :
+            Command(i), messages(m), start(m.size()), max(n), timeout(t) {}
+        size_t fetched() const { return messages.size() - start; }
+        void operator()()
+        {
+            //if repeated after some messages were fetched, don't wait for more
+            size_t n = fetched();
+            impl.fetchImpl(messages, max - n, n ? qpid::messaging::Duration::IMMEDIATE : timeout);
+        }
+    };
+
     struct Close : Command
     {
         Close(ReceiverImpl& i) : Command(i) {}
@@ -51,6 +51,18 @@ void SenderImpl::send(const qpid::messaging::Message& message, bool sync)
     if (sync) parent->sync(true);
 }
 
+void SenderImpl::send(const std::vector<qpid::messaging::Message>& messages, bool sync)
+{
+    if (unreliable) {           // immutable, don't need lock
+        UnreliableSendBatch f(*this, messages);
+        parent->execute(f);
+    } else {
+        SendBatch f(*this, messages);
+        while (f.next < messages.size()) parent->execute(f);
+    }
+    if (sync) parent->sync(true);
+}
+
 void SenderImpl::close()
 {
     execute<Close>();
@@ -100,6 +112,11 @@ void SenderImpl::init(qpid::client::AsyncSession s, AddressResolution& resolver)
 void SenderImpl::waitForCapacity() 
 {
     sys::Mutex::ScopedLock l(lock);
+    waitForCapacity(l);
+}
+
+void SenderImpl::waitForCapacity(const sys::Mutex::ScopedLock& l)
+{
     try {
         //TODO: add option to throw exception rather than blocking?
         if (!unreliable && capacity <=
@@ -137,6 +154,11 @@ void SenderImpl::waitForCapacity()
 void SenderImpl::sendImpl(const qpid::messaging::Message& m)
 {
     sys::Mutex::ScopedLock l(lock);
+    sendImpl(m, l);
+}
+
+void SenderImpl::sendImpl(const qpid::messaging::Message& m, const sys::Mutex::ScopedLock&)
+{
     std::auto_ptr<OutgoingMessage> msg(new OutgoingMessage());
     msg->setSubject(m.getSubject().empty() ? address.getSubject() : m.getSubject());
     msg->convert(m);
@@ -147,12 +169,36 @@ void SenderImpl::sendImpl(const qpid::messaging::Message& m)
 void SenderImpl::sendUnreliable(const qpid::messaging::Message& m)
 {
     sys::Mutex::ScopedLock l(lock);
+    sendUnreliable(m, l);
+}
+
+void SenderImpl::sendUnreliable(const qpid::messaging::Message& m, const sys::Mutex::ScopedLock&)
+{
     OutgoingMessage msg;
     msg.setSubject(m.getSubject().empty() ? address.getSubject() : m.getSubject());
     msg.convert(m);
     sink->send(session, name, msg);
 }
 
+void SenderImpl::sendBatch(const std::vector<qpid::messaging::Message>& messages, size_t& next)
+{
+    sys::Mutex::ScopedLock l(lock);
+    while (next < messages.size()) {
+        waitForCapacity(l);
+        //from this point the message will be recorded if there is
+        //any failure (and replayed) so need not be sent again
+        sendImpl(messages[next++], l);
+    }
+}
+
+void SenderImpl::sendUnreliableBatch(const std::vector<qpid::messaging::Message>& messages)
+{
+    sys::Mutex::ScopedLock l(lock);
+    for (std::vector<qpid::messaging::Message>::const_iterator i = messages.begin(); i != messages.end(); ++i) {
+        sendUnreliable(*i, l);
+    }
+}
+
 void SenderImpl::replay(const sys::Mutex::ScopedLock& l)
 {
     checkPendingSends(false, l);
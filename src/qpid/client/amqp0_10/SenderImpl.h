@@ -49,6 +49,7 @@ class SenderImpl : public qpid::messaging::SenderImpl
     SenderImpl(SessionImpl& parent, const std::string& name, 
                const qpid::messaging::Address& address, bool autoReconnect);
     void send(const qpid::messaging::Message&, bool sync);
+    void send(const std::vector<qpid::messaging::Message>&, bool sync);
     void close();
     void setCapacity(uint32_t);
     uint32_t getCapacity();
@@ -83,10 +84,15 @@ class SenderImpl : public qpid::messaging::SenderImpl
     uint32_t checkPendingSends(bool flush, const sys::Mutex::ScopedLock&);
     void replay(const sys::Mutex::ScopedLock&); 
     void waitForCapacity();
+    void waitForCapacity(const sys::Mutex::ScopedLock&);
 
     //logic for application visible methods:
     void sendImpl(const qpid::messaging::Message&);
+    void sendImpl(const qpid::messaging::Message&, const sys::Mutex::ScopedLock&);
     void sendUnreliable(const qpid::messaging::Message&);
+    void sendUnreliable(const qpid::messaging::Message&, const sys::Mutex::ScopedLock&);
+    void sendBatch(const std::vector<qpid::messaging::Message>&, size_t& next);
+    void sendUnreliableBatch(const std::vector<qpid::messaging::Message>&);
     void closeImpl();
 
 
@@ -130,6 +136,25 @@ class SenderImpl : public qpid::messaging::SenderImpl
         }
     };
 
+    struct SendBatch : Command
+    {
+        const std::vector<qpid::messaging::Message>& messages;
+        size_t next;
+
+        SendBatch(SenderImpl& i, const std::vector<qpid::messaging::Message>& m) : Command(i), messages(m), next(0) {}
+        //messages before next have been recorded for replay, so
+        //a repeated call continues from there
+        void operator()() { impl.sendBatch(messages, next); }
+    };
+
+    struct UnreliableSendBatch : Command
+    {
+        const std::vector<qpid::messaging::Message>& messages;
+
+        UnreliableSendBatch(SenderImpl& i, const std::vector<qpid::messaging::Message>& m) : Command(i), messages(m) {}
+        void operator()() { impl.sendUnreliableBatch(messages); }
+    };
+
     struct Close : Command
     {
         Close(SenderImpl& i) : Command(i) {}
@@ -25,7 +25,9 @@
 #include "qpid/Exception.h"
 #include "qpid/framing/reply_exceptions.h"
 #include "qpid/Msg.h"
+#include <algorithm>
 #include <assert.h>
+#include <string.h>
 
 // The locking rationale in the FieldTable seems a little odd, but it
 // maintains the concurrent guarantees and requirements that were in
@@ -47,6 +49,68 @@ using sys::ScopedLock;
 
 namespace framing {
 
+namespace {
+typedef FieldTable::ValueMap::value_type Entry;
+
+struct NameLess
+{
+    bool operator()(const Entry& a, const std::string& b) const { return a.first < b; }
+    bool operator()(const Entry& a, const Entry& b) const { return a.first < b.first; }
+};
+
+// True unless a and b are in strictly ascending order
+bool outOfOrder(const Entry& a, const Entry& b) { return !(a.first < b.first); }
+
+template <class Iterator, class Values>
+Iterator findEntry(Values& values, const std::string& name)
+{
+    Iterator i = std::lower_bound(values.begin(), values.end(), name, NameLess());
+    return (i != values.end() && i->first == name) ? i : values.end();
+}
+
+// Field tables are normally encoded in name order, from a std::map or
+// from another FieldTable. If not, sort them and, as the later of any
+// duplicate names has always taken precedence, drop the earlier ones.
+void sortEntries(FieldTable::ValueMap& values)
+{
+    if (std::adjacent_find(values.begin(), values.end(), &outOfOrder) == values.end()) return;
+    std::stable_sort(values.begin(), values.end(), NameLess());
+    FieldTable::ValueMap::iterator last = values.begin();
+    for (FieldTable::ValueMap::iterator i = values.begin() + 1; i != values.end(); ++i) {
+        if (i->first == last->first) last->second = i->second;
+        else if (++last != i) *last = *i;
+    }
+    values.erase(last + 1, values.end());
+}
+
+// Move past an encoded field value without decoding it.
+void skipValue(Buffer& buffer)
+{
+    uint8_t type = buffer.getOctet();
+    uint32_t size;
+    switch (type >> 4) {
+      case 0: size = 1; break;
+      case 1: size = 2; break;
+      case 2: size = 4; break;
+      case 3: size = 8; break;
+      case 4: size = 16; break;
+      case 5: size = 32; break;
+      case 6: size = 64; break;
+      case 7: size = 128; break;
+      case 8: size = buffer.getOctet(); break;
+      case 9: size = buffer.getShort(); break;
+      case 0xA: size = buffer.getLong(); break;
+      case 0xC: size = 5; break;
+      case 0xD: size = 9; break;
+      case 0xF: size = 0; break;
+      default:
+        throw IllegalArgumentException(QPID_MSG("Unknown field table value type: " << (int)type));
+    }
+    buffer.checkAvailable(size);
+    buffer.setPosition(buffer.getPosition() + size);
+}
+}
+
 FieldTable::FieldTable() :
     cachedSize(0),
     newBytes(false)
@@ -118,6 +182,12 @@ uint32_t FieldTable::encodedSize() const {
 }
 
 int FieldTable::count() const {
+    realDecode();
+    return values.size();
+}
+
+size_t FieldTable::size() const {
+    realDecode();
     return values.size();
 }
 
@@ -142,76 +212,115 @@ std::ostream& operator<<(std::ostream& out, const FieldTable& t) {
 
 void FieldTable::set(const std::string& name, const ValuePtr& value){
     realDecode();
-    values[name] = value;
+    setValue(name, value);
     flushRawCache();
 }
 
 void FieldTable::setString(const std::string& name, const std::string& value){
     realDecode();
-    values[name] = ValuePtr(new Str16Value(value));
+    setValue(name, ValuePtr(new Str16Value(value)));
     flushRawCache();
 }
 
 void FieldTable::setInt(const std::string& name, const int value){
     realDecode();
-    values[name] = ValuePtr(new IntegerValue(value));
+    setValue(name, ValuePtr(new IntegerValue(value)));
     flushRawCache();
 }
 
 void FieldTable::setInt64(const std::string& name, const int64_t value){
     realDecode();
-    values[name] = ValuePtr(new Integer64Value(value));
+    setValue(name, ValuePtr(new Integer64Value(value)));
     flushRawCache();
 }
 
 void FieldTable::setTimestamp(const std::string& name, const uint64_t value){
     realDecode();
-    values[name] = ValuePtr(new TimeValue(value));
+    setValue(name, ValuePtr(new TimeValue(value)));
     flushRawCache();
 }
 
 void FieldTable::setUInt64(const std::string& name, const uint64_t value){
     realDecode();
-    values[name] = ValuePtr(new Unsigned64Value(value));
+    setValue(name, ValuePtr(new Unsigned64Value(value)));
     flushRawCache();
 }
 
 void FieldTable::setTable(const std::string& name, const FieldTable& value)
 {
     realDecode();
-    values[name] = ValuePtr(new FieldTableValue(value));
+    setValue(name, ValuePtr(new FieldTableValue(value)));
     flushRawCache();
 }
 void FieldTable::setArray(const std::string& name, const Array& value)
 {
     realDecode();
-    values[name] = ValuePtr(new ArrayValue(value));
+    setValue(name, ValuePtr(new ArrayValue(value)));
     flushRawCache();
 }
 
 void FieldTable::setFloat(const std::string& name, const float value){
     realDecode();
-    values[name] = ValuePtr(new FloatValue(value));
+    setValue(name, ValuePtr(new FloatValue(value)));
     flushRawCache();
 }
 
 void FieldTable::setDouble(const std::string& name, const double value){
     realDecode();
-    values[name] = ValuePtr(new DoubleValue(value));
+    setValue(name, ValuePtr(new DoubleValue(value)));
     flushRawCache();
 }
 
+void FieldTable::setValue(const std::string& name, const ValuePtr& value)
+{
+    ValueMap::iterator i = std::lower_bound(values.begin(), values.end(), name, NameLess());
+    if (i != values.end() && i->first == name) i->second = value;
+    else values.insert(i, ValueMap::value_type(name, value));
+}
+
 FieldTable::ValuePtr FieldTable::get(const std::string& name) const
 {
-    // Ensure we have any values we're trying to read
-    realDecode();
+    {
+        // Most tables only ever have one or two values read, so rather
+        // than decode them all just find the one we want in the raw bytes
+        ScopedLock<Mutex> l(lock);
+        if (newBytes) return getRawValue(name);
+    }
     ValuePtr value;
-    ValueMap::const_iterator i = values.find(name);
+    ValueMap::const_iterator i = findEntry<ValueMap::const_iterator>(values, name);
     if ( i!=values.end() )
         value = i->second;
     return value;
 }
 
+// Called with the lock held
+FieldTable::ValuePtr FieldTable::getRawValue(const std::string& name) const
+{
+    ValuePtr value;
+    Buffer buffer((char*)&cachedBytes[0], cachedSize);
+    uint32_t len = buffer.getLong();
+    if (len) {
+        uint32_t available = buffer.available();
+        uint32_t count = buffer.getLong();
+        uint32_t leftover = available - len;
+        while(buffer.available() > leftover && count--){
+            uint8_t size = buffer.getOctet();
+            buffer.checkAvailable(size);
+            bool match = size == name.size() &&
+                ::memcmp(buffer.getPointer() + buffer.getPosition(), name.data(), size) == 0;
+            buffer.setPosition(buffer.getPosition() + size);
+            if (match) {
+                // Keep looking, as with a full decode a later duplicate wins
+                value.reset(new FieldValue);
+                value->decode(buffer);
+            } else {
+                skipValue(buffer);
+            }
+        }
+    }
+    return value;
+}
+
 namespace {
     template <class T> T default_value() { return T(); }
     template <> int default_value<int>() { return 0; }
@@ -325,14 +434,14 @@ void FieldTable::realDecode() const
         uint32_t available = buffer.available();
         uint32_t count = buffer.getLong();
         uint32_t leftover = available - len;
+        // each entry takes at least two bytes, so don't trust a larger count
+        values.reserve(std::min(count, len / 2));
         while(buffer.available() > leftover && count--){
-            std::string name;
-            ValuePtr value(new FieldValue);
-
-            buffer.getShortString(name);
-            value->decode(buffer);
-            values[name] = ValuePtr(value);
+            values.push_back(ValueMap::value_type(std::string(), ValuePtr(new FieldValue)));
+            buffer.getShortString(values.back().first);
+            values.back().second->decode(buffer);
         }
+        sortEntries(values);
     }
     newBytes = false;
 }
@@ -351,9 +460,8 @@ bool FieldTable::operator==(const FieldTable& x) const {
     realDecode();
     x.realDecode();
     if (values.size() != x.values.size()) return false;
-    for (ValueMap::const_iterator i =  values.begin(); i != values.end(); ++i) {
-        ValueMap::const_iterator j = x.values.find(i->first);
-        if (j == x.values.end()) return false;
+    for (ValueMap::const_iterator i = values.begin(), j = x.values.begin(); i != values.end(); ++i, ++j) {
+        if (i->first != j->first) return false;
         if (*(i->second) != *(j->second)) return false;
     }
     return true;
@@ -362,8 +470,9 @@ bool FieldTable::operator==(const FieldTable& x) const {
 void FieldTable::erase(const std::string& name) 
 {
     realDecode();
-    if (values.find(name) != values.end()) {
-        values.erase(name);
+    ValueMap::iterator i = findEntry<ValueMap::iterator>(values, name);
+    if (i != values.end()) {
+        values.erase(i);
         flushRawCache();
     }
 }
@@ -391,7 +500,7 @@ FieldTable::ValueMap::const_iterator FieldTable::end() const
 FieldTable::ValueMap::const_iterator FieldTable::find(const std::string& s) const
 {
     realDecode();
-    return values.find(s);
+    return findEntry<ValueMap::const_iterator>(values, s);
 }
 
 FieldTable::ValueMap::iterator FieldTable::begin()
@@ -412,21 +521,21 @@ FieldTable::ValueMap::iterator FieldTable::find(const std::string& s)
 {
     realDecode();
     flushRawCache();
-    return values.find(s);
+    return findEntry<ValueMap::iterator>(values, s);
 }
 
 std::pair<FieldTable::ValueMap::iterator, bool> FieldTable::insert(const ValueMap::value_type& value)
 {
     realDecode();
     flushRawCache();
-    return values.insert(value);
+    ValueMap::iterator i = std::lower_bound(values.begin(), values.end(), value.first, NameLess());
+    if (i != values.end() && i->first == value.first) return std::make_pair(i, false);
+    return std::make_pair(values.insert(i, value), true);
 }
 
-FieldTable::ValueMap::iterator FieldTable::insert(ValueMap::iterator position, const ValueMap::value_type& value)
+FieldTable::ValueMap::iterator FieldTable::insert(ValueMap::iterator /*position*/, const ValueMap::value_type& value)
 {
-    realDecode();
-    flushRawCache();
-    return values.insert(position, value);
+    return insert(value).first;
 }
 
 }
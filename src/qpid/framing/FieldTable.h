@@ -29,7 +29,8 @@
 #include <boost/shared_array.hpp>
 
 #include <iosfwd>
-#include <map>
+#include <string>
+#include <vector>
 
 #include "qpid/CommonImportExport.h"
 
@@ -48,13 +49,17 @@ class Buffer;
  * A set of name-value pairs. (See the AMQP spec for more details on
  * AMQP field tables).
  *
+ * The values are held in a vector sorted by name. A decoded table keeps
+ * its raw bytes and single values are looked up directly in those until
+ * the table is iterated or modified, when it is fully decoded.
+ *
  * \ingroup clientapi
  */
 class FieldTable
 {
   public:
     typedef boost::shared_ptr<FieldValue> ValuePtr;
-    typedef std::map<std::string, ValuePtr> ValueMap;
+    typedef std::vector<std::pair<std::string, ValuePtr> > ValueMap;
     typedef ValueMap::iterator iterator;
     typedef ValueMap::const_iterator const_iterator;
     typedef ValueMap::const_reference const_reference;
@@ -70,7 +75,7 @@ class FieldTable
     QPID_COMMON_EXTERN void decode(Buffer& buffer);
 
     QPID_COMMON_EXTERN int count() const;
-    QPID_COMMON_INLINE_EXTERN size_t size() const { return values.size(); }
+    QPID_COMMON_EXTERN size_t size() const;
     QPID_COMMON_INLINE_EXTERN bool empty() { return size() == 0; }
     QPID_COMMON_EXTERN void set(const std::string& name, const ValuePtr& value);
     QPID_COMMON_EXTERN ValuePtr get(const std::string& name) const;
@@ -119,6 +124,8 @@ class FieldTable
   private:
     void realDecode() const;
     void flushRawCache();
+    void setValue(const std::string& name, const ValuePtr& value);
+    ValuePtr getRawValue(const std::string& name) const;
 
     mutable qpid::sys::Mutex lock;
     mutable ValueMap values;
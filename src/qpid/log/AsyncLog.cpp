@@ -0,0 +1,305 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/log/AsyncLog.h"
+#include "qpid/sys/Time.h"
+#include <boost/bind.hpp>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace qpid {
+namespace log {
+
+namespace {
+// Incremented in the child of each fork: a writer thread started before
+// the fork does not exist in the child.
+int processGeneration = 0;
+
+#ifndef _WIN32
+void childAfterFork() { ++processGeneration; }
+
+struct ForkHandler {
+    ForkHandler() { ::pthread_atfork(0, 0, &childAfterFork); }
+} forkHandler;
+#endif
+
+sys::AtomicValue<uint32_t> nextId(1);
+
+QPID_TSS bool isWriterThread = false;
+
+uint32_t roundUp(uint32_t n)
+{
+    uint32_t capacity = 1;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+}
+
+/**
+ * Ring of records written by one logging thread and read by the writer.
+ */
+class AsyncLog::Ring
+{
+  public:
+    Ring(uint32_t capacity) : slots(capacity), mask(capacity - 1), inUse(1) {}
+
+    /** Claims a ring given up by a thread that has exited */
+    bool claim() { return inUse.boolCompareAndSwap(0, 1); }
+    void release() { --inUse; }
+
+    bool push(const Statement& s, const std::string& message)
+    {
+        uint32_t t = tail.get();
+        if (t - head.get() > mask) return false;
+        LogRecord& r = slots[t & mask];
+        r.statement = &s;
+        r.message = message;
+        ++tail;                 // Publish the record to the writer.
+        return true;
+    }
+
+    bool pop(Batch& batch)
+    {
+        uint32_t h = head.get();
+        uint32_t t = tail.get();
+        for (uint32_t i = h; i != t; ++i) {
+            LogRecord& r = slots[i & mask];
+            batch.push_back(LogRecord());
+            batch.back().statement = r.statement;
+            batch.back().message.swap(r.message);
+        }
+        head += t - h;          // Return the slots to the logging thread.
+        return t != h;
+    }
+
+    bool empty() const { return head.get() == tail.get(); }
+
+  private:
+    std::vector<LogRecord> slots;
+    const uint32_t mask;
+    sys::AtomicValue<uint32_t> head;
+    char padding[64];           // Keep head and tail on separate cache lines.
+    sys::AtomicValue<uint32_t> tail;
+    sys::AtomicValue<uint32_t> inUse;
+};
+
+#ifndef _WIN32
+namespace {
+// Holds a function releasing the ring of each logging thread, called
+// when the thread exits or moves on to another AsyncLog.
+pthread_key_t ringKey;
+pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT;
+
+void releaseRing(void* p)
+{
+    boost::function0<void>* release = static_cast<boost::function0<void>*>(p);
+    (*release)();
+    delete release;
+}
+
+void createRingKey() { ::pthread_key_create(&ringKey, &releaseRing); }
+}
+#endif
+
+AsyncLog::AsyncLog(const Writer& w, uint32_t c, bool d) :
+    writer(w), capacity(roundUp(c ? c : 1)), drop(d), id(nextId++),
+    generation(-1), closed(0), users(0), stopping(false), passes(0), reported(0)
+{}
+
+AsyncLog::~AsyncLog()
+{
+    close();
+}
+
+/**
+ * Counts a thread in push() for close() to wait on.
+ */
+class AsyncLog::ScopedUser
+{
+  public:
+    ScopedUser(AsyncLog& l) : log(l) { ++log.users; }
+    ~ScopedUser() { log.leave(); }
+  private:
+    AsyncLog& log;
+};
+
+void AsyncLog::close()
+{
+    if (!closed.boolCompareAndSwap(0, 1)) return;
+    {
+        sys::Monitor::ScopedLock l(monitor);
+        // A push waiting for room still needs the writer to run.
+        while (users.get()) monitor.wait();
+        stopping = true;
+        monitor.notifyAll();
+    }
+    if (generation.get() == processGeneration) thread.join();
+    // Write anything pushed while the writer was stopping.
+    Batch batch;
+    if (drain(batch) || dropped.get() != reported) write(batch);
+}
+
+void AsyncLog::leave()
+{
+    if (--users == 0 && closed.get()) {
+        sys::Monitor::ScopedLock l(monitor);
+        monitor.notifyAll();
+    }
+}
+
+AsyncLog::Ring& AsyncLog::threadRing()
+{
+    static QPID_TSS uint32_t owner = 0;
+    static QPID_TSS Ring* ring = 0;
+    if (owner != id) {
+        boost::shared_ptr<Ring> claimed;
+        {
+            sys::Mutex::ScopedLock l(ringsLock);
+            for (std::vector<boost::shared_ptr<Ring> >::iterator i = rings.begin(); i != rings.end(); ++i) {
+                if ((*i)->claim()) {
+                    claimed = *i;
+                    break;
+                }
+            }
+            if (!claimed) {
+                claimed.reset(new Ring(capacity));
+                rings.push_back(claimed);
+            }
+        }
+#ifndef _WIN32
+        ::pthread_once(&ringKeyOnce, &createRingKey);
+        if (void* previous = ::pthread_getspecific(ringKey)) releaseRing(previous);
+        ::pthread_setspecific(ringKey, new boost::function0<void>(boost::bind(&Ring::release, claimed)));
+#endif
+        ring = claimed.get();
+        owner = id;
+    }
+    return *ring;
+}
+
+bool AsyncLog::push(const Statement& s, const std::string& message)
+{
+    // Counted before closed is checked, so close() either sees this
+    // thread as a user or this thread sees the log closed.
+    ScopedUser user(*this);
+    if (closed.get()) return false;
+    if (generation.get() != processGeneration) start();
+    Ring& ring = threadRing();
+    while (!ring.push(s, message)) {
+        // The writer thread cannot wait for itself to make room.
+        if (drop || isWriterThread) {
+            ++dropped;
+            return true;
+        }
+        sys::Monitor::ScopedLock l(monitor);
+        monitor.notifyAll();
+        monitor.wait(sys::AbsTime(sys::now(), 10*sys::TIME_MSEC));
+    }
+    if (waiting.get()) wake();
+    return true;
+}
+
+void AsyncLog::flush()
+{
+    sys::Monitor::ScopedLock l(monitor);
+    // Nothing has been pushed in this process if the writer is not running.
+    if (generation.get() != processGeneration || isWriterThread) return;
+    // Wait for the writer to complete a pass that started after this call.
+    uint64_t target = passes + 2;
+    while (passes < target && !stopping) {
+        monitor.notifyAll();
+        monitor.wait();
+    }
+}
+
+uint64_t AsyncLog::getDropped() const
+{
+    return dropped.get();
+}
+
+void AsyncLog::start()
+{
+    sys::Monitor::ScopedLock l(monitor);
+    int current = generation.get();
+    if (current == processGeneration || stopping) return;
+    generation.boolCompareAndSwap(current, processGeneration);
+    thread = sys::Thread(*this);
+}
+
+void AsyncLog::wake()
+{
+    sys::Monitor::ScopedLock l(monitor);
+    monitor.notifyAll();
+}
+
+bool AsyncLog::drain(Batch& batch)
+{
+    sys::Mutex::ScopedLock l(ringsLock);
+    bool drained = false;
+    for (std::vector<boost::shared_ptr<Ring> >::iterator i = rings.begin(); i != rings.end(); ++i) {
+        if ((*i)->pop(batch)) drained = true;
+    }
+    return drained;
+}
+
+bool AsyncLog::pending()
+{
+    sys::Mutex::ScopedLock l(ringsLock);
+    for (std::vector<boost::shared_ptr<Ring> >::iterator i = rings.begin(); i != rings.end(); ++i) {
+        if (!(*i)->empty()) return true;
+    }
+    return false;
+}
+
+void AsyncLog::write(Batch& batch)
+{
+    uint64_t total = dropped.get();
+    writer(batch, total - reported);
+    reported = total;
+    batch.clear();
+}
+
+void AsyncLog::run()
+{
+    isWriterThread = true;
+    Batch batch;
+    while (true) {
+        // Keep draining while there is work: the busier the logging
+        // threads the larger the batches.
+        bool drained = drain(batch);
+        if (drained || dropped.get() != reported) write(batch);
+
+        sys::Monitor::ScopedLock l(monitor);
+        ++passes;
+        monitor.notifyAll();
+        if (!drained) {
+            if (stopping) break;
+            // Logging threads wake the writer only while it is waiting,
+            // so check again for records pushed before waiting was set.
+            ++waiting;
+            if (!pending()) monitor.wait(sys::AbsTime(sys::now(), sys::TIME_SEC));
+            --waiting;
+        }
+    }
+}
+
+}} // namespace qpid::log
@@ -0,0 +1,136 @@
+#ifndef QPID_LOG_ASYNCLOG_H
+#define QPID_LOG_ASYNCLOG_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/CommonImportExport.h"
+#include "qpid/sys/AtomicValue.h"
+#include "qpid/sys/IntegerTypes.h"
+#include "qpid/sys/Monitor.h"
+#include "qpid/sys/Runnable.h"
+#include "qpid/sys/Thread.h"
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace qpid {
+namespace log {
+
+struct Statement;
+
+/** A formatted log message waiting to be output */
+struct LogRecord {
+    const Statement* statement;
+    std::string message;
+};
+
+/**
+ * Hands formatted log records from logging threads to a dedicated
+ * writer thread.
+ *
+ * Each logging thread pushes records onto its own single producer,
+ * single consumer ring without taking any lock. The writer thread
+ * drains all the rings and passes the records to the Writer in
+ * batches. When a thread's ring is full the record is either dropped
+ * and counted, or the thread waits for the writer to make room.
+ *
+ * The writer thread is started by the first push in a process, so a
+ * process that forks after creating an AsyncLog gets a writer of its own.
+ * The ring of a thread that exits is handed on to the next new thread
+ * to log, so rings are only created up to the number of threads
+ * logging at once.
+ */
+class AsyncLog : private sys::Runnable, private boost::noncopyable
+{
+  public:
+    typedef std::vector<LogRecord> Batch;
+    /** Called on the writer thread with each batch and the number of
+     * records dropped since the previous call.
+     */
+    typedef boost::function2<void, const Batch&, uint64_t> Writer;
+
+    /**
+     *@param capacity records held per logging thread, rounded up to a power of 2.
+     *@param drop if true drop records when a ring is full, otherwise wait.
+     */
+    QPID_COMMON_EXTERN AsyncLog(const Writer&, uint32_t capacity, bool drop);
+    /** Closes the log if that has not already been done */
+    QPID_COMMON_EXTERN ~AsyncLog();
+
+    /**
+     * Queues a record for the writer thread.
+     *@return false if the log has been closed, in which case the record
+     * has not been taken.
+     */
+    QPID_COMMON_EXTERN bool push(const Statement&, const std::string& message);
+
+    /**
+     * Refuses further records, waits for pushes already in progress to
+     * finish, then writes any outstanding records and stops the writer
+     * thread.
+     */
+    QPID_COMMON_EXTERN void close();
+
+    /** Wait until all records pushed before the call have been written */
+    QPID_COMMON_EXTERN void flush();
+
+    /** Total number of records dropped because a ring was full */
+    QPID_COMMON_EXTERN uint64_t getDropped() const;
+
+  private:
+    class Ring;
+    class ScopedUser;
+
+    const Writer writer;
+    const uint32_t capacity;
+    const bool drop;
+    const uint32_t id;
+
+    sys::Mutex ringsLock;
+    std::vector<boost::shared_ptr<Ring> > rings;
+
+    sys::Monitor monitor;
+    sys::Thread thread;
+    sys::AtomicValue<int> generation; // of the process the writer was started in
+    sys::AtomicValue<uint32_t> closed;
+    sys::AtomicValue<uint32_t> users; // threads in push()
+    bool stopping;
+    uint64_t passes;
+    sys::AtomicValue<uint32_t> waiting;
+    sys::AtomicValue<uint64_t> dropped;
+    uint64_t reported;
+
+    Ring& threadRing();
+    void start();
+    void wake();
+    void leave();
+    bool drain(Batch&);
+    bool pending();
+    void write(Batch&);
+    void run();
+};
+
+}} // namespace qpid::log
+
+#endif  /*!QPID_LOG_ASYNCLOG_H*/
@@ -17,7 +17,9 @@
  */
 
 #include "qpid/log/Logger.h"
+#include "qpid/log/AsyncLog.h"
 #include "qpid/log/Options.h"
+#include "qpid/Msg.h"
 #include "qpid/log/SinkOptions.h"
 #include "qpid/memory.h"
 #include "qpid/sys/Thread.h"
@@ -47,6 +49,9 @@ inline void Logger::enable_unlocked(Statement* s) {
 namespace {
 sys::PODMutex loggerLock = QPID_MUTEX_INITIALIZER;
 std::auto_ptr<Logger> logger;
+
+// Origin of the messages reporting dropped asynchronous log messages.
+Statement droppedStatement = { true, __FILE__, __LINE__, 0, warning, system };
 }
 
 Logger& Logger::instance() {
@@ -83,6 +88,17 @@ Logger::Output::~Output() {}
 
 void Logger::log(const Statement& s, const std::string& msg) {
     // Format the message outside the lock.
+    std::string formatted = formatMessage(s, msg);
+    boost::shared_ptr<AsyncLog> a(boost::atomic_load(&async));
+    // A closed asynchronous log is being replaced; write directly.
+    if (!a || !a->push(s, formatted)) {
+        ScopedLock l(lock);
+        std::for_each(outputs.begin(), outputs.end(),
+                      boost::bind(&Output::log, _1, s, formatted));
+    }
+}
+
+std::string Logger::formatMessage(const Statement& s, const std::string& msg) {
     std::ostringstream os;
     if (!prefix.empty())
         os << prefix << ": ";
@@ -107,20 +123,46 @@ void Logger::log(const Statement& s, const std::string& msg) {
     if (flags & (FILE|LINE|FUNCTION))
         os << " ";
     os << msg << endl;
-    std::string formatted=os.str();
-    {
-        ScopedLock l(lock);
+    return os.str();
+}
+
+void Logger::write(const AsyncLog::Batch& batch, uint64_t dropped) {
+    std::string report;
+    if (dropped) {
+        report = formatMessage(droppedStatement, QPID_MSG("Asynchronous log full, dropped "
+                                                          << dropped << " messages"));
+    }
+    ScopedLock l(lock);
+    for (AsyncLog::Batch::const_iterator i = batch.begin(); i != batch.end(); ++i) {
         std::for_each(outputs.begin(), outputs.end(),
-                      boost::bind(&Output::log, _1, s, formatted));
+                      boost::bind(&Output::log, _1, boost::cref(*i->statement), boost::cref(i->message)));
+    }
+    if (dropped) {
+        std::for_each(outputs.begin(), outputs.end(),
+                      boost::bind(&Output::log, _1, boost::cref(droppedStatement), boost::cref(report)));
     }
 }
 
+void Logger::flush() {
+    boost::shared_ptr<AsyncLog> a(boost::atomic_load(&async));
+    if (a) a->flush();
+}
+
+uint64_t Logger::getDropped() {
+    boost::shared_ptr<AsyncLog> a(boost::atomic_load(&async));
+    return a ? a->getDropped() : 0;
+}
+
 void Logger::output(std::auto_ptr<Output> out) {
     ScopedLock l(lock);
     outputs.push_back(out.release());
 }
 
 void Logger::clear() {
+    boost::shared_ptr<AsyncLog> a(boost::atomic_exchange(&async, boost::shared_ptr<AsyncLog>()));
+    // Wait for threads logging to it to finish, then write outstanding messages
+    if (a) a->close();
+    a.reset();
     select(Selector());         // locked
     format(0);                  // locked
     ScopedLock l(lock);
@@ -165,6 +207,11 @@ void Logger::configure(const Options& opts) {
     options = opts;
     setPrefix(opts.prefix);
     options.sinkOptions->setup(this);
+    if (opts.async) {
+        boost::atomic_store(&async, boost::shared_ptr<AsyncLog>(
+                                new AsyncLog(boost::bind(&Logger::write, this, _1, _2),
+                                             opts.asyncBufferSize, opts.asyncDrop)));
+    }
 }
 
 void Logger::reconfigure(const std::vector<std::string>& selectors) {
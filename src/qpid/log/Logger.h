@@ -17,12 +17,16 @@
 #include "qpid/sys/Mutex.h"
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <set>
 #include "qpid/CommonImportExport.h"
 
 namespace qpid {
 namespace log {
 
+class AsyncLog;
+struct LogRecord;
+
 /**
  * Central logging agent.
  *
@@ -32,6 +36,9 @@ namespace log {
  * formatting logging output. The actual outputting of log records
  * is handled by Logger::Output-derived classes instantiated by the
  * platform's sink-related options.
+ *
+ * When configured for asynchronous logging, messages are formatted by
+ * the logging thread and output by a writer thread (see AsyncLog).
  */
 class QPID_COMMON_CLASS_EXTERN Logger : private boost::noncopyable {
   public:
@@ -101,12 +108,20 @@ class QPID_COMMON_CLASS_EXTERN Logger : private boost::noncopyable {
     /** Set the hires timestamp setting */
     QPID_COMMON_EXTERN void setHiresTimestamp(bool setting);
 
+    /** Wait until messages logged asynchronously have been output */
+    QPID_COMMON_EXTERN void flush();
+
+    /** Number of messages dropped because the asynchronous log was full */
+    QPID_COMMON_EXTERN uint64_t getDropped();
+
   private:
     typedef boost::ptr_vector<Output> Outputs;
     typedef std::set<Statement*> Statements;
 
     sys::Mutex lock;
     inline void enable_unlocked(Statement* s);
+    std::string formatMessage(const Statement&, const std::string&);
+    void write(const std::vector<LogRecord>&, uint64_t dropped);
 
     Statements statements;
     Outputs outputs;
@@ -114,6 +129,10 @@ class QPID_COMMON_CLASS_EXTERN Logger : private boost::noncopyable {
     int flags;
     std::string prefix;
     Options options;
+    // Must be destroyed before outputs, to which it writes. Accessed
+    // with boost::atomic_load and atomic_exchange, as it is replaced by
+    // clear() while other threads may be logging.
+    boost::shared_ptr<AsyncLog> async;
 };
 
 }} // namespace qpid::log
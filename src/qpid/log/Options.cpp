@@ -39,6 +39,9 @@ Options::Options(const std::string& argv0_, const std::string& name_) :
     hiresTs(false),
     category(true),
     trace(false),
+    async(false),
+    asyncBufferSize(4096),
+    asyncDrop(false),
     sinkOptions (SinkOptions::create(argv0_))
 {
     selectors.push_back("notice+");
@@ -83,6 +86,9 @@ Options::Options(const std::string& argv0_, const std::string& name_) :
         ("log-hires-timestamp", optValue(hiresTs,"yes|no"), "Use hi-resolution timestamps in log messages")
         ("log-category", optValue(category,"yes|no"), "Include category in log messages")
         ("log-prefix", optValue(prefix,"STRING"), "Prefix to prepend to all log messages")
+        ("log-async", optValue(async,"yes|no"), "Output log messages from a dedicated thread rather than the thread logging them")
+        ("log-async-buffer", optValue(asyncBufferSize,"N"), "Maximum number of messages each thread may have waiting for asynchronous output")
+        ("log-async-drop", optValue(asyncDrop,"yes|no"), "Drop messages when a thread's asynchronous log buffer is full, rather than waiting for space")
         ;
     add(*sinkOptions);
 }
@@ -102,6 +108,9 @@ Options::Options(const Options &o) :
     category(o.category),
     trace(o.trace),
     prefix(o.prefix),
+    async(o.async),
+    asyncBufferSize(o.asyncBufferSize),
+    asyncDrop(o.asyncDrop),
     sinkOptions (SinkOptions::create(o.argv0))
 {
     *sinkOptions = *o.sinkOptions;
@@ -122,6 +131,9 @@ Options& Options::operator=(const Options& x) {
         category = x.category;
         trace = x.trace;
         prefix = x.prefix;
+        async = x.async;
+        asyncBufferSize = x.asyncBufferSize;
+        asyncDrop = x.asyncDrop;
         *sinkOptions = *x.sinkOptions;
     }
     return *this;
@@ -21,6 +21,7 @@
 #include "qpid/Options.h"
 #include "qpid/CommonImportExport.h"
 #include "qpid/log/SinkOptions.h"
+#include "qpid/sys/IntegerTypes.h"
 #include <iosfwd>
 #include <memory>
 
@@ -43,6 +44,9 @@ struct Options : public qpid::Options {
     bool time, level, thread, source, function, hiresTs, category;
     bool trace;
     std::string prefix;
+    bool async;
+    uint32_t asyncBufferSize;
+    bool asyncDrop;
     std::auto_ptr<SinkOptions> sinkOptions;
 };
 
@@ -119,6 +119,26 @@ struct Statement {
     };
 };
 
+/**
+ * Statements with a level below QPID_LOG_MIN_LEVEL are compiled out
+ * entirely: they are never registered with the Logger and cannot be
+ * enabled at runtime. The default of 0 (trace) keeps every statement.
+ * Set it for a whole build with the QPID_LOG_MIN_LEVEL cmake option.
+ */
+#ifndef QPID_LOG_MIN_LEVEL
+#define QPID_LOG_MIN_LEVEL 0
+#endif
+
+///@internal true if statements of LEVEL are compiled in.
+#define QPID_LOG_COMPILED(LEVEL) (int(::qpid::log::LEVEL) >= QPID_LOG_MIN_LEVEL)
+
+///@internal hint that a disabled statement is the common case.
+#if defined(__GNUC__)
+#define QPID_LOG_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define QPID_LOG_UNLIKELY(x) (x)
+#endif
+
 ///@internal static initializer for a Statement.
 #define QPID_LOG_STATEMENT_INIT_CAT(LEVEL, CATEGORY) \
 { 0, __FILE__, __LINE__,  BOOST_CURRENT_FUNCTION, (::qpid::log::LEVEL), \
@@ -133,7 +153,7 @@ QPID_LOG_STATEMENT_INIT_CAT ( LEVEL , unspecified )
  * Like QPID_LOG but computes an additional boolean test expression
  * to determine if the message should be logged. Evaluation of both
  * the test and  message expressions occurs only if the requested log level
- * is enabled.
+ * is enabled, so no arguments are formatted for a disabled statement.
  *@param LEVEL severity Level for message, should be one of:
  * debug, info, notice, warning, error, critical. NB no qpid::log:: prefix.
  *@param TEST message is logged only if expression TEST evaluates to true.
@@ -143,10 +163,12 @@ QPID_LOG_STATEMENT_INIT_CAT ( LEVEL , unspecified )
 #define QPID_LOG_IF(LEVEL, TEST, MESSAGE)                       \
     do {                                                        \
         using ::qpid::log::Statement;                           \
-        static Statement stmt_= QPID_LOG_STATEMENT_INIT(LEVEL); \
-        static Statement::Initializer init_(stmt_);             \
-        if (stmt_.enabled && (TEST))                            \
-            stmt_.log(::qpid::Msg() << MESSAGE);                \
+        if (QPID_LOG_COMPILED(LEVEL)) {                         \
+            static Statement stmt_= QPID_LOG_STATEMENT_INIT(LEVEL); \
+            static Statement::Initializer init_(stmt_);         \
+            if (QPID_LOG_UNLIKELY(stmt_.enabled) && (TEST))     \
+                stmt_.log(::qpid::Msg() << MESSAGE);            \
+        }                                                       \
     } while(0)
 
 /**
@@ -156,10 +178,12 @@ QPID_LOG_STATEMENT_INIT_CAT ( LEVEL , unspecified )
 #define QPID_LOG_IF_CAT(LEVEL, CATEGORY, TEST, MESSAGE)         \
     do {                                                        \
         using ::qpid::log::Statement;                           \
-        static Statement stmt_= QPID_LOG_STATEMENT_INIT_CAT(LEVEL, CATEGORY); \
-        static Statement::Initializer init_(stmt_);             \
-        if (stmt_.enabled && (TEST))                            \
-            stmt_.log(::qpid::Msg() << MESSAGE);                \
+        if (QPID_LOG_COMPILED(LEVEL)) {                         \
+            static Statement stmt_= QPID_LOG_STATEMENT_INIT_CAT(LEVEL, CATEGORY); \
+            static Statement::Initializer init_(stmt_);         \
+            if (QPID_LOG_UNLIKELY(stmt_.enabled) && (TEST))     \
+                stmt_.log(::qpid::Msg() << MESSAGE);            \
+        }                                                       \
     } while(0)
 
 /**
@@ -175,9 +199,12 @@ QPID_LOG_STATEMENT_INIT_CAT ( LEVEL , unspecified )
 #define QPID_LOG_TEST(LEVEL, FLAG)                              \
     do {                                                        \
         using ::qpid::log::Statement;                           \
-        static Statement stmt_= QPID_LOG_STATEMENT_INIT(LEVEL); \
-        static Statement::Initializer init_(stmt_);             \
-        FLAG = stmt_.enabled;                                   \
+        FLAG = false;                                           \
+        if (QPID_LOG_COMPILED(LEVEL)) {                         \
+            static Statement stmt_= QPID_LOG_STATEMENT_INIT(LEVEL); \
+            static Statement::Initializer init_(stmt_);         \
+            FLAG = stmt_.enabled;                               \
+        }                                                       \
     } while(0)
 
     /**
@@ -193,9 +220,12 @@ QPID_LOG_STATEMENT_INIT_CAT ( LEVEL , unspecified )
     #define QPID_LOG_TEST_CAT(LEVEL, CATEGORY, FLAG)                \
     do {                                                        \
         using ::qpid::log::Statement;                           \
-        static Statement stmt_= QPID_LOG_STATEMENT_INIT_CAT(LEVEL, CATEGORY); \
-        static Statement::Initializer init_(stmt_);             \
-        FLAG = stmt_.enabled;                                   \
+        FLAG = false;                                           \
+        if (QPID_LOG_COMPILED(LEVEL)) {                         \
+            static Statement stmt_= QPID_LOG_STATEMENT_INIT_CAT(LEVEL, CATEGORY); \
+            static Statement::Initializer init_(stmt_);         \
+            FLAG = stmt_.enabled;                               \
+        }                                                       \
     } while(0)
 
 /**
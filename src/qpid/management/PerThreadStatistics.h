@@ -0,0 +1,166 @@
+#ifndef _PerThreadStatistics_
+#define _PerThreadStatistics_
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <cstddef>
+#include <new>
+
+// Support for the per-thread statistics blocks of generated management
+// classes. The counters are updated on the hot path by worker threads, so
+// these helpers avoid both locking and false sharing between threads.
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define QPID_MGMT_ATOMIC_BUILTINS 1
+#endif
+
+namespace qpid {
+namespace management {
+
+/**
+ * Statistics blocks are padded and aligned to this size so that blocks
+ * owned by different threads never share a cache line.
+ */
+const std::size_t STATISTICS_CACHE_LINE_SIZE = 64;
+
+/**
+ * Counter held in a per-thread statistics block.
+ *
+ * Updates and reads are relaxed atomic operations: they are race free
+ * (a block may be shared when there are more threads than slots, and
+ * is always read concurrently by the aggregating thread) but impose no
+ * ordering, which is all a statistic needs. Where the compiler has no
+ * atomic builtins updates fall back to plain volatile accesses.
+ */
+template <class T>
+class StatisticsCounter
+{
+  public:
+    StatisticsCounter(T v = 0) { store(v); }
+    StatisticsCounter(const StatisticsCounter& c) { store(c.load()); }
+
+    StatisticsCounter& operator=(const StatisticsCounter& c) { store(c.load()); return *this; }
+    StatisticsCounter& operator=(T v) { store(v); return *this; }
+    StatisticsCounter& operator+=(T n) { add(n); return *this; }
+    StatisticsCounter& operator-=(T n) { sub(n); return *this; }
+    StatisticsCounter& operator++() { add(1); return *this; }
+    StatisticsCounter& operator--() { sub(1); return *this; }
+    T operator++(int) { T old(load()); add(1); return old; }
+    T operator--(int) { T old(load()); sub(1); return old; }
+
+    operator T() const { return load(); }
+    T get() const { return load(); }
+
+  private:
+#ifdef QPID_MGMT_ATOMIC_BUILTINS
+    T value;
+
+    T load() const { return __atomic_load_n(&value, __ATOMIC_RELAXED); }
+    void store(T v) { __atomic_store_n(&value, v, __ATOMIC_RELAXED); }
+    void add(T n) { __atomic_fetch_add(&value, n, __ATOMIC_RELAXED); }
+    void sub(T n) { __atomic_fetch_sub(&value, n, __ATOMIC_RELAXED); }
+#else
+    volatile T value;
+
+    T load() const { return value; }
+    void store(T v) { value = v; }
+    void add(T n) { value = T(value + n); }
+    void sub(T n) { value = T(value - n); }
+#endif
+};
+
+/**
+ * Fixed size array of lazily allocated, cache line aligned per-thread
+ * statistics blocks of type S, indexed by ManagementObject::getThreadIndex().
+ *
+ * get() may be called from any thread without locking. allocate() must be
+ * serialised by the owner (generated classes hold their accessLock).
+ */
+template <class S>
+class PerThreadStatsArray
+{
+  public:
+    PerThreadStatsArray(int n) : count(n), blocks(new S*[n]), storage(new char*[n])
+    {
+        for (int i = 0; i < count; ++i) {
+            blocks[i] = 0;
+            storage[i] = 0;
+        }
+    }
+
+    ~PerThreadStatsArray()
+    {
+        for (int i = 0; i < count; ++i) {
+            if (blocks[i]) {
+                blocks[i]->~S();
+                delete[] storage[i];
+            }
+        }
+        delete[] blocks;
+        delete[] storage;
+    }
+
+    int size() const { return count; }
+
+    S* get(int idx) const
+    {
+#ifdef QPID_MGMT_ATOMIC_BUILTINS
+        return __atomic_load_n(&blocks[idx], __ATOMIC_ACQUIRE);
+#else
+        return static_cast<S* volatile*>(blocks)[idx];
+#endif
+    }
+
+    /** Return the block at idx, creating it if necessary. */
+    S* allocate(int idx)
+    {
+        S* block = blocks[idx];
+        if (block) return block;
+
+        // Round up to whole cache lines, with room to align the start.
+        const std::size_t line = STATISTICS_CACHE_LINE_SIZE;
+        const std::size_t padded = ((sizeof(S) + line - 1) / line) * line;
+        char* raw = new char[padded + line];
+        std::size_t offset = line - (reinterpret_cast<std::size_t>(raw) % line);
+        if (offset == line) offset = 0;
+        block = new (raw + offset) S();
+        storage[idx] = raw;
+#ifdef QPID_MGMT_ATOMIC_BUILTINS
+        __atomic_store_n(&blocks[idx], block, __ATOMIC_RELEASE);
+#else
+        static_cast<S* volatile*>(blocks)[idx] = block;
+#endif
+        return block;
+    }
+
+  private:
+    const int count;
+    S** blocks;
+    char** storage;
+
+    PerThreadStatsArray(const PerThreadStatsArray&);
+    PerThreadStatsArray& operator=(const PerThreadStatsArray&);
+};
+
+}}
+
+#endif  /*!_PerThreadStatistics_*/
@@ -88,6 +88,7 @@ void Message::setContentBytes(const std::string& c) {
     impl->setBytes(c);
 }
 std::string Message::getContentBytes() const {return impl->getBytes(); }
+void Message::swapContent(std::string& c) { impl->swapBytes(c); }
 
 qpid::types::Variant& Message::getContentObject() { return impl->getContent(); }
 void Message::setContentObject(const qpid::types::Variant& c) { impl->getContent() = c; }
@@ -95,12 +96,18 @@ const qpid::types::Variant& Message::getContentObject() const { return impl->get
 
 const char* Message::getContentPtr() const
 {
-    return impl->getBytes().data();
+    const char* data;
+    size_t size;
+    if (impl->getEncodedBytes(data, size)) return data;
+    else return impl->getBytes().data();
 }
 
 size_t Message::getContentSize() const
 {
-    return impl->getBytes().size();
+    const char* data;
+    size_t size;
+    if (impl->getEncodedBytes(data, size)) return size;
+    else return impl->getBytes().size();
 }
 
 EncodingException::EncodingException(const std::string& msg) : qpid::types::Exception(msg) {}
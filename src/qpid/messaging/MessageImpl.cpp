@@ -190,6 +190,29 @@ void MessageImpl::setBytes(const char* chars, size_t count)
     bytes.assign(chars, count);
     updated();
 }
+void MessageImpl::swapBytes(std::string& c)
+{
+    updated();
+    //content decoded as a string is held in the variant; hand that back
+    if (bytes.empty() && content.getType() == VAR_STRING) bytes.swap(content.getString());
+    content.reset();
+    bytes.swap(c);
+}
+/**
+ * Points to the content as it lies in the received message, provided
+ * it has not yet been decoded and is just bytes or text.
+ */
+bool MessageImpl::getEncodedBytes(const char*& data, size_t& size) const
+{
+    if (encoded && !contentDecoded && encoded->isRawBody()) {
+        qpid::amqp::CharSequence body = encoded->getBody();
+        data = body.data;
+        size = body.size;
+        return true;
+    } else {
+        return false;
+    }
+}
 const std::string& MessageImpl::getBytes() const
 {
     if (encoded && !contentDecoded) {
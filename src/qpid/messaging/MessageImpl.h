@@ -93,6 +93,8 @@ class MessageImpl
 
     void setBytes(const std::string& bytes);
     void setBytes(const char* chars, size_t count);
+    void swapBytes(std::string& bytes);
+    bool getEncodedBytes(const char*& data, size_t& size) const;
     QPID_MESSAGING_EXTERN const std::string& getBytes() const;
     std::string& getBytes();
     qpid::types::Variant& getContent();
@@ -50,6 +50,10 @@ bool Receiver::fetch(Message& message, Duration timeout)
     return impl->fetch(message, timeout);
 }
 Message Receiver::fetch(Duration timeout) { return impl->fetch(timeout); }
+size_t Receiver::fetch(std::vector<Message>& messages, size_t max, Duration timeout)
+{
+    return impl->fetch(messages, max, timeout);
+}
 void Receiver::setCapacity(uint32_t c) { impl->setCapacity(c); }
 uint32_t Receiver::getCapacity() { return impl->getCapacity(); }
 uint32_t Receiver::getAvailable() { return impl->getAvailable(); }
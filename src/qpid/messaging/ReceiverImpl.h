@@ -23,6 +23,7 @@
  */
 #include "qpid/RefCounted.h"
 #include "qpid/sys/IntegerTypes.h"
+#include <vector>
 
 namespace qpid {
 namespace messaging {
@@ -41,6 +42,7 @@ class ReceiverImpl : public virtual qpid::RefCounted
     virtual Message get(Duration timeout) = 0;
     virtual bool fetch(Message& message, Duration timeout) = 0;
     virtual Message fetch(Duration timeout) = 0;
+    virtual size_t fetch(std::vector<Message>& messages, size_t max, Duration timeout) = 0;
     virtual void setCapacity(uint32_t) = 0;
     virtual uint32_t getCapacity() = 0;
     virtual uint32_t getAvailable() = 0;
@@ -38,6 +38,7 @@ Sender::Sender(const Sender& s) : qpid::messaging::Handle<SenderImpl>() { PI::co
 Sender::~Sender() { PI::dtor(*this); }
 Sender& Sender::operator=(const Sender& s) { return PI::assign(*this, s); }
 void Sender::send(const Message& message, bool sync) { impl->send(message, sync); }
+void Sender::send(const std::vector<Message>& messages, bool sync) { impl->send(messages, sync); }
 void Sender::close() { impl->close(); }
 void Sender::setCapacity(uint32_t c) { impl->setCapacity(c); }
 uint32_t Sender::getCapacity() { return impl->getCapacity(); }
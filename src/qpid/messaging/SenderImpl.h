@@ -23,6 +23,7 @@
  */
 #include "qpid/RefCounted.h"
 #include "qpid/sys/IntegerTypes.h"
+#include <vector>
 
 namespace qpid {
 namespace messaging {
@@ -36,6 +37,7 @@ class SenderImpl : public virtual qpid::RefCounted
   public:
     virtual ~SenderImpl() {}
     virtual void send(const Message& message, bool sync) = 0;
+    virtual void send(const std::vector<Message>& messages, bool sync) = 0;
     virtual void close() = 0;
     virtual void setCapacity(uint32_t) = 0;
     virtual uint32_t getCapacity() = 0;
@@ -76,6 +76,8 @@ const std::string VALUE("value");
 const std::string SUBJECT_FILTER("subject-filter");
 const std::string SOURCE("sender-source");
 const std::string TARGET("receiver-target");
+const std::string ADAPTIVE_CAPACITY("adaptive-capacity");
+const std::string CAPACITY_BYTES("capacity-bytes");
 
 //reliability options:
 const std::string UNRELIABLE("unreliable");
@@ -248,7 +250,9 @@ AddressHelper::AddressHelper(const Address& address) :
     durableNode(false),
     durableLink(false),
     timeout(0),
-    browse(false)
+    browse(false),
+    adaptiveCapacity(false),
+    capacityBytes(0)
 {
     verifier.verify(address);
     getAddressOption(address, CREATE, createPolicy);
@@ -263,6 +267,8 @@ AddressHelper::AddressHelper(const Address& address) :
     durableNode = test(node, DURABLE);
     durableLink = test(link, DURABLE);
     timeout = get(link, TIMEOUT, durableLink && reliability != AT_LEAST_ONCE ? DEFAULT_DURABLE_TIMEOUT : DEFAULT_TIMEOUT);
+    adaptiveCapacity = test(link, ADAPTIVE_CAPACITY);
+    capacityBytes = get(link, CAPACITY_BYTES, capacityBytes);
     std::string mode;
     if (getAddressOption(address, MODE, mode)) {
         if (mode == BROWSE) {
@@ -575,6 +581,16 @@ bool AddressHelper::isUnreliable() const
         (reliability.empty() && browse); // A browser defaults to unreliable.
 }
 
+bool AddressHelper::isAdaptiveCapacity() const
+{
+    return adaptiveCapacity;
+}
+
+uint64_t AddressHelper::getCapacityBytes() const
+{
+    return capacityBytes;
+}
+
 const qpid::types::Variant::Map& AddressHelper::getNodeProperties() const
 {
     return node;
@@ -766,6 +782,8 @@ Verifier::Verifier()
     link[X_BINDINGS] = true;
     link[SELECTOR] = true;
     link[FILTER] = true;
+    link[ADAPTIVE_CAPACITY] = true;
+    link[CAPACITY_BYTES] = true;
     defined[LINK] = link;
 }
 void Verifier::verify(const Address& address) const
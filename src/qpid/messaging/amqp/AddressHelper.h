@@ -42,6 +42,8 @@ class AddressHelper
 
     bool isNameNull() const;
     bool isUnreliable() const;
+    bool isAdaptiveCapacity() const;
+    uint64_t getCapacityBytes() const;
     const qpid::types::Variant::Map& getNodeProperties() const;
     bool getLinkSource(std::string& out) const;
     bool getLinkTarget(std::string& out) const;
@@ -76,6 +78,8 @@ class AddressHelper
     bool durableLink;
     uint32_t timeout;
     bool browse;
+    bool adaptiveCapacity;
+    uint64_t capacityBytes;
     std::vector<Filter> filters;
 
     bool enabled(const std::string& policy, CheckMode mode) const;
@@ -266,7 +266,7 @@ bool ConnectionContext::fetch(boost::shared_ptr<SessionContext> ssn, boost::shar
                 wait(ssn, lnk);
             }
             if (lnk->capacity && pn_link_queued(lnk->receiver) == 0) {
-                pn_link_flow(lnk->receiver, lnk->capacity);
+                pn_link_flow(lnk->receiver, lnk->getCredit());
             }
         }
         if (get(ssn, lnk, message, qpid::messaging::Duration::IMMEDIATE)) {
@@ -294,32 +294,12 @@ bool ConnectionContext::get(boost::shared_ptr<SessionContext> ssn, boost::shared
     while (true) {
         sys::Monitor::ScopedLock l(lock);
         checkClosed(ssn, lnk);
-        pn_delivery_t* current = pn_link_current((pn_link_t*) lnk->receiver);
-        QPID_LOG(debug, "In ConnectionContext::get(), current=" << current);
-        if (current && !pn_delivery_partial(current)) {
-            qpid::messaging::MessageImpl& impl = MessageImplAccess::get(message);
-            boost::shared_ptr<EncodedMessage> encoded(new EncodedMessage(pn_delivery_pending(current)));
-            encoded->setNestAnnotationsOption(nestAnnotations);
-            ssize_t read = pn_link_recv(lnk->receiver, encoded->getData(), encoded->getSize());
-            if (read < 0) throw qpid::messaging::MessagingException("Failed to read message");
-            encoded->trim((size_t) read);
-            QPID_LOG(debug, "Received message of " << encoded->getSize() << " bytes: ");
-            encoded->init(impl);
-            impl.setEncoded(encoded);
-            impl.setInternalId(ssn->record(current));
-            if (lnk->capacity) {
-                pn_link_flow(lnk->receiver, 1);
-                if (lnk->wakeupToIssueCredit()) {
-                    wakeupDriver();
-                } else {
-                    haveOutput = true;
-                }
-            }
-            // Automatically ack messages if we are in a transaction.
-            if (ssn->transaction)
-                acknowledgeLH(ssn, &message, false, l);
+        bool wakeup = false;
+        if (receiveLH(ssn, lnk, message, wakeup, l)) {
+            if (wakeup) wakeupDriver();
             return true;
         } else if (until > qpid::sys::now()) {
+            lnk->starved();
             waitUntil(ssn, lnk, until);
         } else {
             return false;
@@ -328,6 +308,109 @@ bool ConnectionContext::get(boost::shared_ptr<SessionContext> ssn, boost::shared
     return false;
 }
 
+/**
+ * Take the current delivery on the link, if it is complete, without
+ * waiting. Sets wakeup if the driver needs to be woken to issue the
+ * replacement credit, so that callers receiving a batch of messages
+ * need only wake it once.
+ */
+bool ConnectionContext::receiveLH(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, qpid::messaging::Message& message, bool& wakeup, sys::Monitor::ScopedLock& l)
+{
+    pn_delivery_t* current = pn_link_current((pn_link_t*) lnk->receiver);
+    QPID_LOG(debug, "In ConnectionContext::receiveLH(), current=" << current);
+    if (!current || pn_delivery_partial(current)) return false;
+
+    qpid::messaging::MessageImpl& impl = MessageImplAccess::get(message);
+    boost::shared_ptr<EncodedMessage> encoded(new EncodedMessage(pn_delivery_pending(current)));
+    encoded->setNestAnnotationsOption(nestAnnotations);
+    ssize_t read = pn_link_recv(lnk->receiver, encoded->getData(), encoded->getSize());
+    if (read < 0) throw qpid::messaging::MessagingException("Failed to read message");
+    encoded->trim((size_t) read);
+    QPID_LOG(debug, "Received message of " << encoded->getSize() << " bytes: ");
+    encoded->init(impl);
+    impl.setEncoded(encoded);
+    impl.setInternalId(ssn->record(current));
+    if (lnk->capacity && lnk->isAdaptive()) {
+        uint32_t credit = lnk->getReplacementCredit(encoded->getSize());
+        if (credit) {
+            pn_link_flow(lnk->receiver, credit);
+            wakeup = true;
+        }
+    } else if (lnk->capacity) {
+        pn_link_flow(lnk->receiver, 1);
+        if (lnk->wakeupToIssueCredit()) {
+            wakeup = true;
+        } else {
+            haveOutput = true;
+        }
+    }
+    // Automatically ack messages if we are in a transaction.
+    if (ssn->transaction)
+        acknowledgeLH(ssn, &message, false, l);
+    return true;
+}
+
+bool ConnectionContext::receiveLH(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, std::vector<qpid::messaging::Message>& messages, bool& wakeup, sys::Monitor::ScopedLock& l)
+{
+    messages.push_back(qpid::messaging::Message());
+    try {
+        if (receiveLH(ssn, lnk, messages.back(), wakeup, l)) return true;
+    } catch (...) {
+        messages.pop_back();
+        throw;
+    }
+    messages.pop_back();
+    return false;
+}
+
+size_t ConnectionContext::fetch(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout)
+{
+    if (max == 0) return 0;
+    qpid::sys::AtomicCount::ScopedIncrement track(lnk->fetching);
+    qpid::sys::AbsTime until(convert(timeout));
+    size_t count = 0;
+    bool wakeup = false;
+    sys::Monitor::ScopedLock l(lock);
+    checkClosed(ssn, lnk);
+    if (!lnk->capacity) {
+        // Issue credit for the whole batch at once
+        pn_link_flow(lnk->receiver, max);
+        wakeup = true;
+    }
+    while (count < max) {
+        if (receiveLH(ssn, lnk, messages, wakeup, l)) {
+            ++count;
+        } else {
+            // Only wait for the first message of the batch
+            if (count || !(until > qpid::sys::now())) break;
+            if (wakeup) {
+                wakeupDriver();
+                wakeup = false;
+            }
+            lnk->starved();
+            waitUntil(ssn, lnk, until);
+            checkClosed(ssn, lnk);
+        }
+    }
+    if (count == 0 || (!lnk->capacity && count < max)) {
+        // As for fetch(), check there are no messages on their way and
+        // reclaim any unused credit
+        pn_link_drain(lnk->receiver, 0);
+        wakeupDriver();
+        wakeup = false;
+        while (pn_link_draining(lnk->receiver) && !pn_link_queued(lnk->receiver)) {
+            QPID_LOG(debug, "Waiting for message or for credit to be drained: credit=" << pn_link_credit(lnk->receiver) << ", queued=" << pn_link_queued(lnk->receiver));
+            wait(ssn, lnk);
+        }
+        if (lnk->capacity && pn_link_queued(lnk->receiver) == 0) {
+            pn_link_flow(lnk->receiver, lnk->getCredit());
+        }
+        while (count < max && receiveLH(ssn, lnk, messages, wakeup, l)) ++count;
+    }
+    if (wakeup) wakeupDriver();
+    return count;
+}
+
 boost::shared_ptr<ReceiverContext> ConnectionContext::nextReceiver(boost::shared_ptr<SessionContext> ssn, qpid::messaging::Duration timeout)
 {
     qpid::sys::AbsTime until(convert(timeout));
@@ -427,7 +510,7 @@ void ConnectionContext::attach(boost::shared_ptr<SessionContext> ssn, boost::sha
 void ConnectionContext::attach(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk)
 {
     lnk->configure();
-    attach(ssn, lnk->receiver, lnk->capacity);
+    attach(ssn, lnk->receiver, lnk->getCredit());
     checkClosed(ssn, lnk);
     lnk->verify();
     QPID_LOG(debug, "Attach succeeded from " << lnk->getSource());
@@ -547,19 +630,48 @@ void ConnectionContext::send(
     bool sync,
     SenderContext::Delivery** delivery)
 {
+    boost::shared_ptr<const EncodedMessage> encoded = snd->encode(message);
     sys::Monitor::ScopedLock l(lock);
-    sendLH(ssn, snd, message, sync, delivery, l);
+    sendEncodedLH(ssn, snd, encoded, sync, delivery, l);
 }
 
-void ConnectionContext::sendLH(
+void ConnectionContext::send(
     boost::shared_ptr<SessionContext> ssn,
     boost::shared_ptr<SenderContext> snd,
-    const qpid::messaging::Message& message,
-    bool sync,
-    SenderContext::Delivery** delivery,
-    sys::Monitor::ScopedLock&)
+    const std::vector<qpid::messaging::Message>& messages,
+    bool sync)
 {
+    std::vector<boost::shared_ptr<const EncodedMessage> > encoded;
+    encoded.reserve(messages.size());
+    for (std::vector<qpid::messaging::Message>::const_iterator i = messages.begin(); i != messages.end(); ++i) {
+        encoded.push_back(snd->encode(*i));
+    }
+    sys::Monitor::ScopedLock l(lock);
     checkClosed(ssn);
+    for (std::vector<boost::shared_ptr<const EncodedMessage> >::const_iterator i = encoded.begin(); i != encoded.end(); ++i) {
+        waitForOutputLH(ssn, snd, l);
+        SenderContext::Delivery* delivery = 0;
+        while (!snd->send(*i, &delivery)) {
+            QPID_LOG(debug, "Waiting for capacity...");
+            if (pn_transport_pending(engine)) wakeupDriver();
+            wait(ssn, snd);//wait for capacity
+        }
+    }
+    // Write the whole batch out in one go
+    wakeupDriver();
+    if (sync) {
+        while (!snd->settled()) {
+            QPID_LOG(debug, "Waiting for confirmation...");
+            wait(ssn, snd);//wait until messages have been confirmed
+        }
+    }
+}
+
+void ConnectionContext::waitForOutputLH(
+    boost::shared_ptr<SessionContext> ssn,
+    boost::shared_ptr<SenderContext> snd,
+    sys::Monitor::ScopedLock&)
+{
     while (pn_transport_pending(engine) > 65536) {
         QPID_LOG(debug, "Have " << pn_transport_pending(engine) << " bytes of output pending; waiting for this to be written...");
         notifyOnWrite = true;
@@ -567,6 +679,29 @@ void ConnectionContext::sendLH(
         wait(ssn, snd);
         notifyOnWrite = false;
     }
+}
+
+void ConnectionContext::sendLH(
+    boost::shared_ptr<SessionContext> ssn,
+    boost::shared_ptr<SenderContext> snd,
+    const qpid::messaging::Message& message,
+    bool sync,
+    SenderContext::Delivery** delivery,
+    sys::Monitor::ScopedLock& l)
+{
+    sendEncodedLH(ssn, snd, snd->encode(message), sync, delivery, l);
+}
+
+void ConnectionContext::sendEncodedLH(
+    boost::shared_ptr<SessionContext> ssn,
+    boost::shared_ptr<SenderContext> snd,
+    boost::shared_ptr<const EncodedMessage> message,
+    bool sync,
+    SenderContext::Delivery** delivery,
+    sys::Monitor::ScopedLock& l)
+{
+    checkClosed(ssn);
+    waitForOutputLH(ssn, snd, l);
     while (!snd->send(message, delivery)) {
         QPID_LOG(debug, "Waiting for capacity...");
         if (pn_transport_pending(engine)) wakeupDriver();
@@ -601,7 +736,7 @@ void ConnectionContext::setCapacity(boost::shared_ptr<ReceiverContext> receiver,
 {
     sys::Monitor::ScopedLock l(lock);
     receiver->setCapacity(capacity);
-    pn_link_flow((pn_link_t*) receiver->receiver, receiver->getCapacity());
+    pn_link_flow((pn_link_t*) receiver->receiver, receiver->getCredit());
     wakeupDriver();
 }
 uint32_t ConnectionContext::getCapacity(boost::shared_ptr<ReceiverContext> receiver)
@@ -799,7 +934,7 @@ void ConnectionContext::restartSession(boost::shared_ptr<SessionContext> s)
     for (SessionContext::ReceiverMap::iterator i = s->receivers.begin(); i != s->receivers.end(); ++i) {
         QPID_LOG(debug, id << " reattaching receiver " << i->first);
         if (i->second->capacity) {
-            attach(s, i->second->receiver, i->second->capacity);
+            attach(s, i->second->receiver, i->second->getCredit());
         } else {
             attach(s, i->second->receiver, (uint32_t) i->second->fetching);
         }
@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 #include <boost/intrusive_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include "qpid/Url.h"
@@ -90,8 +91,11 @@ class ConnectionContext : public qpid::sys::ConnectionCodec, public qpid::messag
     void send(boost::shared_ptr<SessionContext>, boost::shared_ptr<SenderContext> ctxt,
               const qpid::messaging::Message& message, bool sync,
               SenderContext::Delivery** delivery);
+    void send(boost::shared_ptr<SessionContext>, boost::shared_ptr<SenderContext> ctxt,
+              const std::vector<qpid::messaging::Message>& messages, bool sync);
 
     bool fetch(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, qpid::messaging::Message& message, qpid::messaging::Duration timeout);
+    size_t fetch(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, std::vector<qpid::messaging::Message>& messages, size_t max, qpid::messaging::Duration timeout);
     bool get(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, qpid::messaging::Message& message, qpid::messaging::Duration timeout);
 
     // Session operations
@@ -225,7 +229,13 @@ class ConnectionContext : public qpid::sys::ConnectionCodec, public qpid::messag
     void sendLH(boost::shared_ptr<SessionContext>, boost::shared_ptr<SenderContext> ctxt,
                 const qpid::messaging::Message& message, bool sync,
                 SenderContext::Delivery** delivery, sys::Monitor::ScopedLock&);
+    void sendEncodedLH(boost::shared_ptr<SessionContext>, boost::shared_ptr<SenderContext> ctxt,
+                       boost::shared_ptr<const EncodedMessage> message, bool sync,
+                       SenderContext::Delivery** delivery, sys::Monitor::ScopedLock&);
     void acknowledgeLH(boost::shared_ptr<SessionContext> ssn, qpid::messaging::Message* message, bool cumulative, sys::Monitor::ScopedLock&);
+    bool receiveLH(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, qpid::messaging::Message& message, bool& wakeup, sys::Monitor::ScopedLock&);
+    bool receiveLH(boost::shared_ptr<SessionContext> ssn, boost::shared_ptr<ReceiverContext> lnk, std::vector<qpid::messaging::Message>& messages, bool& wakeup, sys::Monitor::ScopedLock&);
+    void waitForOutputLH(boost::shared_ptr<SessionContext>, boost::shared_ptr<SenderContext>, sys::Monitor::ScopedLock&);
 
     types::Variant::List getPeersOfferedCapabilities();
     bool usePassthrough();
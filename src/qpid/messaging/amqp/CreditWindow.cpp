@@ -0,0 +1,121 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/messaging/amqp/CreditWindow.h"
+#include <algorithm>
+
+namespace qpid {
+namespace messaging {
+namespace amqp {
+namespace {
+const uint32_t INITIAL_WINDOW(16);
+const double HEADROOM(2.0);//window covers this many round trips at the consumption rate
+}
+
+CreditWindow::CreditWindow() :
+    capacity(0), bytes(0), window(0), used(0), averageSize(0), rate(0), roundTrip(0),
+    starving(false), timing(false), sampling(false) {}
+
+void CreditWindow::setLimits(uint32_t messages, uint64_t b)
+{
+    capacity = messages;
+    bytes = b;
+    window = std::min(capacity, INITIAL_WINDOW);
+    used = 0;
+    starving = false;
+    timing = false;
+    sampling = false;
+}
+
+uint32_t CreditWindow::getWindow() const
+{
+    return window;
+}
+
+void CreditWindow::starved()
+{
+    starving = true;
+}
+
+uint32_t CreditWindow::taken(size_t size, uint32_t credit, uint32_t queued, sys::AbsTime now)
+{
+    averageSize = averageSize ? (averageSize * 7 + size) / 8 : size;
+    if (sampling) {
+        //a low sample is taken as is, a high one (e.g. the sender was
+        //idle) only moves the estimate a little
+        int64_t sample = std::max<int64_t>(sys::Duration(issuedAt, now), 1);
+        roundTrip = (!roundTrip || sample < roundTrip) ? sample : roundTrip + (sample - roundTrip) / 8;
+        sampling = false;
+    }
+    if (++used < std::max(window / 2, 1u)) return 0;
+
+    if (timing) {
+        int64_t elapsed = sys::Duration(reviewStart, now);
+        if (elapsed > 0) {
+            double sample = double(used) * sys::TIME_SEC / elapsed;
+            rate = rate ? (rate * 3 + sample) / 4 : sample;
+        }
+    }
+    reviewStart = now;
+    timing = true;
+    used = 0;
+    review(queued);
+
+    uint32_t outstanding = credit + queued;
+    if (window <= outstanding) return 0;
+    if (outstanding == 0) {
+        issuedAt = now;
+        sampling = true;
+    }
+    return window - outstanding;
+}
+
+void CreditWindow::review(uint32_t queued)
+{
+    uint64_t limit = capacity;
+    if (bytes && averageSize) limit = std::min<uint64_t>(limit, std::max<uint64_t>(bytes / averageSize, 1));
+    uint64_t target = 0;
+    if (rate && roundTrip) {
+        double t = HEADROOM * rate * roundTrip / sys::TIME_SEC + 0.5;
+        target = t < limit ? uint64_t(t) : limit;
+    }
+    uint64_t next = window;
+    if (starving) {
+        next = std::max<uint64_t>(next * 2, target);
+    } else if (target) {
+        next = target;
+    } else if (queued > window / 2) {
+        next = window - window / 4;
+    }
+    window = std::min(std::max<uint64_t>(next, 1), limit);
+    starving = false;
+}
+
+double CreditWindow::getRate() const
+{
+    return rate;
+}
+
+sys::Duration CreditWindow::getRoundTrip() const
+{
+    return sys::Duration(roundTrip);
+}
+
+}}} // namespace qpid::messaging::amqp
@@ -0,0 +1,91 @@
+#ifndef QPID_MESSAGING_AMQP_CREDITWINDOW_H
+#define QPID_MESSAGING_AMQP_CREDITWINDOW_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/messaging/ImportExport.h"
+#include "qpid/sys/IntegerTypes.h"
+#include "qpid/sys/Time.h"
+#include <stddef.h>
+
+namespace qpid {
+namespace messaging {
+namespace amqp {
+
+/**
+ * Sizes the credit window of a receiver with adaptive capacity.
+ *
+ * The window is reviewed once every half window of messages taken by
+ * the application, so that credit goes out in batches. It is sized to
+ * cover the round-trip time at the observed consumption rate, with
+ * some headroom, and is never more than the capacity, nor more than
+ * the byte budget given the average message size.
+ *
+ * The consumption rate is measured over each review interval. The
+ * round-trip time is sampled whenever credit is issued with none left
+ * outstanding, as the time until the next message is taken. Until
+ * both are known the window doubles when the application has had to
+ * wait for a message and shrinks by a quarter when more than half of
+ * it is left queued.
+ */
+class CreditWindow
+{
+  public:
+    QPID_MESSAGING_EXTERN CreditWindow();
+    /**
+     * Sets the largest window, in messages and, if bytes is non-zero,
+     * in bytes; the window starts again from its initial size.
+     */
+    QPID_MESSAGING_EXTERN void setLimits(uint32_t messages, uint64_t bytes);
+    QPID_MESSAGING_EXTERN uint32_t getWindow() const;
+    /** Called when the application is about to wait for a message */
+    QPID_MESSAGING_EXTERN void starved();
+    /**
+     * Called when the application has taken a message of the given
+     * size, with credit still unused and queued messages not yet taken.
+     * @return the credit to issue, which is non-zero only once a window
+     * review finds less than the window outstanding
+     */
+    QPID_MESSAGING_EXTERN uint32_t taken(size_t size, uint32_t credit, uint32_t queued, sys::AbsTime now);
+    /** @return the consumption rate in messages per second, or 0 if not yet known */
+    QPID_MESSAGING_EXTERN double getRate() const;
+    /** @return the round-trip time, or 0 if not yet known */
+    QPID_MESSAGING_EXTERN sys::Duration getRoundTrip() const;
+  private:
+    uint32_t capacity;
+    uint64_t bytes;
+    uint32_t window;
+    uint32_t used;
+    uint64_t averageSize;
+    double rate;
+    int64_t roundTrip;
+    bool starving;
+    bool timing;
+    bool sampling;
+    sys::AbsTime reviewStart;
+    sys::AbsTime issuedAt;
+
+    void review(uint32_t queued);
+};
+}}} // namespace qpid::messaging::amqp
+
+#endif  /*!QPID_MESSAGING_AMQP_CREDITWINDOW_H*/
@@ -22,14 +22,50 @@
 #include "Transport.h"
 #include "qpid/messaging/exceptions.h"
 #include "qpid/sys/Poller.h"
+#include "qpid/sys/SystemInfo.h"
 #include "qpid/sys/Timer.h"
 #include "qpid/log/Statement.h"
+#include "qpid/Options.h"
+#include "config.h"
+#include <algorithm>
+#include <boost/bind.hpp>
 
 namespace qpid {
 namespace messaging {
 namespace amqp {
+namespace {
+struct DriverOptions : public qpid::Options
+{
+    int maxIOThreads;
+
+    DriverOptions() : qpid::Options("AMQP 1.0 IO threading options"), maxIOThreads(-1)
+    {
+        addOptions()
+            ("max-iothreads", optValue(maxIOThreads, "N"), "Maximum number of io threads to use");
+    }
+};
+
+size_t getMaxThreads()
+{
+    CommonOptions common("", "", QPIDC_CONF_FILE);
+    DriverOptions options;
+    try {
+        common.parse(0, 0, common.clientConfig, true);
+        options.parse(0, 0, common.clientConfig, true);
+    } catch (const std::exception& e) {
+        QPID_LOG(warning, "Failed to parse IO threading options, using defaults: " << e.what());
+    }
+    if (options.maxIOThreads > 0) return options.maxIOThreads;
+    else return std::max(qpid::sys::SystemInfo::concurrency(), 1L);
+}
+}
+
+DriverImpl::DriverImpl() : poller(new qpid::sys::Poller), maxThreads(getMaxThreads()), transports(0), timer(new qpid::sys::Timer)
+{
+    start();
+}
 
-DriverImpl::DriverImpl() : poller(new qpid::sys::Poller), timer(new qpid::sys::Timer)
+DriverImpl::DriverImpl(size_t m) : poller(new qpid::sys::Poller), maxThreads(std::max<size_t>(m, 1)), transports(0), timer(new qpid::sys::Timer)
 {
     start();
 }
@@ -40,8 +76,11 @@ DriverImpl::~DriverImpl()
 
 void DriverImpl::start()
 {
-    thread = qpid::sys::Thread(*poller);
-    QPID_LOG(debug, "Driver started");
+    {
+        qpid::sys::Mutex::ScopedLock l(threadLock);
+        threads.push_back(qpid::sys::Thread(*poller));
+    }
+    QPID_LOG(debug, "Driver started, using at most " << maxThreads << " IO threads");
 }
 
 void DriverImpl::stop()
@@ -49,18 +88,47 @@ void DriverImpl::stop()
     QPID_LOG(debug, "Driver stopped");
     if (!poller->hasShutdown()) {
         poller->shutdown();
-        thread.join();
+        std::vector<qpid::sys::Thread> stopped;
+        {
+            qpid::sys::Mutex::ScopedLock l(threadLock);
+            threads.swap(stopped);
+        }
+        for (std::vector<qpid::sys::Thread>::iterator i = stopped.begin(); i != stopped.end(); ++i) {
+            i->join();
+        }
         timer->stop();
     }
 }
 
 boost::shared_ptr<Transport> DriverImpl::getTransport(const std::string& protocol, TransportContext& connection)
 {
-    boost::shared_ptr<Transport> t(Transport::create(protocol, connection, poller));
-    if (!t) throw qpid::messaging::ConnectionError("No such transport: " + protocol);
+    Transport* created = Transport::create(protocol, connection, poller);
+    if (!created) throw qpid::messaging::ConnectionError("No such transport: " + protocol);
+    // The connection holds on to the driver for longer than to its
+    // transport, so the driver is still there when the latter is released
+    boost::shared_ptr<Transport> t(created, boost::bind(&DriverImpl::release, this, _1));
+    qpid::sys::Mutex::ScopedLock l(threadLock);
+    ++transports;
+    if (threads.size() < transports && threads.size() < maxThreads && !poller->hasShutdown()) {
+        threads.push_back(qpid::sys::Thread(*poller));
+        QPID_LOG(debug, "Created IO thread " << threads.size());
+    }
     return t;
 }
 
+size_t DriverImpl::getThreadCount()
+{
+    qpid::sys::Mutex::ScopedLock l(threadLock);
+    return threads.size();
+}
+
+void DriverImpl::release(Transport* t)
+{
+    delete t;
+    qpid::sys::Mutex::ScopedLock l(threadLock);
+    --transports;
+}
+
 
 qpid::sys::Mutex DriverImpl::defaultLock;
 boost::weak_ptr<DriverImpl> DriverImpl::theDefault;
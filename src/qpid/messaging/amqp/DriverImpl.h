@@ -21,10 +21,12 @@
  * under the License.
  *
  */
+#include "qpid/messaging/ImportExport.h"
 #include "qpid/sys/Mutex.h"
 #include "qpid/sys/Thread.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <vector>
 
 namespace qpid {
 namespace sys {
@@ -36,28 +38,39 @@ namespace amqp {
 class TransportContext;
 class Transport;
 /**
- *
+ * Drives the I/O for AMQP 1.0 connections. A poller thread is added
+ * for each new connection up to a configured maximum (max-iothreads
+ * in the client configuration file, by default the number of CPUs),
+ * so that connections need not all share a single I/O thread.
  */
 class DriverImpl
 {
   public:
     DriverImpl();
-    ~DriverImpl();
+    QPID_MESSAGING_EXTERN DriverImpl(size_t maxThreads);
+    QPID_MESSAGING_EXTERN ~DriverImpl();
 
     void start();
     void stop();
 
-    boost::shared_ptr<Transport> getTransport(const std::string& protocol, TransportContext& connection);
+    QPID_MESSAGING_EXTERN boost::shared_ptr<Transport> getTransport(const std::string& protocol, TransportContext& connection);
     sys::Timer& getTimer() { return *timer; }
+    /** @return the number of IO threads currently running */
+    QPID_MESSAGING_EXTERN size_t getThreadCount();
 
     static boost::shared_ptr<DriverImpl> getDefault();
   private:
     boost::shared_ptr<qpid::sys::Poller> poller;
-    qpid::sys::Thread thread;
+    qpid::sys::Mutex threadLock;
+    std::vector<qpid::sys::Thread> threads;
+    size_t maxThreads;
+    size_t transports; // Not yet released by their connections
     std::auto_ptr<sys::Timer> timer;
 
     static qpid::sys::Mutex defaultLock;
     static boost::weak_ptr<DriverImpl> theDefault;
+
+    void release(Transport*);
 };
 }}} // namespace qpid::messaging::amqp
 
@@ -266,6 +266,19 @@ void EncodedMessage::getBody(std::string& raw, qpid::types::Variant& c) const
     }
 }
 
+/**
+ * @returns true if the body is uninterpreted bytes or text, which can
+ * then be used in place through getBody()
+ */
+bool EncodedMessage::isRawBody() const
+{
+    return content.isVoid() && body.size &&
+        (bodyType.empty()
+         || bodyType == qpid::amqp::typecodes::BINARY_NAME
+         || bodyType == qpid::types::encodings::UTF8
+         || bodyType == qpid::types::encodings::ASCII);
+}
+
 qpid::amqp::CharSequence EncodedMessage::getBody() const
 {
     return body;
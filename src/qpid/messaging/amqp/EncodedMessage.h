@@ -99,6 +99,7 @@ class EncodedMessage
     QPID_MESSAGING_EXTERN void init(qpid::messaging::MessageImpl&);
     QPID_MESSAGING_EXTERN qpid::amqp::CharSequence getBareMessage() const;
     qpid::amqp::CharSequence getBody() const;
+    bool isRawBody() const;
     QPID_MESSAGING_EXTERN bool hasHeaderChanged(const qpid::messaging::MessageImpl&) const;
   private:
     size_t size;
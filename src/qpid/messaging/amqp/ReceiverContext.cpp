@@ -49,6 +49,8 @@ void ReceiverContext::setCapacity(uint32_t c)
     if (c != capacity) {
         //stop
         capacity = c;
+        window.setLimits(capacity, helper.getCapacityBytes());
+        used = 0;
         //reissue credit
     }
 }
@@ -145,6 +147,44 @@ bool ReceiverContext::wakeupToIssueCredit()
     }
 }
 
+bool ReceiverContext::isAdaptive() const
+{
+    return helper.isAdaptiveCapacity();
+}
+
+/**
+ * @returns the credit to issue when the link is attached or credit
+ * is replaced after a drain
+ */
+uint32_t ReceiverContext::getCredit() const
+{
+    return isAdaptive() ? window.getWindow() : capacity;
+}
+
+/**
+ * Called for an adaptive link once a message has been taken from it;
+ * the window is reviewed and credit replaced only every half window,
+ * so that credit goes out in batches.
+ */
+uint32_t ReceiverContext::getReplacementCredit(size_t size)
+{
+    uint32_t credit = window.taken(size, pn_link_credit(receiver), pn_link_queued(receiver), sys::AbsTime::now());
+    if (credit) {
+        QPID_LOG(trace, "Receiver " << name << " credit window " << window.getWindow() << ", issuing " << credit
+                 << ", rate " << window.getRate() << "/s, round trip " << window.getRoundTrip());
+    }
+    return credit;
+}
+
+/**
+ * Called when the application is about to wait for a message
+ * on the link
+ */
+void ReceiverContext::starved()
+{
+    window.starved();
+}
+
 void ReceiverContext::cleanup()
 {
     if (!error && receiver) {
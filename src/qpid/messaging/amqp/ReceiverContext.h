@@ -23,6 +23,7 @@
  */
 #include "qpid/messaging/Address.h"
 #include "qpid/messaging/amqp/AddressHelper.h"
+#include "qpid/messaging/amqp/CreditWindow.h"
 #include <string>
 #include "qpid/sys/AtomicCount.h"
 #include "qpid/sys/ExceptionHolder.h"
@@ -71,8 +72,13 @@ class ReceiverContext
     uint32_t capacity;
     uint32_t used;
     qpid::sys::AtomicCount fetching;
+    CreditWindow window;//used with adaptive capacity only
     void configure(pn_terminus_t*);
     bool wakeupToIssueCredit();
+    bool isAdaptive() const;
+    uint32_t getCredit() const;
+    uint32_t getReplacementCredit(size_t size);
+    void starved();
     sys::ExceptionHolder error;
 };
 }}} // namespace qpid::messaging::amqp
@@ -62,6 +62,11 @@ qpid::messaging::Message ReceiverHandle::fetch(qpid::messaging::Duration timeout
     return result;
 }
 
+size_t ReceiverHandle::fetch(std::vector<Message>& messages, size_t max, qpid::messaging::Duration timeout)
+{
+    return connection->fetch(session, receiver, messages, max, timeout);
+}
+
 void ReceiverHandle::setCapacity(uint32_t capacity)
 {
     connection->setCapacity(receiver, capacity);
@@ -104,7 +104,7 @@ const std::string& SenderContext::getTarget() const
     return address.getName();
 }
 
-bool SenderContext::send(const qpid::messaging::Message& message, SenderContext::Delivery** out)
+bool SenderContext::send(boost::shared_ptr<const EncodedMessage> message, SenderContext::Delivery** out)
 {
     error.raise();
     resend();//if there are any messages needing to be resent at the front of the queue, send them first
@@ -114,7 +114,7 @@ bool SenderContext::send(const qpid::messaging::Message& message, SenderContext:
             state = transaction->getSendState();
         if (unreliable) {
             Delivery delivery(nextId++);
-            delivery.encode(MessageImplAccess::get(message), address, options.setToOnSend);
+            delivery.setEncoded(message);
             delivery.send(sender, unreliable, state);
             *out = 0;
             return true;
@@ -122,7 +122,7 @@ bool SenderContext::send(const qpid::messaging::Message& message, SenderContext:
             deliveries.push_back(Delivery(nextId++, options.maxDeliveryAttempts, options.redeliveryTimeout));
             try {
                 Delivery& delivery = deliveries.back();
-                delivery.encode(MessageImplAccess::get(message), address, options.setToOnSend);
+                delivery.setEncoded(message);
                 delivery.send(sender, unreliable, state);
                 *out = &delivery;
                 return true;
@@ -499,7 +499,13 @@ void SenderContext::Delivery::reset()
     token = 0;
 }
 
-void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, const qpid::messaging::Address& address, bool setToField)
+void SenderContext::Delivery::setEncoded(boost::shared_ptr<const EncodedMessage> e)
+{
+    encoded = e;
+}
+
+namespace {
+void encodeMessage(const qpid::messaging::MessageImpl& msg, const qpid::messaging::Address& address, bool setToField, EncodedMessage& encoded)
 {
     try {
         boost::shared_ptr<const EncodedMessage> original = msg.getEncoded();
@@ -560,6 +566,14 @@ void SenderContext::Delivery::encode(const qpid::messaging::MessageImpl& msg, co
         throw SendError(e.what());
     }
 }
+}
+
+boost::shared_ptr<const EncodedMessage> SenderContext::encode(const qpid::messaging::Message& message) const
+{
+    boost::shared_ptr<EncodedMessage> encoded(new EncodedMessage());
+    encodeMessage(MessageImplAccess::get(message), address, options.setToOnSend, *encoded);
+    return encoded;
+}
 
 void SenderContext::Delivery::send(pn_link_t* sender, bool unreliable, const types::Variant& state)
 {
@@ -577,7 +591,7 @@ void SenderContext::Delivery::send(pn_link_t* sender, bool unreliable, const typ
         data.put(state);
         pn_delivery_update(token, qpid::amqp::transaction::TRANSACTIONAL_STATE_CODE);
     }
-    pn_link_send(sender, encoded.getData(), encoded.getSize());
+    pn_link_send(sender, encoded->getData(), encoded->getSize());
     if (unreliable) {
         settle();
     }
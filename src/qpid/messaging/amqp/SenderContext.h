@@ -69,7 +69,7 @@ class SenderContext
     {
       public:
         Delivery(int32_t id, const uint32_t max_attempts = 0, const qpid::sys::Duration& = qpid::sys::Duration(0));
-        void encode(const qpid::messaging::MessageImpl& message, const qpid::messaging::Address&, bool setToField);
+        void setEncoded(boost::shared_ptr<const EncodedMessage>);
         void send(pn_link_t*, bool unreliable, const types::Variant& state=types::Variant());
         bool delivered();
         bool accepted();
@@ -87,7 +87,7 @@ class SenderContext
       private:
         int32_t id;
         pn_delivery_t* token;
-        EncodedMessage encoded;
+        boost::shared_ptr<const EncodedMessage> encoded;
         bool settled;
         uint32_t attempts;
         const uint32_t max_attempts;
@@ -111,7 +111,13 @@ class SenderContext
     virtual uint32_t getUnsettled();
     virtual const std::string& getName() const;
     virtual const std::string& getTarget() const;
-    virtual bool send(const qpid::messaging::Message& message, Delivery**);
+    /**
+     * Encodes a message for sending on this link. Needs no lock, so
+     * that the connection lock is held only while the encoded message
+     * is handed to send().
+     */
+    boost::shared_ptr<const EncodedMessage> encode(const qpid::messaging::Message& message) const;
+    virtual bool send(boost::shared_ptr<const EncodedMessage> message, Delivery**);
     virtual void configure();
     virtual void verify();
     virtual void check();
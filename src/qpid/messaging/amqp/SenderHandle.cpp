@@ -43,6 +43,11 @@ void SenderHandle::send(const Message& message, bool sync)
     connection->send(session, sender, message, sync, &d);
 }
 
+void SenderHandle::send(const std::vector<Message>& messages, bool sync)
+{
+    connection->send(session, sender, messages, sync);
+}
+
 void SenderHandle::close()
 {
     connection->detach(session, sender);
@@ -42,6 +42,7 @@ class SenderHandle : public qpid::messaging::SenderImpl
                  boost::shared_ptr<SenderContext> sender
     );
     void send(const Message& message, bool sync);
+    void send(const std::vector<Message>& messages, bool sync);
     void close();
     void setCapacity(uint32_t);
     uint32_t getCapacity();
@@ -22,6 +22,7 @@
 #include "qpid/sys/Mutex.h"
 #include "qpid/log/Statement.h"
 
+#include <algorithm>
 #include <numeric>
 
 using boost::intrusive_ptr;
@@ -35,7 +36,9 @@ TimerTask::TimerTask(Duration timeout, const std::string&  n) :
     sortTime(AbsTime::FarFuture()),
     period(timeout),
     nextFireTime(AbsTime::now(), timeout),
-    state(WAITING)
+    state(WAITING),
+    timer(0),
+    slot(0)
 {}
 
 TimerTask::TimerTask(AbsTime time, const std::string&  n) :
@@ -43,7 +46,9 @@ TimerTask::TimerTask(AbsTime time, const std::string&  n) :
     sortTime(AbsTime::FarFuture()),
     period(0),
     nextFireTime(time),
-    state(WAITING)
+    state(WAITING),
+    timer(0),
+    slot(0)
 {}
 
 TimerTask::~TimerTask() {}
@@ -54,6 +59,13 @@ bool TimerTask::readyToFire() const {
 
 bool TimerTask::prepareToFire() {
     Monitor::ScopedLock l(stateMonitor);
+    // With several timer threads a task that added itself again from
+    // fire() can come due before that call returns; wait for it so
+    // that a task never fires on two threads at once.
+    while (state == CALLING) {
+        stateMonitor.wait();
+    }
+    timer = 0;
     if (state != CANCELLED) {
         state = CALLING;
         return true;
@@ -89,15 +101,33 @@ void TimerTask::restart() {
 }
 
 void TimerTask::cancel() {
+    // Released after the lock, as this may be the last reference
+    intrusive_ptr<TimerTask> removed;
     Monitor::ScopedLock l(stateMonitor);
     while (state == CALLING) {
         stateMonitor.wait();
     }
     state = CANCELLED;
+    if (timer) {
+        removed = timer->remove(*this);
+        timer = 0;
+    }
 }
 
 // TODO AStitcher 21/08/09 The threshholds for emitting warnings are a little arbitrary
 Timer::Timer() :
+    threads(1),
+    active(false),
+    late(50 * TIME_MSEC),
+    overran(2 * TIME_MSEC),
+    lateCancel(500 * TIME_MSEC),
+    warn(60 * TIME_SEC)
+{
+    start();
+}
+
+Timer::Timer(size_t n) :
+    threads(std::max(n, size_t(1))),
     active(false),
     late(50 * TIME_MSEC),
     overran(2 * TIME_MSEC),
@@ -110,6 +140,15 @@ Timer::Timer() :
 Timer::~Timer()
 {
     stop();
+    TimerWheel::Slot remaining;
+    {
+        Monitor::ScopedLock l(monitor);
+        tasks.clear(remaining);
+    }
+    for (TimerWheel::Slot::iterator i = remaining.begin(); i != remaining.end(); ++i) {
+        Monitor::ScopedLock l((*i)->stateMonitor);
+        if ((*i)->timer == this) (*i)->timer = 0;
+    }
 }
 
 class TimerTaskCallbackScope {
@@ -128,80 +167,91 @@ public:
     }
 };
 
+// A TimerTask's stateMonitor is never taken while holding the monitor,
+// as cancel() takes the two in the opposite order.
 void Timer::run()
 {
     Monitor::ScopedLock l(monitor);
     while (active) {
-        if (tasks.empty()) {
-            monitor.wait();
-        } else {
-            intrusive_ptr<TimerTask> t = tasks.top();
-            tasks.pop();
-            assert(!(t->nextFireTime < t->sortTime));
-
-            // warn on extreme lateness
-            AbsTime start(AbsTime::now());
-            Duration delay(t->sortTime, start);
-            {
+        AbsTime start(AbsTime::now());
+        intrusive_ptr<TimerTask> t = tasks.next(start);
+        if (!t) {
+            if (tasks.empty()) monitor.wait();
+            else monitor.wait(tasks.nextExpiry());
+            continue;
+        }
+        assert(!(t->nextFireTime < t->sortTime));
+        if (t->nextFireTime > start) {
+            // If the timer was adjusted into the future put it back
+            // You can only push events into the future
+            tasks.add(t, t->nextFireTime);
+            continue;
+        }
+
+        // warn on extreme lateness
+        Duration delay(t->sortTime, start);
+        bool fired(false);
+        {
+            Monitor::ScopedUnlock u(monitor);
             TimerTaskCallbackScope s(*t);
             if (s) {
                 if (delay > lateCancel) {
                     QPID_LOG(debug, t->name << " cancelled timer woken up " <<
                              delay / TIME_MSEC << "ms late");
                 }
-                continue;
-            } else if(Duration(t->nextFireTime, start) >= 0) {
-                {
-                    Monitor::ScopedUnlock u(monitor);
-                    fire(t);
-                }
+            } else {
+                fire(t);
+                fired = true;
+            }
+        }
+        if (fired) {
+            bool warningsEnabled;                  // TimerWarning enabled
+            QPID_LOG_TEST(debug, warningsEnabled); // TimerWarning emitted at debug level
+            if (warningsEnabled) {
                 // Warn if callback overran next timer's start.
                 AbsTime end(AbsTime::now());
                 Duration overrun (0);
                 if (!tasks.empty()) {
-                    overrun = Duration(tasks.top()->nextFireTime, end);
+                    overrun = Duration(tasks.nextExpiry(), end);
                 }
-                bool warningsEnabled;                  // TimerWarning enabled
-                QPID_LOG_TEST(debug, warningsEnabled); // TimerWarning emitted at debug level
-                if (warningsEnabled) {
-                    if (overrun > overran) {
-                        if (delay > overran) // if delay is significant to an overrun.
-                            warn.lateAndOverran(t->name, delay, overrun, Duration(start, end));
-                        else
-                            warn.overran(t->name, overrun, Duration(start, end));
-                    }
-                    else if (delay > late)
-                        warn.late(t->name, delay);
+                if (overrun > overran) {
+                    if (delay > overran) // if delay is significant to an overrun.
+                        warn.lateAndOverran(t->name, delay, overrun, Duration(start, end));
+                    else
+                        warn.overran(t->name, overrun, Duration(start, end));
                 }
-                continue;
-            } else {
-                // If the timer was adjusted into the future it might no longer
-                // be the next event, so push and then get top to make sure
-                // You can only push events into the future
-                t->sortTime = t->nextFireTime;
-                tasks.push(t);
-            }
+                else if (delay > late)
+                    warn.late(t->name, delay);
             }
-            assert(!tasks.empty());
-            monitor.wait(tasks.top()->sortTime);
         }
     }
 }
 
 void Timer::add(intrusive_ptr<TimerTask> task)
 {
+    {
+        Monitor::ScopedLock l(task->stateMonitor);
+        task->timer = this;
+    }
     Monitor::ScopedLock l(monitor);
-    task->sortTime = task->nextFireTime;
-    tasks.push(task);
+    tasks.add(task, task->nextFireTime);
     monitor.notify();
 }
 
+intrusive_ptr<TimerTask> Timer::remove(TimerTask& task)
+{
+    Monitor::ScopedLock l(monitor);
+    return tasks.remove(task);
+}
+
 void Timer::start()
 {
     Monitor::ScopedLock l(monitor);
     if (!active) {
         active = true;
-        runner = Thread(this);
+        for (size_t i = 0; i < threads; ++i) {
+            runners.push_back(Thread(this));
+        }
     }
 }
 
@@ -213,7 +263,10 @@ void Timer::stop()
         active = false;
         monitor.notifyAll();
     }
-    runner.join();
+    for (std::vector<Thread>::iterator i = runners.begin(); i != runners.end(); ++i) {
+        i->join();
+    }
+    runners.clear();
 }
 
 // Allow subclasses to override behavior when firing a task.
@@ -225,11 +278,4 @@ void Timer::fire(boost::intrusive_ptr<TimerTask> t) {
     }
 }
 
-bool operator<(const intrusive_ptr<TimerTask>& a,
-                       const intrusive_ptr<TimerTask>& b)
-{
-    // Lower priority if time is later
-    return a.get() && b.get() && a->sortTime > b->sortTime;
-}
-
 }}
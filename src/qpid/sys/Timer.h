@@ -22,6 +22,7 @@
 #define sys_Timer
 
 #include "qpid/sys/TimerWarnings.h"
+#include "qpid/sys/TimerWheel.h"
 #include "qpid/sys/Monitor.h"
 #include "qpid/sys/Mutex.h"
 #include "qpid/sys/Thread.h"
@@ -29,7 +30,7 @@
 #include "qpid/RefCounted.h"
 #include "qpid/CommonImportExport.h"
 #include <memory>
-#include <queue>
+#include <vector>
 
 #include <boost/intrusive_ptr.hpp>
 
@@ -40,9 +41,8 @@ class Timer;
 
 class TimerTask : public RefCounted {
   friend class Timer;
+  friend class TimerWheel;
   friend class TimerTaskCallbackScope;
-  friend bool operator<(const boost::intrusive_ptr<TimerTask>&,
-                        const boost::intrusive_ptr<TimerTask>&);
 
     std::string name;
     AbsTime sortTime;
@@ -50,6 +50,9 @@ class TimerTask : public RefCounted {
     AbsTime nextFireTime;
     qpid::sys::Monitor stateMonitor;
     enum {WAITING, CALLING, CANCELLED} state;
+    Timer* timer;//set while added to a timer, guarded by stateMonitor
+    TimerWheel::Slot* slot;//guarded by the timer's lock
+    TimerWheel::Slot::iterator position;
 
     bool prepareToFire();
     void finishFiring();
@@ -99,7 +102,7 @@ class TimerTask : public RefCounted {
      * After cancelling the only thing you can do nothing further
      * with a TimerTask.
      *
-     * The Timer will delete the cancelled TimerTask.
+     * The cancelled TimerTask is removed from its Timer at once.
      */
     QPID_COMMON_EXTERN void cancel();
 
@@ -110,21 +113,28 @@ class TimerTask : public RefCounted {
     virtual void fire() = 0;
 };
 
-// For the priority_queue order
-bool operator<(const boost::intrusive_ptr<TimerTask>& a,
-               const boost::intrusive_ptr<TimerTask>& b);
-
 class Timer : private Runnable {
+  friend class TimerTask;
+
     qpid::sys::Monitor monitor;
-    std::priority_queue<boost::intrusive_ptr<TimerTask> > tasks;
-    qpid::sys::Thread runner;
+    TimerWheel tasks;
+    std::vector<qpid::sys::Thread> runners;
+    size_t threads;
     bool active;
 
     // Runnable interface
     void run();
+    boost::intrusive_ptr<TimerTask> remove(TimerTask&);
 
   public:
     QPID_COMMON_EXTERN Timer();
+    /**
+     * Create a Timer that fires tasks from the given number of threads.
+     * Different tasks may fire at the same time, but a task's fires are
+     * serialised: if it comes due again while still firing, the thread
+     * that picks it up waits for the earlier fire to return.
+     */
+    QPID_COMMON_EXTERN explicit Timer(size_t threads);
     QPID_COMMON_EXTERN virtual ~Timer();
 
     /** Add an TimerTask to the Timer queue
@@ -139,13 +149,13 @@ class Timer : private Runnable {
 
     /** Start the Timer
      *
-     * This will start a new thread that runs the Timer and the fire callbacks.
+     * This will start the threads that run the Timer and the fire callbacks.
      */
     QPID_COMMON_EXTERN virtual void start();
 
     /** Stop the Timer
      *
-     * This will stop the Timer and its thread.
+     * This will stop the Timer and its threads.
      */
     QPID_COMMON_EXTERN virtual void stop();
 
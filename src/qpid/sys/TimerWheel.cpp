@@ -0,0 +1,207 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/sys/TimerWheel.h"
+#include "qpid/sys/Timer.h"
+
+#include <algorithm>
+
+using boost::intrusive_ptr;
+
+namespace qpid {
+namespace sys {
+
+namespace {
+const Duration TICK(TIME_MSEC);
+}
+
+TimerWheel::TimerWheel() : origin(AbsTime::now()), current(0), count(0), firstLevelCount(0) {}
+
+// Rounds up, so that no task is ever returned early
+uint64_t TimerWheel::tickFor(AbsTime time) const
+{
+    int64_t d = Duration(origin, time);
+    if (d <= 0) return 0;
+    return d / TICK + (d % TICK ? 1 : 0);
+}
+
+AbsTime TimerWheel::timeOf(uint64_t tick) const
+{
+    return AbsTime(origin, Duration(tick * TICK));
+}
+
+bool TimerWheel::isFirstLevel(const Slot* slot) const
+{
+    return slot >= levels[0] && slot < levels[0] + SLOTS;
+}
+
+void TimerWheel::add(intrusive_ptr<TimerTask> task, AbsTime time)
+{
+    if (task->slot) remove(*task);
+    task->sortTime = time;
+    Slot added;
+    added.push_back(task);
+    place(added, added.begin());
+    ++count;
+}
+
+/**
+ * Moves the task at i to the slot for its tick; a task on a coarser
+ * level is kept in the slot covering its tick at that level.
+ */
+void TimerWheel::place(Slot& from, Slot::iterator i)
+{
+    TimerTask& task = **i;
+    uint64_t tick = std::max(tickFor(task.sortTime), current);
+    uint64_t delta = tick - current;
+    Slot* slot = &overflow;
+    for (int level = 0; level < LEVELS; ++level) {
+        if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+            slot = &levels[level][(tick >> (SLOT_BITS * level)) & MASK];
+            break;
+        }
+    }
+    slot->splice(slot->end(), from, i);
+    if (isFirstLevel(slot)) ++firstLevelCount;
+    task.slot = slot;
+    task.position = i;
+}
+
+intrusive_ptr<TimerTask> TimerWheel::remove(TimerTask& task)
+{
+    intrusive_ptr<TimerTask> removed;
+    if (task.slot) {
+        removed = *task.position;
+        if (task.slot != &due) --count;
+        if (isFirstLevel(task.slot)) --firstLevelCount;
+        task.slot->erase(task.position);
+        task.slot = 0;
+    }
+    return removed;
+}
+
+/**
+ * Called as the tick at the start of each rotation of the first level
+ * is reached, to move the tasks in the next slot of each coarser level
+ * that has also completed a rotation down to finer levels.
+ */
+void TimerWheel::cascade()
+{
+    for (int level = 1; level <= LEVELS; ++level) {
+        Slot& slot = level < LEVELS ? levels[level][(current >> (SLOT_BITS * level)) & MASK] : overflow;
+        Slot pending;
+        pending.splice(pending.end(), slot);
+        while (!pending.empty()) place(pending, pending.begin());
+        if (level < LEVELS && ((current >> (SLOT_BITS * level)) & MASK)) break;
+    }
+}
+
+void TimerWheel::advance(AbsTime now)
+{
+    int64_t d = Duration(origin, now);
+    if (d < 0) return;
+    uint64_t last = d / TICK;
+    while (current <= last) {
+        if (count == 0) {
+            current = last + 1;
+            break;
+        }
+        if ((current & MASK) == 0) cascade();
+        if (firstLevelCount == 0) {
+            // Nothing can be due before the next rotation
+            current = std::min(last + 1, (current | MASK) + 1);
+            continue;
+        }
+        Slot& slot = levels[0][current & MASK];
+        count -= slot.size();
+        firstLevelCount -= slot.size();
+        for (Slot::iterator i = slot.begin(); i != slot.end(); ++i) {
+            (*i)->slot = &due;
+        }
+        due.splice(due.end(), slot);
+        ++current;
+    }
+}
+
+intrusive_ptr<TimerTask> TimerWheel::next(AbsTime now)
+{
+    if (due.empty()) advance(now);
+    intrusive_ptr<TimerTask> task;
+    if (!due.empty()) {
+        task = due.front();
+        task->slot = 0;
+        due.pop_front();
+    }
+    return task;
+}
+
+AbsTime TimerWheel::nextExpiry() const
+{
+    if (!due.empty()) return due.front()->sortTime;
+    if (count == 0) return FAR_FUTURE;
+    uint64_t earliest = ~uint64_t(0);
+    for (uint64_t i = 0; firstLevelCount && i < SLOTS; ++i) {
+        if (!levels[0][(current + i) & MASK].empty()) {
+            earliest = current + i;
+            break;
+        }
+    }
+    // Tasks on coarser levels are moved down at the start of a rotation
+    // of the first level, so the first level can be relied on up to the
+    // next one; beyond that, the next task cannot be due before the
+    // next cascade that has anything to move
+    if (earliest <= (current | MASK) && (current & MASK)) return timeOf(earliest);
+    for (int level = 1; level <= LEVELS; ++level) {
+        int shift = SLOT_BITS * level;
+        uint64_t block = current >> shift;
+        // Until the cascade at the start of a rotation, the slot for
+        // the current block has still to be moved down
+        uint64_t first = current & ((uint64_t(1) << shift) - 1) ? 1 : 0;
+        if (level == LEVELS) {
+            if (!overflow.empty()) earliest = std::min(earliest, (block + first) << shift);
+        } else {
+            for (uint64_t i = first; i < first + SLOTS; ++i) {
+                if (!levels[level][(block + i) & MASK].empty()) {
+                    earliest = std::min(earliest, (block + i) << shift);
+                    break;
+                }
+            }
+        }
+    }
+    return earliest == ~uint64_t(0) ? FAR_FUTURE : timeOf(earliest);
+}
+
+void TimerWheel::clear(Slot& tasks)
+{
+    for (int level = 0; level < LEVELS; ++level) {
+        for (uint64_t i = 0; i < SLOTS; ++i) {
+            tasks.splice(tasks.end(), levels[level][i]);
+        }
+    }
+    tasks.splice(tasks.end(), overflow);
+    tasks.splice(tasks.end(), due);
+    for (Slot::iterator i = tasks.begin(); i != tasks.end(); ++i) {
+        (*i)->slot = 0;
+    }
+    count = 0;
+    firstLevelCount = 0;
+}
+
+}} // namespace qpid::sys
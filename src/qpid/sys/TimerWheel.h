@@ -0,0 +1,99 @@
+#ifndef QPID_SYS_TIMERWHEEL_H
+#define QPID_SYS_TIMERWHEEL_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/sys/Time.h"
+#include <list>
+#include <boost/intrusive_ptr.hpp>
+
+namespace qpid {
+namespace sys {
+
+class TimerTask;
+
+/**
+ * Hierarchical timing wheel holding the tasks scheduled on a Timer.
+ *
+ * Time is divided into ticks of a millisecond. Tasks due within the
+ * next 256 ticks are kept in the slot for their tick on the first
+ * level; later tasks are kept on coarser levels and moved down as
+ * their time approaches. Adding and removing a task take constant
+ * time. Advancing the wheel costs a step per elapsed tick while there
+ * are tasks due within the first level, and a step per rotation of
+ * the first level otherwise.
+ *
+ * Tasks record the slot they are in, so that they can be removed as
+ * soon as they are cancelled.
+ *
+ * Not thread safe; the Timer holds its lock when calling.
+ */
+class TimerWheel
+{
+  public:
+    typedef std::list<boost::intrusive_ptr<TimerTask> > Slot;
+
+    TimerWheel();
+
+    /** Schedules the task to be returned from next() at or after the given time */
+    void add(boost::intrusive_ptr<TimerTask>, AbsTime);
+    /**
+     * Removes the task if it is scheduled.
+     * @returns the wheel's reference to the task, if any
+     */
+    boost::intrusive_ptr<TimerTask> remove(TimerTask&);
+    /**
+     * Returns the next task that was due at or before now and removes
+     * it from the wheel, or null if there is none.
+     */
+    boost::intrusive_ptr<TimerTask> next(AbsTime now);
+    /**
+     * @returns a time no later than that at which the next task is
+     * due, or FAR_FUTURE if there are none
+     */
+    AbsTime nextExpiry() const;
+    bool empty() const { return count == 0 && due.empty(); }
+    /** Removes all tasks, passing them back in the given slot */
+    void clear(Slot&);
+
+  private:
+    enum { LEVELS = 4, SLOT_BITS = 8, SLOTS = 1 << SLOT_BITS, MASK = SLOTS - 1 };
+
+    const AbsTime origin;
+    uint64_t current;//the next tick to be processed
+    size_t count;//the number of tasks in the levels and overflow
+    size_t firstLevelCount;
+    Slot levels[LEVELS][SLOTS];
+    Slot overflow;//tasks too far in the future for any level
+    Slot due;
+
+    uint64_t tickFor(AbsTime) const;
+    AbsTime timeOf(uint64_t tick) const;
+    bool isFirstLevel(const Slot*) const;
+    void place(Slot& from, Slot::iterator);
+    void cascade();
+    void advance(AbsTime now);
+};
+
+}}
+
+#endif  /*!QPID_SYS_TIMERWHEEL_H*/
@@ -21,11 +21,14 @@
 #include "qpid/types/Variant.h"
 #include "qpid/log/Statement.h"
 #include "encodings.h"
+#include "qpid/sys/AtomicCount.h"
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
+#include <cstring>
 #include <limits>
+#include <new>
 #include <sstream>
 
 namespace qpid {
@@ -60,30 +63,80 @@ const std::string PREFIX("invalid conversion: ");
 InvalidConversion::InvalidConversion(const std::string& msg) : Exception(PREFIX + msg) {}
 InvalidConversion::~InvalidConversion() throw() {}
 
+namespace {
+// Flags held in Variant::state
+const uint8_t SHARED_STRING = 0x01;     // String is held in a SharedValue rather than inline
+const uint8_t NOT_SHAREABLE = 0x02;     // A modifiable reference to the shared value has been handed out
+
+// Encodings held in Variant::encoding, any other is held in the VariantExtras
+const uint8_t NO_ENCODING = 0;
+const uint8_t UTF8_ENCODING = 1;
+const uint8_t BINARY_ENCODING = 2;
+const uint8_t ASCII_ENCODING = 3;
+const uint8_t OTHER_ENCODING = 4;
+
+// Strings that fit in the small buffer of std::string itself are held
+// inline, longer ones are shared between copies.
+const std::string::size_type INLINE_STRING_LIMIT = std::string().capacity();
+
+typedef std::string String;
+
+/**
+ * Reference counted holder for a value that is shared between copies of
+ * a Variant until one of them asks for a modifiable reference to it.
+ */
+template <class T> struct SharedValue
+{
+    T value;
+    qpid::sys::AtomicCount count;
+
+    SharedValue(const T& v) : value(v), count(1) {}
+};
+
+template <class T> void release(SharedValue<T>* s)
+{
+    if (--(s->count) == 0) delete s;
+}
+
+template <class T> SharedValue<T>* copyShared(void* p, uint8_t state)
+{
+    SharedValue<T>* s = static_cast<SharedValue<T>*>(p);
+    if (state & NOT_SHAREABLE) return new SharedValue<T>(s->value);
+    ++(s->count);
+    return s;
+}
+
+/** Returns a reference that may be modified, copying the value first if it is shared. */
+template <class T> T& modifiable(void*& p, uint8_t& state)
+{
+    SharedValue<T>* s = static_cast<SharedValue<T>*>(p);
+    if (s->count > 1) {
+        SharedValue<T>* copy = new SharedValue<T>(s->value);
+        release(s);
+        p = s = copy;
+    }
+    state |= NOT_SHAREABLE;
+    return s->value;
+}
+
+typedef SharedValue<std::string> SharedString;
+typedef SharedValue<Variant::Map> SharedMap;
+typedef SharedValue<Variant::List> SharedList;
+
+const Variant::List NO_DESCRIPTORS;
+}
+
+class VariantExtras
+{
+  public:
+    Variant::List descriptors;         // Optional descriptors for described value.
+    std::string encoding;              // Encoding, if not one of the common ones.
+};
+
 class VariantImpl
 {
   public:
-    VariantImpl();
-    void reset();
-    void set(bool);
-    void set(uint8_t);
-    void set(uint16_t);
-    void set(uint32_t);
-    void set(uint64_t);
-    void set(int8_t);
-    void set(int16_t);
-    void set(int32_t);
-    void set(int64_t);
-    void set(float);
-    void set(double);
-    void set(const std::string&, const std::string& encoding=std::string());
-    void set(const Variant::Map&);
-    void set(const Variant::List&);
-    void set(const Uuid&);
-    void set(const Variant&);
-    ~VariantImpl();
-
-    VariantType getType() const;
+    VariantImpl(const Variant& v) : type(v.type), state(v.state), value(v.value) {}
 
     bool asBool() const;
     uint8_t asUint8() const;
@@ -100,46 +153,42 @@ class VariantImpl
     Uuid asUuid() const;
 
     const Variant::Map& asMap() const;
-    Variant::Map& asMap();
     const Variant::List& asList() const;
-    Variant::List& asList();
-
     const std::string& getString() const;
-    std::string& getString();
 
-    void setEncoding(const std::string&);
-    const std::string& getEncoding() const;
+    bool isEqualTo(const VariantImpl&) const;
 
-    bool isEqualTo(VariantImpl&) const;
-    bool isEquivalentTo(VariantImpl&) const;
-
-    Variant::List descriptors;         // Optional descriptors for described value.
+    static void clear(Variant&);
+    static void copy(Variant&, const Variant&);
+    static void move(Variant&, Variant&);
+    static void set(Variant&, const std::string&);
+    static void set(Variant&, const Variant::Map&);
+    static void set(Variant&, const Variant::List&);
+    static void set(Variant&, const Uuid&);
+    static Variant::Map& asMap(Variant&);
+    static Variant::List& asList(Variant&);
+    static std::string& getString(Variant&);
 
   private:
-    VariantType type;
-    union {
-        bool b;
-        uint8_t ui8;
-        uint16_t ui16;
-        uint32_t ui32;
-        uint64_t ui64;
-        int8_t i8;
-        int16_t i16;
-        int32_t i32;
-        int64_t i64;
-        float f;
-        double d;
-        Uuid* uuid;
-        Variant::Map* map;
-        Variant::List* list;
-        std::string* string;
-    } value;
-    std::string encoding;       // Optional encoding for variable length data.
+    const VariantType type;
+    const uint8_t state;
+    const Variant::Value& value;
+
+    const std::string& string() const
+    {
+        if (state & SHARED_STRING) return static_cast<const SharedString*>(value.shared)->value;
+        return *static_cast<const std::string*>(static_cast<const void*>(value.string));
+    }
+
+    static std::string* inlineString(Variant& v)
+    {
+        return static_cast<std::string*>(static_cast<void*>(v.value.string));
+    }
 
     template<class T>
     typename enable_if<is_signed<T>::value, T>::type convertFromString() const
     {
-        const std::string& s = *value.string;
+        const std::string& s = string();
 
         try {
             // Extra shenanigans to work around negative zero
@@ -157,7 +206,7 @@ class VariantImpl
     template<class T>
     typename enable_if<!is_signed<T>::value, T>::type convertFromString() const
     {
-        const std::string& s = *value.string;
+        const std::string& s = string();
 
         try {
             // Extra shenanigans to work around negative zero
@@ -174,54 +223,105 @@ class VariantImpl
     }
 };
 
-VariantImpl::VariantImpl() : type(VAR_VOID) {}
-
-void VariantImpl::set(bool b) { reset(); type = VAR_BOOL; value.b = b; }
-void VariantImpl::set(uint8_t i) { reset(); type = VAR_UINT8; value.ui8 = i; }
-void VariantImpl::set(uint16_t i) { reset(); type = VAR_UINT16; value.ui16 = i; }
-void VariantImpl::set(uint32_t i) { reset(); type = VAR_UINT32; value.ui32 = i; }
-void VariantImpl::set(uint64_t i) { reset(); type = VAR_UINT64; value.ui64 = i; }
-void VariantImpl::set(int8_t i) { reset(); type = VAR_INT8; value.i8 = i; }
-void VariantImpl::set(int16_t i) { reset(); type = VAR_INT16; value.i16 = i; }
-void VariantImpl::set(int32_t i) { reset(); type = VAR_INT32; value.i32 = i; }
-void VariantImpl::set(int64_t i) { reset(); type = VAR_INT64; value.i64 = i; }
-void VariantImpl::set(float f) { reset(); type = VAR_FLOAT; value.f = f; }
-void VariantImpl::set(double d) { reset(); type = VAR_DOUBLE; value.d = d; }
-void VariantImpl::set(const std::string& s, const std::string& e) { reset();  type = VAR_STRING; encoding = e; value.string = new std::string(s); }
-
-void VariantImpl::set(const Variant::Map& m) {
-    reset();
-    type = VAR_MAP;
-    value.map = new Variant::Map(m);
+void VariantImpl::clear(Variant& v)
+{
+    switch (v.type) {
+      case VAR_STRING:
+        if (v.state & SHARED_STRING) release(static_cast<SharedString*>(v.value.shared));
+        else inlineString(v)->~String();
+        break;
+      case VAR_MAP:
+        release(static_cast<SharedMap*>(v.value.shared));
+        break;
+      case VAR_LIST:
+        release(static_cast<SharedList*>(v.value.shared));
+        break;
+      default:
+        break;
+    }
+    v.type = VAR_VOID;
+    v.state = 0;
 }
 
-void VariantImpl::set(const Variant::List& l) { reset(); type = VAR_LIST; value.list = new Variant::List(l); }
-
-void VariantImpl::set(const Uuid& u) { reset(); type = VAR_UUID; value.uuid = new Uuid(u); }
-
-VariantImpl::~VariantImpl() { reset(); }
-
-void VariantImpl::reset() {
-    switch (type) {
+void VariantImpl::copy(Variant& v, const Variant& from)
+{
+    switch (from.type) {
       case VAR_STRING:
-        delete value.string;
+        if (from.state & SHARED_STRING) {
+            v.value.shared = copyShared<std::string>(from.value.shared, from.state);
+            v.state = SHARED_STRING;
+        } else {
+            new (v.value.string) std::string(VariantImpl(from).string());
+        }
         break;
       case VAR_MAP:
-        delete value.map;
+        v.value.shared = copyShared<Variant::Map>(from.value.shared, from.state);
         break;
       case VAR_LIST:
-        delete value.list;
-        break;
-      case VAR_UUID:
-        delete value.uuid;
+        v.value.shared = copyShared<Variant::List>(from.value.shared, from.state);
         break;
       default:
+        v.value = from.value;
         break;
     }
-    type = VAR_VOID;
+    v.type = from.type;
+}
+
+void VariantImpl::move(Variant& v, Variant& from)
+{
+    if (from.type == VAR_STRING && !(from.state & SHARED_STRING)) {
+        new (v.value.string) std::string();
+        inlineString(v)->swap(*inlineString(from));
+        inlineString(from)->~String();
+    } else {
+        v.value = from.value;
+    }
+    v.type = from.type;
+    v.state = from.state;
+    from.type = VAR_VOID;
+    from.state = 0;
+}
+
+void VariantImpl::set(Variant& v, const std::string& s)
+{
+    if (s.size() > INLINE_STRING_LIMIT) {
+        SharedString* shared = new SharedString(s);
+        clear(v);
+        v.value.shared = shared;
+        v.state = SHARED_STRING;
+    } else if (v.type == VAR_STRING && !(v.state & SHARED_STRING)) {
+        *inlineString(v) = s;
+    } else {
+        std::string copy(s);    // s may be held within v
+        clear(v);
+        new (v.value.string) std::string();
+        inlineString(v)->swap(copy);
+    }
+    v.type = VAR_STRING;
 }
 
-VariantType VariantImpl::getType() const { return type; }
+void VariantImpl::set(Variant& v, const Variant::Map& m)
+{
+    SharedMap* shared = new SharedMap(m);
+    clear(v);
+    v.value.shared = shared;
+    v.type = VAR_MAP;
+}
+
+void VariantImpl::set(Variant& v, const Variant::List& l)
+{
+    SharedList* shared = new SharedList(l);
+    clear(v);
+    v.value.shared = shared;
+    v.type = VAR_LIST;
+}
+
+void VariantImpl::set(Variant& v, const Uuid& u)
+{
+    clear(v);
+    ::memcpy(v.value.uuid, u.data(), sizeof(v.value.uuid));
+    v.type = VAR_UUID;
+}
 
 namespace {
 
@@ -273,7 +373,7 @@ bool VariantImpl::asBool() const
       case VAR_INT16: return value.i16;
       case VAR_INT32: return value.i32;
       case VAR_INT64: return value.i64;
-      case VAR_STRING: return toBool(*value.string);
+      case VAR_STRING: return toBool(string());
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_BOOL)));
     }
 }
@@ -552,8 +652,8 @@ std::string VariantImpl::asString() const
       case VAR_INT64: return boost::lexical_cast<std::string>(value.i64);
       case VAR_DOUBLE: return boost::lexical_cast<std::string>(value.d);
       case VAR_FLOAT: return boost::lexical_cast<std::string>(value.f);
-      case VAR_STRING: return *value.string;
-      case VAR_UUID: return value.uuid->str();
+      case VAR_STRING: return string();
+      case VAR_UUID: return Uuid(value.uuid).str();
       case VAR_LIST: return toString(asList());
       case VAR_MAP: return toString(asMap());
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_STRING)));
@@ -562,12 +662,12 @@ std::string VariantImpl::asString() const
 Uuid VariantImpl::asUuid() const
 {
     switch(type) {
-      case VAR_UUID: return *value.uuid;
+      case VAR_UUID: return Uuid(value.uuid);
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_UUID)));
     }
 }
 
-bool VariantImpl::isEqualTo(VariantImpl& other) const
+bool VariantImpl::isEqualTo(const VariantImpl& other) const
 {
     if (type == other.type) {
         switch(type) {
@@ -583,8 +683,8 @@ bool VariantImpl::isEqualTo(VariantImpl& other) const
           case VAR_INT64: return value.i64 == other.value.i64;
           case VAR_DOUBLE: return value.d == other.value.d;
           case VAR_FLOAT: return value.f == other.value.f;
-          case VAR_STRING: return *value.string == *other.value.string;
-          case VAR_UUID: return *value.uuid == *other.value.uuid;
+          case VAR_STRING: return string() == other.string();
+          case VAR_UUID: return ::memcmp(value.uuid, other.value.uuid, sizeof(value.uuid)) == 0;
           case VAR_LIST: return equal(asList(), other.asList());
           case VAR_MAP: return equal(asMap(), other.asMap());
         }
@@ -595,39 +695,41 @@ bool VariantImpl::isEqualTo(VariantImpl& other) const
 const Variant::Map& VariantImpl::asMap() const
 {
     switch(type) {
-      case VAR_MAP: return *value.map;
+      case VAR_MAP: return static_cast<const SharedMap*>(value.shared)->value;
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_MAP)));
     }
 }
 
-Variant::Map& VariantImpl::asMap()
+Variant::Map& VariantImpl::asMap(Variant& v)
 {
-    switch(type) {
-      case VAR_MAP: return *value.map;
-      default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_MAP)));
+    switch(v.type) {
+      case VAR_MAP: return modifiable<Variant::Map>(v.value.shared, v.state);
+      default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(v.type) << " to " << getTypeName(VAR_MAP)));
     }
 }
 
 const Variant::List& VariantImpl::asList() const
 {
     switch(type) {
-      case VAR_LIST: return *value.list;
+      case VAR_LIST: return static_cast<const SharedList*>(value.shared)->value;
       default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_LIST)));
     }
 }
 
-Variant::List& VariantImpl::asList()
+Variant::List& VariantImpl::asList(Variant& v)
 {
-    switch(type) {
-      case VAR_LIST: return *value.list;
-      default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(type) << " to " << getTypeName(VAR_LIST)));
+    switch(v.type) {
+      case VAR_LIST: return modifiable<Variant::List>(v.value.shared, v.state);
+      default: throw InvalidConversion(QPID_MSG("Cannot convert from " << getTypeName(v.type) << " to " << getTypeName(VAR_LIST)));
     }
 }
 
-std::string& VariantImpl::getString()
+std::string& VariantImpl::getString(Variant& v)
 {
-    switch(type) {
-      case VAR_STRING: return *value.string;
+    switch(v.type) {
+      case VAR_STRING:
+        if (v.state & SHARED_STRING) return modifiable<std::string>(v.value.shared, v.state);
+        return *inlineString(v);
       default: throw InvalidConversion(QPID_MSG("Variant is not a string; use asString() if conversion is required."));
     }
 }
@@ -635,14 +737,11 @@ std::string& VariantImpl::getString()
 const std::string& VariantImpl::getString() const
 {
     switch(type) {
-      case VAR_STRING: return *value.string;
+      case VAR_STRING: return string();
       default: throw InvalidConversion(QPID_MSG("Variant is not a string; use asString() if conversion is required."));
     }
 }
 
-void VariantImpl::setEncoding(const std::string& s) { encoding = s; }
-const std::string& VariantImpl::getEncoding() const { return encoding; }
-
 std::string getTypeName(VariantType type)
 {
     switch (type) {
@@ -684,158 +783,167 @@ bool isIntegerType(VariantType type)
     }
 }
 
-void VariantImpl::set(const Variant& v)
-{
-    switch (v.getType()) {
-      case VAR_BOOL: set(v.asBool()); break;
-      case VAR_UINT8: set(v.asUint8()); break;
-      case VAR_UINT16: set(v.asUint16()); break;
-      case VAR_UINT32: set(v.asUint32()); break;
-      case VAR_UINT64: set(v.asUint64()); break;
-      case VAR_INT8: set(v.asInt8()); break;
-      case VAR_INT16: set(v.asInt16()); break;
-      case VAR_INT32: set(v.asInt32()); break;
-      case VAR_INT64: set(v.asInt64()); break;
-      case VAR_FLOAT: set(v.asFloat()); break;
-      case VAR_DOUBLE: set(v.asDouble()); break;
-      case VAR_STRING: set(v.asString(), v.getEncoding()); break;
-      case VAR_MAP: set(v.asMap()); break;
-      case VAR_LIST: set(v.asList()); break;
-      case VAR_UUID: set(v.asUuid()); break;
-      default: reset();
-    }
-    encoding = v.getEncoding();
-    descriptors = v.getDescriptors();
-}
-
-Variant::Variant() : impl(0) {}
-Variant::Variant(bool b) : impl(new VariantImpl()) { impl->set(b); }
-Variant::Variant(uint8_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(uint16_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(uint32_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(uint64_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(int8_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(int16_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(int32_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(int64_t i) : impl(new VariantImpl()) { impl->set(i); }
-Variant::Variant(float f) : impl(new VariantImpl()) { impl->set(f); }
-Variant::Variant(double d) : impl(new VariantImpl()) { impl->set(d); }
-Variant::Variant(const std::string& s) : impl(new VariantImpl()) { impl->set(s); }
-Variant::Variant(const std::string& s, const std::string& encoding) : impl(new VariantImpl()) { impl->set(s, encoding); }
-Variant::Variant(const char* s) : impl(new VariantImpl()) { impl->set(std::string(s)); }
-Variant::Variant(const char* s, const char* encoding) : impl(new VariantImpl()) { impl->set(std::string(s), std::string(encoding)); }
-Variant::Variant(const Map& m) : impl(new VariantImpl()) { impl->set(m); }
-Variant::Variant(const List& l) : impl(new VariantImpl()) { impl->set(l); }
-Variant::Variant(const Variant& v) : impl(new VariantImpl()) { impl->set(v); }
-Variant::Variant(const Uuid& u) : impl(new VariantImpl()) { impl->set(u); }
-
-Variant::~Variant() { if (impl) delete impl; }
-
-void Variant::reset()
+Variant::Variant() : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) {}
+Variant::Variant(bool b) : type(VAR_BOOL), encoding(NO_ENCODING), state(0), extras(0) { value.b = b; }
+Variant::Variant(uint8_t i) : type(VAR_UINT8), encoding(NO_ENCODING), state(0), extras(0) { value.ui8 = i; }
+Variant::Variant(uint16_t i) : type(VAR_UINT16), encoding(NO_ENCODING), state(0), extras(0) { value.ui16 = i; }
+Variant::Variant(uint32_t i) : type(VAR_UINT32), encoding(NO_ENCODING), state(0), extras(0) { value.ui32 = i; }
+Variant::Variant(uint64_t i) : type(VAR_UINT64), encoding(NO_ENCODING), state(0), extras(0) { value.ui64 = i; }
+Variant::Variant(int8_t i) : type(VAR_INT8), encoding(NO_ENCODING), state(0), extras(0) { value.i8 = i; }
+Variant::Variant(int16_t i) : type(VAR_INT16), encoding(NO_ENCODING), state(0), extras(0) { value.i16 = i; }
+Variant::Variant(int32_t i) : type(VAR_INT32), encoding(NO_ENCODING), state(0), extras(0) { value.i32 = i; }
+Variant::Variant(int64_t i) : type(VAR_INT64), encoding(NO_ENCODING), state(0), extras(0) { value.i64 = i; }
+Variant::Variant(float f) : type(VAR_FLOAT), encoding(NO_ENCODING), state(0), extras(0) { value.f = f; }
+Variant::Variant(double d) : type(VAR_DOUBLE), encoding(NO_ENCODING), state(0), extras(0) { value.d = d; }
+Variant::Variant(const std::string& s) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, s); }
+Variant::Variant(const std::string& s, const std::string& e) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, s); setEncoding(e); }
+Variant::Variant(const char* s) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, std::string(s)); }
+Variant::Variant(const char* s, const char* e) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, std::string(s)); setEncoding(e); }
+Variant::Variant(const Map& m) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, m); }
+Variant::Variant(const List& l) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, l); }
+Variant::Variant(const Uuid& u) : type(VAR_VOID), encoding(NO_ENCODING), state(0), extras(0) { VariantImpl::set(*this, u); }
+Variant::Variant(const Variant& v) : type(VAR_VOID), encoding(v.encoding), state(0), extras(0)
 {
-    if (impl) delete impl;
-    impl = 0;
+    VariantImpl::copy(*this, v);
+    if (v.extras) extras = new VariantExtras(*v.extras);
 }
 
-namespace {
-VariantImpl* assure(VariantImpl*& ptr) {
-    if (!ptr) ptr = new VariantImpl();
-    return ptr;
+Variant::~Variant()
+{
+    VariantImpl::clear(*this);
+    delete extras;
 }
+
+void Variant::reset()
+{
+    VariantImpl::clear(*this);
+    encoding = NO_ENCODING;
+    delete extras;
+    extras = 0;
 }
 
 Variant& Variant::operator=(bool b)
 {
-    assure(impl)->set(b);
+    VariantImpl::clear(*this);
+    type = VAR_BOOL;
+    value.b = b;
     return *this;
 }
 
 Variant& Variant::operator=(uint8_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_UINT8;
+    value.ui8 = i;
     return *this;
 }
 Variant& Variant::operator=(uint16_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_UINT16;
+    value.ui16 = i;
     return *this;
 }
 Variant& Variant::operator=(uint32_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_UINT32;
+    value.ui32 = i;
     return *this;
 }
 Variant& Variant::operator=(uint64_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_UINT64;
+    value.ui64 = i;
     return *this;
 }
 
 Variant& Variant::operator=(int8_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_INT8;
+    value.i8 = i;
     return *this;
 }
 Variant& Variant::operator=(int16_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_INT16;
+    value.i16 = i;
     return *this;
 }
 Variant& Variant::operator=(int32_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_INT32;
+    value.i32 = i;
     return *this;
 }
 Variant& Variant::operator=(int64_t i)
 {
-    assure(impl)->set(i);
+    VariantImpl::clear(*this);
+    type = VAR_INT64;
+    value.i64 = i;
     return *this;
 }
 
 Variant& Variant::operator=(float f)
 {
-    assure(impl)->set(f);
+    VariantImpl::clear(*this);
+    type = VAR_FLOAT;
+    value.f = f;
     return *this;
 }
 Variant& Variant::operator=(double d)
 {
-    assure(impl)->set(d);
+    VariantImpl::clear(*this);
+    type = VAR_DOUBLE;
+    value.d = d;
     return *this;
 }
 
 Variant& Variant::operator=(const std::string& s)
 {
-    assure(impl)->set(s);
+    VariantImpl::set(*this, s);
+    encoding = NO_ENCODING;
     return *this;
 }
 
 Variant& Variant::operator=(const char* s)
 {
-    assure(impl)->set(std::string(s));
+    VariantImpl::set(*this, std::string(s));
+    encoding = NO_ENCODING;
     return *this;
 }
 
 Variant& Variant::operator=(const Uuid& u)
 {
-    assure(impl)->set(u);
+    VariantImpl::set(*this, u);
     return *this;
 }
 
 Variant& Variant::operator=(const Map& m)
 {
-    assure(impl)->set(m);
+    VariantImpl::set(*this, m);
     return *this;
 }
 
 Variant& Variant::operator=(const List& l)
 {
-    assure(impl)->set(l);
+    VariantImpl::set(*this, l);
     return *this;
 }
 
 Variant& Variant::operator=(const Variant& v)
 {
-    assure(impl)->set(v);
+    if (this != &v) {
+        Variant copy(v);    // v may be held within this variant
+        VariantImpl::clear(*this);
+        VariantImpl::move(*this, copy);
+        encoding = copy.encoding;
+        std::swap(extras, copy.extras);
+    }
     return *this;
 }
 
@@ -859,31 +967,47 @@ Variant& Variant::parse(const std::string& s)
 }
 
 
-VariantType Variant::getType() const { return impl ? impl->getType() : VAR_VOID; }
-bool Variant::isVoid() const { return getType() == VAR_VOID; }
-bool Variant::asBool() const { return impl && impl->asBool(); }
-uint8_t Variant::asUint8() const { return impl ? impl->asUint8() : 0; }
-uint16_t Variant::asUint16() const { return impl ? impl->asUint16() : 0; }
-uint32_t Variant::asUint32() const { return impl ? impl->asUint32() : 0; }
-uint64_t Variant::asUint64() const { return impl ? impl->asUint64() : 0; }
-int8_t Variant::asInt8() const { return impl ? impl->asInt8() : 0; }
-int16_t Variant::asInt16() const { return impl ? impl->asInt16() : 0; }
-int32_t Variant::asInt32() const { return impl ? impl->asInt32(): 0; }
-int64_t Variant::asInt64() const { return impl ? impl->asInt64() : 0; }
-float Variant::asFloat() const { return impl ? impl->asFloat() : 0; }
-double Variant::asDouble() const { return impl ? impl->asDouble() : 0; }
-std::string Variant::asString() const { return impl ? impl->asString() : EMPTY; }
-Uuid Variant::asUuid() const { return impl ? impl->asUuid() : Uuid(); }
-const Variant::Map& Variant::asMap() const { if (!impl) throw InvalidConversion("Can't convert VOID to MAP"); return impl->asMap(); }
-Variant::Map& Variant::asMap() { if (!impl) throw InvalidConversion("Can't convert VOID to MAP"); return impl->asMap(); }
-const Variant::List& Variant::asList() const { if (!impl) throw InvalidConversion("Can't convert VOID to LIST"); return impl->asList(); }
-Variant::List& Variant::asList() { if (!impl) throw InvalidConversion("Can't convert VOID to LIST"); return impl->asList(); }
-const std::string& Variant::getString() const { if (!impl) throw InvalidConversion("Can't convert VOID to STRING"); return impl->getString(); }
-std::string& Variant::getString() { if (!impl) throw InvalidConversion("Can't convert VOID to STRING"); return impl->getString(); }
+VariantType Variant::getType() const { return type; }
+bool Variant::isVoid() const { return type == VAR_VOID; }
+bool Variant::asBool() const { return VariantImpl(*this).asBool(); }
+uint8_t Variant::asUint8() const { return isVoid() ? 0 : VariantImpl(*this).asUint8(); }
+uint16_t Variant::asUint16() const { return isVoid() ? 0 : VariantImpl(*this).asUint16(); }
+uint32_t Variant::asUint32() const { return isVoid() ? 0 : VariantImpl(*this).asUint32(); }
+uint64_t Variant::asUint64() const { return isVoid() ? 0 : VariantImpl(*this).asUint64(); }
+int8_t Variant::asInt8() const { return isVoid() ? 0 : VariantImpl(*this).asInt8(); }
+int16_t Variant::asInt16() const { return isVoid() ? 0 : VariantImpl(*this).asInt16(); }
+int32_t Variant::asInt32() const { return isVoid() ? 0 : VariantImpl(*this).asInt32(); }
+int64_t Variant::asInt64() const { return isVoid() ? 0 : VariantImpl(*this).asInt64(); }
+float Variant::asFloat() const { return isVoid() ? 0 : VariantImpl(*this).asFloat(); }
+double Variant::asDouble() const { return isVoid() ? 0 : VariantImpl(*this).asDouble(); }
+std::string Variant::asString() const { return VariantImpl(*this).asString(); }
+Uuid Variant::asUuid() const { return isVoid() ? Uuid() : VariantImpl(*this).asUuid(); }
+const Variant::Map& Variant::asMap() const { if (isVoid()) throw InvalidConversion("Can't convert VOID to MAP"); return VariantImpl(*this).asMap(); }
+Variant::Map& Variant::asMap() { if (isVoid()) throw InvalidConversion("Can't convert VOID to MAP"); return VariantImpl::asMap(*this); }
+const Variant::List& Variant::asList() const { if (isVoid()) throw InvalidConversion("Can't convert VOID to LIST"); return VariantImpl(*this).asList(); }
+Variant::List& Variant::asList() { if (isVoid()) throw InvalidConversion("Can't convert VOID to LIST"); return VariantImpl::asList(*this); }
+const std::string& Variant::getString() const { if (isVoid()) throw InvalidConversion("Can't convert VOID to STRING"); return VariantImpl(*this).getString(); }
+std::string& Variant::getString() { if (isVoid()) throw InvalidConversion("Can't convert VOID to STRING"); return VariantImpl::getString(*this); }
 void Variant::setEncoding(const std::string& s) {
-    assure(impl)->setEncoding(s);
+    if (s.empty()) encoding = NO_ENCODING;
+    else if (s == encodings::UTF8) encoding = UTF8_ENCODING;
+    else if (s == encodings::BINARY) encoding = BINARY_ENCODING;
+    else if (s == encodings::ASCII) encoding = ASCII_ENCODING;
+    else {
+        if (!extras) extras = new VariantExtras();
+        extras->encoding = s;
+        encoding = OTHER_ENCODING;
+    }
+}
+const std::string& Variant::getEncoding() const {
+    switch (encoding) {
+      case UTF8_ENCODING: return encodings::UTF8;
+      case BINARY_ENCODING: return encodings::BINARY;
+      case ASCII_ENCODING: return encodings::ASCII;
+      case OTHER_ENCODING: return extras->encoding;
+      default: return EMPTY;
+    }
 }
-const std::string& Variant::getEncoding() const { return impl ? impl->getEncoding() : EMPTY; }
 
 Variant::operator bool() const { return asBool(); }
 Variant::operator uint8_t() const { return asUint8(); }
@@ -957,19 +1081,20 @@ bool Variant::isEqualTo(const Variant& other) const
 {
     if (isVoid() && other.isVoid()) return true;
     if (isVoid() || other.isVoid()) return false;
-    return impl && impl->isEqualTo(*other.impl);
+    return VariantImpl(*this).isEqualTo(VariantImpl(other));
 }
 
 bool Variant::isDescribed() const {
-    return impl && !impl->descriptors.empty();
+    return extras && !extras->descriptors.empty();
 }
 
 Variant::List& Variant::getDescriptors() {
-    return assure(impl)->descriptors;
+    if (!extras) extras = new VariantExtras();
+    return extras->descriptors;
 }
 
 const Variant::List& Variant::getDescriptors() const {
-    return assure(impl)->descriptors;
+    return extras ? extras->descriptors : NO_DESCRIPTORS;
 }
 
 Variant Variant::getDescriptor() const {
@@ -19,8 +19,14 @@
 
 #include "unit_test.h"
 #include "test_tools.h"
+#include "qpid/acl/AclData.h"
 #include "qpid/acl/AclLexer.h"
+#include "qpid/acl/AclReader.h"
+#include "qpid/broker/AclModule.h"
 #include <boost/assign.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstdio>
+#include <fstream>
 
 using namespace std;
 using namespace qpid;
@@ -161,6 +167,142 @@ QPID_AUTO_TEST_CASE(TestLexerResultEnums) {
     RESULT_ENUMS(DENYLOG,  "deny-log");
 }
 
+QPID_AUTO_TEST_CASE(TestPublishCache) {
+    broker::AclPublishCache cache;
+    AclResult result(DENY);
+    BOOST_CHECK(!cache.get(1, "amq.topic", "a.b", result));
+
+    cache.put(1, "amq.topic", "a.b", ALLOWLOG);
+    BOOST_CHECK(cache.get(1, "amq.topic", "a.b", result));
+    BOOST_CHECK_EQUAL(result, ALLOWLOG);
+    BOOST_CHECK(!cache.get(1, "amq.topic", "a.c", result));
+    BOOST_CHECK(!cache.get(1, "amq.direct", "a.b", result));
+
+    // Results from earlier rules are not used
+    BOOST_CHECK(!cache.get(2, "amq.topic", "a.b", result));
+    cache.put(2, "amq.topic", "a.c", DENY);
+    BOOST_CHECK(!cache.get(2, "amq.topic", "a.b", result));
+    BOOST_CHECK(cache.get(2, "amq.topic", "a.c", result));
+    BOOST_CHECK_EQUAL(result, DENY);
+}
+
+namespace {
+const std::string ACL_FILE("AclTestRules.acl");
+
+// Deterministic generator so that failures can be reproduced
+struct Random {
+    uint32_t state;
+    Random(uint32_t seed) : state(seed) {}
+    uint32_t operator()(uint32_t n) {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) % n;
+    }
+    template <size_t N> const char* pick(const char* (&values)[N]) {
+        return values[(*this)(N)];
+    }
+};
+
+boost::shared_ptr<AclData> load(const std::string& rules)
+{
+    {
+        std::ofstream out(ACL_FILE.c_str());
+        out << rules;
+    }
+    boost::shared_ptr<AclData> data(new AclData);
+    AclReader reader(0, 0);
+    int result = reader.read(ACL_FILE, data);
+    std::remove(ACL_FILE.c_str());
+    BOOST_REQUIRE_MESSAGE(result == 0, reader.getError());
+    return data;
+}
+}
+
+QPID_AUTO_TEST_CASE(TestCompiledRulesFirstMatch) {
+    boost::shared_ptr<AclData> data = load(
+        "acl deny alice@QPID create queue name=tenant1.secret\n"
+        "acl allow alice@QPID create queue name=tenant1.*\n"
+        "acl allow alice@QPID create queue name=${userdomain}-*\n"
+        "acl deny-log all all\n");
+    BOOST_CHECK_EQUAL(data->lookup("alice@QPID", ACT_CREATE, OBJ_QUEUE, "tenant1.secret"), DENY);
+    BOOST_CHECK_EQUAL(data->lookup("alice@QPID", ACT_CREATE, OBJ_QUEUE, "tenant1.q"), ALLOW);
+    BOOST_CHECK_EQUAL(data->lookup("alice@QPID", ACT_CREATE, OBJ_QUEUE, "tenant1."), ALLOW);
+    BOOST_CHECK_EQUAL(data->lookup("alice@QPID", ACT_CREATE, OBJ_QUEUE, "tenant1"), DENYLOG);
+    BOOST_CHECK_EQUAL(data->lookup("alice@QPID", ACT_CREATE, OBJ_QUEUE, "alice_QPID-q"), ALLOW);
+    BOOST_CHECK_EQUAL(data->lookup("bob@QPID", ACT_CREATE, OBJ_QUEUE, "tenant1.q"), DENYLOG);
+}
+
+QPID_AUTO_TEST_CASE(TestCompiledRulesAgreeWithLinear) {
+    const char* results[] = { "allow", "allow-log", "deny", "deny-log" };
+    const char* users[] = { "alice@QPID", "bob@QPID", "all", "admins" };
+    const char* actions[] = { "create", "access", "consume", "delete", "bind" };
+    const char* objects[] = { "queue", "exchange", "all" };
+    const char* ruleProps[] = {
+        "name=q1", "name=q12", "name=q*", "name=*", "name=tenant1.*", "name=tenant1.q",
+        "name=tenant2.q", "name=${userdomain}-*", "name=tenant-${user}",
+        "durable=true", "durable=false", "alternate=${userdomain}-alt", "alternate=alt*",
+        "queuename=q*", "routingkey=a.#", "routingkey=${user}.*",
+        "queuemaxsizeupperlimit=100", "queuemaxsizeupperlimit=0", "queuemaxsizelowerlimit=10",
+        "queuemaxcountupperlimit=50", "pagesupperlimit=8" };
+    const char* ids[] = { "alice@QPID", "bob@QPID", "carol@QPID" };
+    const char* names[] = {
+        "q1", "q12", "q", "q2", "", "tenant1.q", "tenant1.x", "tenant1", "tenant2.q",
+        "alice_QPID-x", "bob_QPID-y", "tenant-alice", "tenant-bob", "x" };
+    const char* durable[] = { "true", "false" };
+    const char* alternates[] = { "alice_QPID-alt", "bob_QPID-alt", "alt1", "other" };
+    const char* sizes[] = { "0", "5", "50", "500", "bad" };
+    const char* keys[] = { "a.b", "a", "alice.x", "c" };
+
+    Random random(1);
+    for (int file = 0; file < 25; ++file) {
+        std::ostringstream rules;
+        rules << "group admins alice@QPID bob@QPID\n";
+        int count = 1 + random(40);
+        for (int i = 0; i < count; ++i) {
+            rules << "acl " << random.pick(results) << " " << random.pick(users);
+            if (!random(8)) {
+                rules << " all\n";
+                continue;
+            }
+            rules << " " << random.pick(actions) << " " << random.pick(objects);
+            int props = random(4);
+            for (int j = 0; j < props; ++j) {
+                rules << " " << random.pick(ruleProps);
+            }
+            rules << "\n";
+        }
+        if (random(2)) {
+            rules << "acl " << random.pick(results) << " all all\n";
+        }
+        boost::shared_ptr<AclData> data = load(rules.str());
+
+        for (int i = 0; i < 400; ++i) {
+            std::string id(random.pick(ids));
+            Action action(Action(random(ACTIONSIZE)));
+            ObjectType object(ObjectType(random(OBJECTSIZE)));
+            std::string name(random.pick(names));
+            std::map<Property, std::string> params;
+            if (random(2)) params[PROP_DURABLE] = random.pick(durable);
+            if (random(2)) params[PROP_ALTERNATE] = random.pick(alternates);
+            if (random(2)) params[PROP_QUEUENAME] = random.pick(names);
+            if (random(2)) params[PROP_ROUTINGKEY] = random.pick(keys);
+            if (random(2)) params[PROP_MAXQUEUESIZE] = random.pick(sizes);
+            if (random(2)) params[PROP_MAXQUEUECOUNT] = random.pick(sizes);
+            if (random(2)) params[PROP_MAXPAGES] = random.pick(sizes);
+            std::map<Property, std::string>* p = random(8) ? &params : 0;
+
+            AclResult expected = data->lookupLinear(id, action, object, name, p);
+            AclResult actual = data->lookup(id, action, object, name, p);
+            BOOST_CHECK_MESSAGE(expected == actual,
+                                "rules:\n" << rules.str() << "lookup " << id << " "
+                                << AclHelper::getActionStr(action) << " "
+                                << AclHelper::getObjectTypeStr(object) << " '" << name << "' "
+                                << AclHelper::propertyMapToString(p) << " gave "
+                                << AclHelper::getAclResultStr(actual) << " expected "
+                                << AclHelper::getAclResultStr(expected));
+        }
+    }
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
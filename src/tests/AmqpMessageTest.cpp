@@ -0,0 +1,134 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/broker/amqp/Message.h"
+#include "qpid/broker/Message.h"
+#include "qpid/types/Variant.h"
+
+#include "unit_test.h"
+
+#include <string.h>
+
+using qpid::broker::amqp::Message;
+using qpid::types::Variant;
+using std::string;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(AmqpMessageTestSuite)
+
+namespace {
+// Hand encoded AMQP 1.0 sections, so that keys can be repeated or be
+// of types other than string
+string str8(const string& s) { return string(1, '\xa1') + char(s.size()) + s; }
+string smallint(int8_t i) { return string(1, '\x54') + char(i); }
+string smallulong(uint8_t i) { return string(1, '\x53') + char(i); }
+const string TRUE_VALUE("\x41", 1);
+const string NULL_VALUE("\x40", 1);
+const string EMPTY_LIST("\x45", 1);
+
+string applicationProperties(const string& entries, uint8_t count)
+{
+    return string("\x00\x53\x74\xc1", 4) + char(entries.size() + 1) + char(count) + entries;
+}
+
+string data(const string& content)
+{
+    return string("\x00\x53\x75\xa0", 4) + char(content.size()) + content;
+}
+
+qpid::broker::Message create(const string& sections)
+{
+    boost::intrusive_ptr<Message> m(new Message(sections.size()));
+    ::memcpy(m->getData(), sections.data(), sections.size());
+    m->scan();
+    return qpid::broker::Message(m, m);
+}
+}
+
+QPID_AUTO_TEST_CASE(testMissingProperty)
+{
+    qpid::broker::Message m = create(applicationProperties(str8("a") + smallint(1) + str8("c") + smallint(3), 4) + data("x"));
+    BOOST_CHECK(m.getProperty("b").isVoid());
+    BOOST_CHECK(m.getProperty("").isVoid());
+    BOOST_CHECK(m.getProperty("aa").isVoid());
+    BOOST_CHECK(m.getProperty("d").isVoid());
+    BOOST_CHECK_EQUAL(m.getPropertyAsString("b"), string());
+    BOOST_CHECK_EQUAL(m.getProperty("a"), Variant(int32_t(1)));
+    BOOST_CHECK_EQUAL(m.getProperty("c"), Variant(int32_t(3)));
+
+    qpid::broker::Message none = create(data("x"));
+    BOOST_CHECK(none.getProperty("a").isVoid());
+    qpid::broker::Message empty = create(applicationProperties(string(), 0) + data("x"));
+    BOOST_CHECK(empty.getProperty("a").isVoid());
+}
+
+QPID_AUTO_TEST_CASE(testDuplicateProperty)
+{
+    // As when all properties are decoded into a map, the last of
+    // several entries with the same key wins
+    qpid::broker::Message m = create(applicationProperties(str8("k") + str8("first")
+                                                           + str8("other") + smallint(7)
+                                                           + str8("k") + str8("second")
+                                                           + str8("k") + str8("last"), 8) + data("x"));
+    BOOST_CHECK_EQUAL(m.getPropertyAsString("k"), string("last"));
+    BOOST_CHECK_EQUAL(m.getProperty("k").asString(), string("last"));
+    BOOST_CHECK_EQUAL(m.getProperty("other"), Variant(int32_t(7)));
+}
+
+QPID_AUTO_TEST_CASE(testMixedTypeValues)
+{
+    qpid::broker::Message m = create(applicationProperties(str8("list") + EMPTY_LIST
+                                                           + str8("int") + smallint(-5)
+                                                           + str8("null") + NULL_VALUE
+                                                           + str8("bool") + TRUE_VALUE
+                                                           + str8("ulong") + smallulong(200)
+                                                           + str8("string") + str8("abc"), 12) + data("x"));
+    BOOST_CHECK_EQUAL(m.getProperty("int"), Variant(int32_t(-5)));
+    BOOST_CHECK_EQUAL(m.getProperty("bool"), Variant(true));
+    BOOST_CHECK_EQUAL(m.getProperty("ulong"), Variant(uint64_t(200)));
+    BOOST_CHECK_EQUAL(m.getProperty("string").asString(), string("abc"));
+    BOOST_CHECK_EQUAL(m.getPropertyAsString("int"), string("-5"));
+    BOOST_CHECK(m.getProperty("null").isVoid());
+    BOOST_CHECK(m.getProperty("missing").isVoid());
+}
+
+QPID_AUTO_TEST_CASE(testMixedTypeKeys)
+{
+    // A key that is not a string cannot be indexed; lookups then decode
+    // the whole section as they did before there was an index. That
+    // finds the entries ahead of the bad key, but pairs each later key
+    // with the entry after it, taking "int key" as a key and "bee" as a
+    // key with no value.
+    qpid::broker::Message m = create(applicationProperties(str8("a") + smallint(1)
+                                                           + smallint(2) + str8("int key")
+                                                           + str8("b") + str8("bee"), 6) + data("x"));
+    BOOST_CHECK_EQUAL(m.getProperty("a"), Variant(int32_t(1)));
+    BOOST_CHECK_EQUAL(m.getPropertyAsString("a"), string("1"));
+    BOOST_CHECK(m.getProperty("2").isVoid());
+    BOOST_CHECK_EQUAL(m.getProperty("int key").asString(), string("b"));
+    BOOST_CHECK(m.getProperty("b").isVoid());
+    BOOST_CHECK(m.getProperty("bee").isVoid());
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
@@ -0,0 +1,140 @@
+#ifndef TESTS_BENCHUTILS_H
+#define TESTS_BENCHUTILS_H
+
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/Options.h"
+#include "qpid/sys/Time.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace qpid {
+namespace tests {
+
+/** Options common to the microbenchmarks */
+struct BenchOptions : public qpid::Options
+{
+    bool help;
+    uint32_t count;
+    uint32_t iterations;
+
+    BenchOptions(uint32_t defaultCount) : help(false), count(defaultCount), iterations(1)
+    {
+        addOptions()
+            ("help", optValue(help), "Print this usage statement")
+            ("count", optValue(count, "N"), "Number of times each timed operation is performed")
+            ("iterations", optValue(iterations, "N"), "Number of times to repeat the measurements");
+    }
+};
+
+/** @return the mean time in nanoseconds of count operations begun at start */
+inline double nsPerOp(qpid::sys::AbsTime start, uint64_t count)
+{
+    return double(qpid::sys::Duration(start, qpid::sys::AbsTime::now())) / count;
+}
+
+/**
+ * Builds the JSON object a benchmark prints on a single line for each
+ * run, so that results can be collected for regression tracking.
+ */
+class JsonLine
+{
+  public:
+    JsonLine() : first(true) { out << "{"; }
+
+    template <class T> JsonLine& add(const std::string& name, const T& value)
+    {
+        key(name);
+        out << value;
+        return *this;
+    }
+    JsonLine& add(const std::string& name, const std::string& value)
+    {
+        key(name);
+        out << "\"" << value << "\"";
+        return *this;
+    }
+    JsonLine& add(const std::string& name, const char* value) { return add(name, std::string(value)); }
+    JsonLine& add(const std::string& name, bool value)
+    {
+        key(name);
+        out << (value ? "true" : "false");
+        return *this;
+    }
+
+    /** Starts a nested object; the following values are added to it until end() */
+    JsonLine& begin(const std::string& name)
+    {
+        key(name);
+        out << "{";
+        first = true;
+        return *this;
+    }
+    JsonLine& end()
+    {
+        out << "}";
+        first = false;
+        return *this;
+    }
+
+    void print(std::ostream& o = std::cout) { o << out.str() << "}" << std::endl; }
+
+  private:
+    std::ostringstream out;
+    bool first;
+
+    void key(const std::string& name)
+    {
+        if (!first) out << ", ";
+        first = false;
+        out << "\"" << name << "\": ";
+    }
+};
+
+/**
+ * The main() of a microbenchmark: parses the command line into opts,
+ * then calls run(opts) once per iteration. Errors are reported on
+ * stderr under the given program name.
+ * @return the exit status
+ */
+template <class Opts> int benchMain(const char* name, int argc, char** argv, Opts& opts,
+                                    void (*run)(const Opts&))
+{
+    try {
+        opts.parse(argc, argv);
+        if (opts.help) {
+            std::cout << opts << std::endl;
+            return 0;
+        }
+        for (uint32_t i = 0; i < opts.iterations; ++i) run(opts);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << name << ": " << e.what() << std::endl;
+    }
+    return 1;
+}
+
+}} // namespace qpid::tests
+
+#endif  /*!TESTS_BENCHUTILS_H*/
@@ -658,6 +658,31 @@ QPID_AUTO_TEST_CASE(testTtl)
     BOOST_CHECK(got.getDeliveryProperties().getTtl() < ttl - (5 * ms));
 }
 
+QPID_AUTO_TEST_CASE(testVariedSizeContentIntact) {
+    // Frames of assorted sizes, sent without waiting, fill and span
+    // the chunks the connector hands to the IO layer
+    ClientSessionFixture fix;
+    fix.session.queueDeclare(arg::queue="varied", arg::exclusive=true, arg::autoDelete=true);
+    AsyncSession s = async(fix.session);
+    const size_t count = 200;
+    std::vector<std::string> sent;
+    for (size_t i = 0; i < count; ++i) {
+        std::string data((i * 7919) % 150000 + 1, 'a' + i % 26);
+        data[0] = 'A' + i % 26;
+        data[data.size()-1] = 'z' - i % 26;
+        sent.push_back(data);
+        s.messageTransfer(arg::content=Message(data, "varied"));
+    }
+    s.sync();
+    LocalQueue lq;
+    fix.subs.subscribe(lq, "varied");
+    for (size_t i = 0; i < count; ++i) {
+        Message got;
+        BOOST_REQUIRE(lq.get(got, 5*TIME_SEC));
+        BOOST_CHECK(got.getData() == sent[i]);
+    }
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
@@ -0,0 +1,165 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/messaging/amqp/CreditWindow.h"
+#include "unit_test.h"
+
+using qpid::messaging::amqp::CreditWindow;
+using namespace qpid::sys;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(CreditWindowTestSuite)
+
+namespace {
+/**
+ * Takes count messages of the given size, step apart, from a link
+ * on which every message is delivered as soon as it has credit, so
+ * that nothing is left queued.
+ * @return the credit issued
+ */
+uint32_t take(CreditWindow& window, uint32_t& credit, AbsTime& now, uint32_t count,
+              Duration step = Duration(TIME_MSEC), size_t size = 100)
+{
+    uint32_t issued = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        now = AbsTime(now, step);
+        if (credit) --credit;
+        uint32_t more = window.taken(size, credit, 0, now);
+        credit += more;
+        issued += more;
+    }
+    return issued;
+}
+}
+
+QPID_AUTO_TEST_CASE(testInitialWindow)
+{
+    CreditWindow window;
+    window.setLimits(100, 0);
+    BOOST_CHECK_EQUAL(window.getWindow(), 16u);
+    window.setLimits(8, 0);
+    BOOST_CHECK_EQUAL(window.getWindow(), 8u);
+}
+
+QPID_AUTO_TEST_CASE(testCreditReplacedEveryHalfWindow)
+{
+    CreditWindow window;
+    window.setLimits(100, 0);
+    uint32_t credit = 16;
+    AbsTime now = AbsTime::now();
+    BOOST_CHECK_EQUAL(take(window, credit, now, 7), 0u);
+    BOOST_CHECK_EQUAL(credit, 9u);
+    BOOST_CHECK_EQUAL(take(window, credit, now, 1), 8u);
+    BOOST_CHECK_EQUAL(credit, 16u);
+    BOOST_CHECK_EQUAL(window.getWindow(), 16u);
+}
+
+QPID_AUTO_TEST_CASE(testGrowsWhenStarved)
+{
+    CreditWindow window;
+    window.setLimits(100, 0);
+    uint32_t credit = 16;
+    AbsTime now = AbsTime::now();
+    take(window, credit, now, 7);
+    window.starved();
+    BOOST_CHECK_EQUAL(take(window, credit, now, 1), 24u);
+    BOOST_CHECK_EQUAL(window.getWindow(), 32u);
+    take(window, credit, now, 15);
+    window.starved();
+    take(window, credit, now, 1);
+    BOOST_CHECK_EQUAL(window.getWindow(), 64u);
+    take(window, credit, now, 31);
+    window.starved();
+    take(window, credit, now, 1);
+    BOOST_CHECK_EQUAL(window.getWindow(), 100u);
+}
+
+QPID_AUTO_TEST_CASE(testShrinksWhenLeftQueued)
+{
+    CreditWindow window;
+    window.setLimits(100, 0);
+    AbsTime now = AbsTime::now();
+    for (uint32_t i = 0; i < 7; ++i) BOOST_CHECK_EQUAL(window.taken(100, 0, 9, now), 0u);
+    BOOST_CHECK_EQUAL(window.taken(100, 0, 9, now), 3u);
+    BOOST_CHECK_EQUAL(window.getWindow(), 12u);
+}
+
+QPID_AUTO_TEST_CASE(testByteBudget)
+{
+    CreditWindow window;
+    window.setLimits(100, 10*1024);
+    uint32_t credit = 16;
+    AbsTime now = AbsTime::now();
+    take(window, credit, now, 7, Duration(TIME_MSEC), 1024);
+    window.starved();
+    take(window, credit, now, 1, Duration(TIME_MSEC), 1024);
+    BOOST_CHECK_EQUAL(window.getWindow(), 10u);
+}
+
+QPID_AUTO_TEST_CASE(testSizedByRateAndRoundTrip)
+{
+    CreditWindow window;
+    window.setLimits(1000, 0);
+    AbsTime now = AbsTime::now();
+    uint32_t credit = 0;
+    //the first review finds no credit outstanding, so the next
+    //message taken gives a round trip
+    take(window, credit, now, 8);
+    BOOST_CHECK_EQUAL(credit, 16u);
+    take(window, credit, now, 1, Duration(10*TIME_MSEC));
+    BOOST_CHECK_EQUAL(int64_t(window.getRoundTrip()), int64_t(10*TIME_MSEC));
+    //consuming a message every millisecond, the window settles at
+    //twice the messages consumed in a round trip
+    take(window, credit, now, 200);
+    BOOST_CHECK_CLOSE(window.getRate(), 1000.0, 1.0);
+    BOOST_CHECK_EQUAL(window.getWindow(), 20u);
+    //a slower consumer needs a smaller window
+    take(window, credit, now, 200, Duration(4*TIME_MSEC));
+    BOOST_CHECK_EQUAL(window.getWindow(), 5u);
+}
+
+QPID_AUTO_TEST_CASE(testRoundTripFavoursLowSamples)
+{
+    CreditWindow window;
+    window.setLimits(1000, 0);
+    AbsTime now = AbsTime::now();
+    uint32_t credit = 0;
+    take(window, credit, now, 8);
+    take(window, credit, now, 1, Duration(10*TIME_MSEC));
+    BOOST_CHECK_EQUAL(int64_t(window.getRoundTrip()), int64_t(10*TIME_MSEC));
+    //a high sample (e.g. the sender was idle) moves it an eighth of the way
+    take(window, credit, now, 6);
+    credit = 0;
+    take(window, credit, now, 1);
+    take(window, credit, now, 1, Duration(90*TIME_MSEC));
+    BOOST_CHECK_EQUAL(int64_t(window.getRoundTrip()), int64_t(20*TIME_MSEC));
+    //a low one is taken as is
+    take(window, credit, now, window.getWindow() / 2 - 2);
+    credit = 0;
+    take(window, credit, now, 1);
+    take(window, credit, now, 1, Duration(2*TIME_MSEC));
+    BOOST_CHECK_EQUAL(int64_t(window.getRoundTrip()), int64_t(2*TIME_MSEC));
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
@@ -20,7 +20,9 @@
  *
  */
 #include "qpid/broker/DeliveryRecord.h"
+#include "qpid/broker/DtxAck.h"
 #include "qpid/broker/Queue.h"
+#include "qpid/broker/TxAccept.h"
 #include "unit_test.h"
 #include <iostream>
 #include <memory>
@@ -61,6 +63,96 @@ QPID_AUTO_TEST_CASE(testSort)
     }
 }
 
+QPID_AUTO_TEST_CASE(testFindRange)
+{
+    DeliveryRecords records;
+    for (uint32_t i = 1; i <= 9; i += 2) {
+        DeliveryRecord r(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), "tag", Consumer::shared_ptr(), false, false, false);
+        r.setId(SequenceNumber(i));
+        records.push_back(r);
+    }
+    // Queue = 1, 3, 5, 7, 9
+    AckRange range = DeliveryRecord::findRange(records, SequenceNumber(2), SequenceNumber(7));
+    BOOST_CHECK(range.start->getId() == SequenceNumber(3));
+    BOOST_CHECK_EQUAL(range.end - range.start, 3);
+
+    range = DeliveryRecord::findRange(records, SequenceNumber(9), SequenceNumber(12));
+    BOOST_CHECK_EQUAL(range.end - range.start, 1);
+
+    range = DeliveryRecord::findRange(records, SequenceNumber(4), SequenceNumber(4));
+    BOOST_CHECK(range.start == range.end);
+}
+
+QPID_AUTO_TEST_CASE(testSharedContext)
+{
+    Queue::shared_ptr queue(new Queue("my-queue"));
+    DeliveryRecord::Context::shared_ptr context(new DeliveryRecord::Context(queue, "tag", Consumer::shared_ptr()));
+    DeliveryRecord a(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), context, false, false, false);
+    DeliveryRecord b(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), context, false, false, false);
+    BOOST_CHECK_EQUAL(context.use_count(), 3);
+    BOOST_CHECK_EQUAL(a.getQueue(), queue);
+    BOOST_CHECK_EQUAL(b.getTag(), std::string("tag"));
+
+    b.cancel("other");
+    BOOST_CHECK(!b.isCancelled());
+    b.cancel("tag");
+    BOOST_CHECK(b.isCancelled());
+    BOOST_CHECK(!a.isCancelled());
+}
+
+namespace {
+DeliveryRecords window(uint32_t size)
+{
+    DeliveryRecords records;
+    for (uint32_t i = 1; i <= size; ++i) {
+        DeliveryRecord r(QueueCursor(CONSUMER), framing::SequenceNumber(), SequenceNumber(), Queue::shared_ptr(), "tag", Consumer::shared_ptr(), false, false, false);
+        r.setId(SequenceNumber(i));
+        records.push_back(r);
+    }
+    return records;
+}
+}
+
+QPID_AUTO_TEST_CASE(testAcceptSubRange)
+{
+    // Accepting part of a large window must remove exactly the
+    // accepted records and leave those either side of it alone
+    DeliveryRecords records = window(10000);
+    SequenceSet accepted;
+    accepted.add(SequenceNumber(5000), SequenceNumber(5009));
+    accepted.add(SequenceNumber(5020));
+
+    TxAccept tx(accepted, records);
+    BOOST_CHECK(tx.prepare(0));
+    tx.commit();
+
+    BOOST_CHECK_EQUAL(records.size(), 10000u - 11u);
+    SequenceNumber expected(0);
+    for (DeliveryRecords::iterator i = records.begin(); i != records.end(); ++i) {
+        ++expected;
+        while (accepted.contains(expected)) ++expected;
+        BOOST_CHECK_EQUAL(i->getId(), expected);
+        BOOST_CHECK(!i->isEnded());
+    }
+    BOOST_CHECK_EQUAL(expected, SequenceNumber(10000));
+}
+
+QPID_AUTO_TEST_CASE(testDtxAckCopiesOnlyAcceptedRecords)
+{
+    DeliveryRecords records = window(10000);
+    SequenceSet accepted;
+    accepted.add(SequenceNumber(1));
+    accepted.add(SequenceNumber(7000), SequenceNumber(7002));
+
+    DtxAck ack(accepted, records);
+    BOOST_CHECK_EQUAL(ack.getPending().size(), 4u);
+    SequenceSet pending;
+    for (DeliveryRecords::const_iterator i = ack.getPending().begin(); i != ack.getPending().end(); ++i) {
+        pending.add(i->getId());
+    }
+    BOOST_CHECK(pending == accepted);
+    BOOST_CHECK_EQUAL(records.size(), 10000u);
+}
 
 QPID_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,109 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+#include "qpid/messaging/amqp/DriverImpl.h"
+#include "qpid/messaging/amqp/Transport.h"
+#include "qpid/messaging/amqp/TransportContext.h"
+#include "qpid/messaging/exceptions.h"
+#include "qpid/sys/Codec.h"
+#include "unit_test.h"
+
+using qpid::messaging::amqp::DriverImpl;
+using qpid::messaging::amqp::Transport;
+using qpid::messaging::amqp::TransportContext;
+using boost::shared_ptr;
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(DriverImplTestSuite)
+
+namespace {
+const std::string TEST_PROTOCOL("driver-test");
+
+class NullTransport : public Transport
+{
+  public:
+    void connect(const std::string&, const std::string&) {}
+    void close() {}
+    void abort() {}
+    const qpid::sys::SecuritySettings* getSecuritySettings() { return 0; }
+    void connectionEstablished() {}
+    void activateOutput() {}
+
+    static Transport* create(TransportContext&, shared_ptr<qpid::sys::Poller>) { return new NullTransport(); }
+};
+
+class NullContext : public TransportContext, public qpid::sys::Codec
+{
+  public:
+    qpid::sys::Codec& getCodec() { return *this; }
+    const qpid::messaging::ConnectionOptions* getOptions() { return 0; }
+    void closed() {}
+    void opened() {}
+    size_t decode(const char*, size_t) { return 0; }
+    size_t encode(char*, size_t) { return 0; }
+    bool canEncode() { return false; }
+};
+
+struct Registration
+{
+    Registration() { Transport::add(TEST_PROTOCOL, &NullTransport::create); }
+} registration;
+}
+
+QPID_AUTO_TEST_CASE(testThreadPerTransportUpToMax)
+{
+    DriverImpl driver(3);
+    NullContext context;
+    BOOST_CHECK_EQUAL(driver.getThreadCount(), 1u);
+    std::vector<shared_ptr<Transport> > transports;
+    for (size_t i = 0; i < 5; ++i) {
+        transports.push_back(driver.getTransport(TEST_PROTOCOL, context));
+        BOOST_CHECK_EQUAL(driver.getThreadCount(), std::min<size_t>(i + 1, 3));
+    }
+    transports.clear();
+}
+
+QPID_AUTO_TEST_CASE(testReleasedTransportsNotCounted)
+{
+    DriverImpl driver(4);
+    NullContext context;
+    shared_ptr<Transport> held = driver.getTransport(TEST_PROTOCOL, context);
+    for (size_t i = 0; i < 10; ++i) {
+        shared_ptr<Transport> t = driver.getTransport(TEST_PROTOCOL, context);
+    }
+    // Only two transports were ever in use at once
+    BOOST_CHECK_EQUAL(driver.getThreadCount(), 2u);
+    held.reset();
+}
+
+QPID_AUTO_TEST_CASE(testUnknownTransportNotCounted)
+{
+    DriverImpl driver(4);
+    NullContext context;
+    BOOST_CHECK_THROW(driver.getTransport("no-such-protocol", context), qpid::messaging::ConnectionError);
+    shared_ptr<Transport> t = driver.getTransport(TEST_PROTOCOL, context);
+    BOOST_CHECK_EQUAL(driver.getThreadCount(), 1u);
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
@@ -24,6 +24,7 @@
 #include "qpid/framing/FieldTable.h"
 #include "qpid/framing/FieldValue.h"
 #include "qpid/framing/List.h"
+#include "qpid/framing/Uuid.h"
 
 #include "unit_test.h"
 
@@ -210,6 +211,86 @@ QPID_AUTO_TEST_CASE(test64GetAndSetConverts)
 
 }
 
+QPID_AUTO_TEST_CASE(testLookupBeforeDecode)
+{
+    FieldTable nested;
+    nested.setString("x", "y");
+    List list;
+    list.push_back(List::ValuePtr(new Str16Value("item")));
+    FieldTable a;
+    a.setString("string", "abc");
+    a.setInt("int", 42);
+    a.setTable("table", nested);
+    a.set("list", FieldTable::ValuePtr(new ListValue(list)));
+    a.setDouble("double", 1.5);
+    a.set("uuid", FieldTable::ValuePtr(new UuidValue(Uuid(true).data())));
+    a.setInt64("z", 7);
+
+    char buff[500];
+    Buffer wbuffer(buff, sizeof(buff));
+    wbuffer.put(a);
+    Buffer rbuffer(buff, sizeof(buff));
+    FieldTable b;
+    rbuffer.get(b);
+
+    // Single values are found in the raw bytes, skipping the others
+    BOOST_CHECK_EQUAL(string("abc"), b.getAsString("string"));
+    BOOST_CHECK_EQUAL(42, b.getAsInt("int"));
+    BOOST_CHECK_EQUAL(7, b.getAsInt64("z"));
+    FieldTable t;
+    BOOST_CHECK(b.getTable("table", t));
+    BOOST_CHECK_EQUAL(string("y"), t.getAsString("x"));
+    BOOST_CHECK(!b.isSet("missing"));
+    BOOST_CHECK(!b.isSet("strin"));
+    BOOST_CHECK_EQUAL(7u, b.size());
+    double d;
+    BOOST_CHECK(b.getDouble("double", d));
+    BOOST_CHECK_EQUAL(1.5, d);
+    BOOST_CHECK_EQUAL(*a.get("uuid"), *b.get("uuid"));
+}
+
+QPID_AUTO_TEST_CASE(testUnorderedEncoding)
+{
+    // Encode names out of order and with a duplicate, as a peer might
+    const char* names[] = { "c", "a", "b", "a" };
+    char buff[100];
+    Buffer wbuffer(buff, sizeof(buff));
+    wbuffer.putLong(0);
+    wbuffer.putLong(4);
+    for (int i = 0; i < 4; ++i) {
+        wbuffer.putShortString(names[i]);
+        IntegerValue(i).encode(wbuffer);
+    }
+    uint32_t size = wbuffer.getPosition();
+    wbuffer.setPosition(0);
+    wbuffer.putLong(size - 4);
+
+    Buffer rbuffer(buff, size);
+    FieldTable ft;
+    rbuffer.get(ft);
+    BOOST_CHECK_EQUAL(3, ft.getAsInt("a"));
+    BOOST_CHECK_EQUAL(2, ft.getAsInt("b"));
+    BOOST_CHECK_EQUAL(0, ft.getAsInt("c"));
+
+    FieldTable::const_iterator i = ft.begin();
+    BOOST_CHECK_EQUAL(3u, ft.size());
+    BOOST_CHECK_EQUAL(string("a"), i->first);
+    BOOST_CHECK_EQUAL(3, i->second->get<int>());
+    BOOST_CHECK_EQUAL(string("b"), (++i)->first);
+    BOOST_CHECK_EQUAL(string("c"), (++i)->first);
+    BOOST_CHECK(++i == ft.end());
+    BOOST_CHECK_EQUAL(3, ft.getAsInt("a"));
+
+    ft.setInt("b", 10);
+    ft.setInt("aa", 11);
+    ft.erase("c");
+    BOOST_CHECK_EQUAL(3u, ft.size());
+    BOOST_CHECK_EQUAL(string("aa"), (++ft.begin())->first);
+    BOOST_CHECK_EQUAL(10, ft.getAsInt("b"));
+    BOOST_CHECK(!ft.insert(FieldTable::value_type("a", FieldTable::ValuePtr(new IntegerValue(0)))).second);
+    BOOST_CHECK_EQUAL(3, ft.getAsInt("a"));
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
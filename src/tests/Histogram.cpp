@@ -0,0 +1,152 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "qpid/broker/ConnectionHistograms.h"
+#include "qpid/broker/Histogram.h"
+
+#include "unit_test.h"
+
+namespace qpid {
+namespace tests {
+
+QPID_AUTO_TEST_SUITE(HistogramTestSuite)
+
+using namespace qpid::broker;
+using qpid::types::Variant;
+
+QPID_AUTO_TEST_CASE(testBuckets)
+{
+    // Small values each have a bucket of their own.
+    for (uint64_t i = 0; i < Histogram::SUB_BUCKETS; ++i) {
+        BOOST_CHECK_EQUAL(i, Histogram::bucketFor(i));
+        BOOST_CHECK_EQUAL(i, Histogram::lowerBound(i));
+        BOOST_CHECK_EQUAL(i, Histogram::upperBound(i));
+    }
+    // Every value lies within the bounds of its bucket, buckets are
+    // contiguous, and a bucket is never wider than 1/SUB_BUCKETS of
+    // its lower bound.
+    uint64_t values[] = { 8, 9, 15, 16, 17, 100, 1000, 123456789, uint64_t(1) << 40,
+                          (uint64_t(1) << 63) + 12345, ~uint64_t(0) };
+    for (size_t i = 0; i < sizeof(values)/sizeof(values[0]); ++i) {
+        uint32_t b = Histogram::bucketFor(values[i]);
+        BOOST_CHECK(b < Histogram::BUCKETS);
+        BOOST_CHECK(Histogram::lowerBound(b) <= values[i]);
+        BOOST_CHECK(values[i] <= Histogram::upperBound(b));
+        BOOST_CHECK_EQUAL(Histogram::upperBound(b - 1) + 1, Histogram::lowerBound(b));
+        BOOST_CHECK((Histogram::upperBound(b) - Histogram::lowerBound(b)) <=
+                    Histogram::lowerBound(b) / Histogram::SUB_BUCKETS);
+    }
+    BOOST_CHECK_EQUAL(Histogram::BUCKETS - 1, Histogram::bucketFor(~uint64_t(0)));
+}
+
+QPID_AUTO_TEST_CASE(testRecord)
+{
+    Histogram h;
+    BOOST_CHECK_EQUAL(0u, h.getCount());
+    BOOST_CHECK_EQUAL(0u, h.getMin());
+    BOOST_CHECK_EQUAL(0u, h.getPercentile(50));
+
+    for (uint64_t i = 1; i <= 1000; ++i) h.record(i);
+    BOOST_CHECK_EQUAL(1000u, h.getCount());
+    BOOST_CHECK_EQUAL(1u, h.getMin());
+    BOOST_CHECK_EQUAL(1000u, h.getMax());
+    BOOST_CHECK_EQUAL(500500u, h.getTotal());
+
+    // Percentiles are accurate to within the bucket resolution.
+    uint64_t p50 = h.getPercentile(50);
+    BOOST_CHECK(p50 >= 500 && p50 <= 500 + 500/Histogram::SUB_BUCKETS);
+    uint64_t p99 = h.getPercentile(99);
+    BOOST_CHECK(p99 >= 990 && p99 <= 1000);
+    BOOST_CHECK_EQUAL(1000u, h.getPercentile(100));
+
+    h.reset();
+    BOOST_CHECK_EQUAL(0u, h.getCount());
+    BOOST_CHECK_EQUAL(0u, h.getMax());
+    BOOST_CHECK_EQUAL(0u, h.getPercentile(99));
+}
+
+QPID_AUTO_TEST_CASE(testAdd)
+{
+    Histogram a, b, empty;
+    for (uint64_t i = 1; i <= 500; ++i) a.record(i);
+    for (uint64_t i = 501; i <= 1000; ++i) b.record(i);
+    a.add(b);
+    a.add(empty);
+    BOOST_CHECK_EQUAL(1000u, a.getCount());
+    BOOST_CHECK_EQUAL(1u, a.getMin());
+    BOOST_CHECK_EQUAL(1000u, a.getMax());
+    BOOST_CHECK_EQUAL(500500u, a.getTotal());
+    uint64_t p50 = a.getPercentile(50);
+    BOOST_CHECK(p50 >= 500 && p50 <= 500 + 500/Histogram::SUB_BUCKETS);
+
+    empty.add(b);
+    BOOST_CHECK_EQUAL(500u, empty.getCount());
+    BOOST_CHECK_EQUAL(501u, empty.getMin());
+}
+
+QPID_AUTO_TEST_CASE(testMapEncode)
+{
+    Histogram h;
+    h.record(3);
+    h.record(3);
+    h.record(100);
+
+    Variant::Map map;
+    h.mapEncode(map);
+    BOOST_CHECK_EQUAL(3u, map["count"].asUint64());
+    BOOST_CHECK_EQUAL(3u, map["min"].asUint64());
+    BOOST_CHECK_EQUAL(100u, map["max"].asUint64());
+    BOOST_CHECK_EQUAL(35u, map["mean"].asUint64());
+    BOOST_CHECK_EQUAL(3u, map["p50"].asUint64());
+
+    Variant::List& buckets = map["buckets"].asList();
+    BOOST_REQUIRE_EQUAL(2u, buckets.size());
+    Variant::List& first = buckets.front().asList();
+    BOOST_CHECK_EQUAL(3u, first.front().asUint64());
+    BOOST_CHECK_EQUAL(2u, first.back().asUint64());
+    Variant::List& last = buckets.back().asList();
+    BOOST_CHECK(last.front().asUint64() >= 100u);
+    BOOST_CHECK_EQUAL(1u, last.back().asUint64());
+}
+
+QPID_AUTO_TEST_CASE(testConnectionHistograms)
+{
+    ConnectionHistograms h;
+    h.fromClient(10);
+    h.fromClient(20);
+    h.toClient(500);
+
+    Variant::Map map;
+    h.mapEncode(map, true);
+    BOOST_CHECK_EQUAL(2u, map["messageSizeFromClient"].asMap()["count"].asUint64());
+    BOOST_CHECK_EQUAL(20u, map["messageSizeFromClient"].asMap()["max"].asUint64());
+    BOOST_CHECK_EQUAL(1u, map["messageSizeToClient"].asMap()["count"].asUint64());
+
+    // Reading with reset leaves the histograms empty
+    Variant::Map after;
+    h.mapEncode(after, false);
+    BOOST_CHECK_EQUAL(0u, after["messageSizeFromClient"].asMap()["count"].asUint64());
+    BOOST_CHECK_EQUAL(0u, after["messageSizeToClient"].asMap()["count"].asUint64());
+}
+
+QPID_AUTO_TEST_SUITE_END()
+
+}} // namespace qpid::tests
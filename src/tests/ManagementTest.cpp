@@ -20,6 +20,7 @@
  */
 
 #include "qpid/management/ManagementObject.h"
+#include "qpid/management/PerThreadStatistics.h"
 #include "qpid/framing/Buffer.h"
 #include "unit_test.h"
 
@@ -92,6 +93,43 @@ QPID_AUTO_TEST_CASE(testObjectIdCreate) {
     BOOST_CHECK_EQUAL(oid.getV2Key(), "an-object-name");
 }
 
+QPID_AUTO_TEST_CASE(testStatisticsCounter) {
+    StatisticsCounter<uint64_t> c;
+    BOOST_CHECK_EQUAL(c.get(), 0u);
+    c += 5;
+    c -= 2;
+    ++c;
+    BOOST_CHECK_EQUAL(c.get(), 4u);
+    StatisticsCounter<uint64_t> d(c);
+    d = 10;
+    BOOST_CHECK_EQUAL(uint64_t(c) + uint64_t(d), 14u);
+}
+
+namespace {
+struct TestStats {
+    StatisticsCounter<uint64_t> a;
+    StatisticsCounter<uint32_t> b;
+};
+}
+
+QPID_AUTO_TEST_CASE(testPerThreadStatsArray) {
+    PerThreadStatsArray<TestStats> stats(4);
+    BOOST_CHECK_EQUAL(stats.size(), 4);
+    BOOST_CHECK(stats.get(0) == 0);
+
+    TestStats* first = stats.allocate(0);
+    TestStats* second = stats.allocate(1);
+    BOOST_CHECK(stats.get(0) == first);
+    BOOST_CHECK(stats.allocate(0) == first);
+    BOOST_CHECK_EQUAL(first->a.get(), 0u);
+
+    // Blocks start on a cache line and never share one.
+    const std::size_t line = STATISTICS_CACHE_LINE_SIZE;
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(first) % line, 0u);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(second) % line, 0u);
+    BOOST_CHECK(first != second);
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
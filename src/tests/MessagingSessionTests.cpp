@@ -21,12 +21,16 @@
 #include "MessagingFixture.h"
 #include "unit_test.h"
 #include "test_tools.h"
+#include "qpid/amqp/descriptors.h"
+#include "qpid/amqp/Encoder.h"
 #include "qpid/messaging/Address.h"
 #include "qpid/messaging/Connection.h"
 #include "qpid/messaging/Message.h"
 #include "qpid/messaging/Receiver.h"
 #include "qpid/messaging/Sender.h"
 #include "qpid/messaging/Session.h"
+#include "qpid/messaging/MessageImpl.h"
+#include "qpid/messaging/amqp/EncodedMessage.h"
 #include "qpid/client/Connection.h"
 #include "qpid/client/Session.h"
 #include "qpid/framing/ExchangeQueryResult.h"
@@ -76,6 +80,75 @@ QPID_AUTO_TEST_CASE(testSyncSendReceive)
     BOOST_CHECK_EQUAL(in.getContent(), out.getContent());
 }
 
+QPID_AUTO_TEST_CASE(testBatchSendFetch)
+{
+    QueueFixture fix;
+    Sender sender = fix.session.createSender(fix.queue);
+    std::vector<Message> out;
+    for (uint i = 0; i < 10; ++i) {
+        out.push_back(Message((boost::format("Message_%1%") % (i+1)).str()));
+    }
+    sender.send(out, true);
+
+    Receiver receiver = fix.session.createReceiver(fix.queue);
+    std::vector<Message> in;
+    BOOST_CHECK_EQUAL(receiver.fetch(in, 4, Duration::SECOND * 5), 4u);
+    BOOST_CHECK_EQUAL(receiver.fetch(in, 10, Duration::SECOND * 5), 6u);
+    BOOST_REQUIRE_EQUAL(in.size(), out.size());
+    for (uint i = 0; i < out.size(); ++i) {
+        BOOST_CHECK_EQUAL(in[i].getContent(), out[i].getContent());
+    }
+    BOOST_CHECK_EQUAL(receiver.fetch(in, 10, Duration::IMMEDIATE), 0u);
+    BOOST_CHECK_EQUAL(in.size(), out.size());
+    fix.session.acknowledge();
+
+    // With prefetch, only messages already available are taken once
+    // the first has arrived.
+    receiver.setCapacity(5);
+    sender.send(std::vector<Message>(out.begin(), out.begin() + 3));
+    fix.session.sync();
+    in.clear();
+    uint total = 0;
+    while (total < 3 && receiver.fetch(in, 10, Duration::SECOND * 5)) total = in.size();
+    BOOST_CHECK_EQUAL(total, 3u);
+    fix.session.acknowledge();
+}
+
+QPID_AUTO_TEST_CASE(testSwapContent)
+{
+    QueueFixture fix;
+    Sender sender = fix.session.createSender(fix.queue);
+    std::string content("test-message");
+    Message out("previous");
+    out.swapContent(content);
+    BOOST_CHECK_EQUAL(content, std::string("previous"));
+    BOOST_CHECK_EQUAL(out.getContent(), std::string("test-message"));
+    sender.send(out);
+    Receiver receiver = fix.session.createReceiver(fix.queue);
+    Message in = receiver.fetch(Duration::SECOND * 5);
+    fix.session.acknowledge();
+    BOOST_CHECK_EQUAL(std::string(in.getContentPtr(), in.getContentSize()), std::string("test-message"));
+}
+
+QPID_AUTO_TEST_CASE(testSwapReceivedContent)
+{
+    // An AMQP 1.0 message as received, with a string as its body
+    std::vector<char> data(64);
+    qpid::amqp::Encoder encoder(&data[0], data.size());
+    encoder.writeValue(Variant("received"), &qpid::amqp::message::AMQP_VALUE);
+    boost::shared_ptr<qpid::messaging::amqp::EncodedMessage> encoded(
+        new qpid::messaging::amqp::EncodedMessage(encoder.getPosition()));
+    ::memcpy(encoded->getData(), &data[0], encoder.getPosition());
+    Message in;
+    encoded->init(MessageImplAccess::get(in));
+    MessageImplAccess::get(in).setEncoded(encoded);
+
+    std::string content("replacement");
+    in.swapContent(content);
+    BOOST_CHECK_EQUAL(content, std::string("received"));
+    BOOST_CHECK_EQUAL(in.getContent(), std::string("replacement"));
+}
+
 QPID_AUTO_TEST_CASE(testSendReceiveHeaders)
 {
     QueueFixture fix;
@@ -25,8 +25,11 @@
 #include "qpid/broker/Broker.h"
 #include "qpid/broker/DeliverableMessage.h"
 #include "qpid/broker/FanOutExchange.h"
+#include "qpid/broker/MessageGroupManager.h"
+#include "qpid/broker/PriorityQueue.h"
 #include "qpid/broker/Queue.h"
 #include "qpid/broker/Deliverable.h"
+#include "qpid/broker/ExpiryIndex.h"
 #include "qpid/broker/ExchangeRegistry.h"
 #include "qpid/broker/QueueRegistry.h"
 #include "qpid/broker/NullMessageStore.h"
@@ -38,12 +41,15 @@
 #include "qpid/framing/MessageTransferBody.h"
 #include "qpid/framing/reply_exceptions.h"
 #include "qpid/broker/QueueFlowLimit.h"
+#include "qpid/broker/QueueHistograms.h"
 #include "qpid/broker/QueueSettings.h"
 #include "qpid/sys/Thread.h"
 #include "qpid/sys/Timer.h"
 
 #include <iostream>
+#include <set>
 #include <vector>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -183,6 +189,100 @@ QPID_AUTO_TEST_CASE(testLVQEmptyKey){
     BOOST_CHECK_EQUAL(q->getMessageCount(), 2u);
 }
 
+QPID_AUTO_TEST_CASE(testLVQManyUpdates){
+
+    QueueSettings settings;
+    string key="key";
+    settings.lvqKey = key;
+    QueueFactory factory;
+    Queue::shared_ptr q(factory.create("my-queue", settings));
+
+    // The oldest message is never replaced, so the displaced ones
+    // behind it build up until they are compacted away
+    qpid::types::Variant::Map pinned;
+    pinned[key] = "pinned";
+    q->deliver(MessageUtils::createMessage(pinned, "pinned"));
+    const uint keys = 100;
+    const uint rounds = 50;
+    for (uint i = 0; i < keys * rounds; ++i) {
+        qpid::types::Variant::Map properties;
+        properties[key] = boost::lexical_cast<string>(i % keys);
+        q->deliver(MessageUtils::createMessage(properties, boost::lexical_cast<string>(i)));
+    }
+    BOOST_CHECK_EQUAL(q->getMessageCount(), keys + 1);
+
+    // A browser sees the latest value for each key, in the order sent
+    TestConsumer::shared_ptr browser(new TestConsumer("browser", false));
+    BOOST_CHECK(q->dispatch(browser));
+    BOOST_CHECK_EQUAL(std::string("pinned"), browser->lastMessage.getContent());
+    for (uint i = keys * (rounds - 1); i < keys * rounds; ++i) {
+        BOOST_CHECK(q->dispatch(browser));
+        BOOST_CHECK_EQUAL(boost::lexical_cast<string>(i), browser->lastMessage.getContent());
+    }
+    BOOST_CHECK(!q->dispatch(browser));
+
+    // Consume and remove half of them, the rest are still found
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    for (uint i = 0; i <= keys / 2; ++i) {
+        BOOST_CHECK(q->dispatch(c));
+        q->dequeue(0, c->lastCursor);
+    }
+    BOOST_CHECK_EQUAL(q->getMessageCount(), keys / 2);
+    for (uint i = keys * rounds - keys / 2; i < keys * rounds; ++i) {
+        BOOST_CHECK(q->dispatch(c));
+        BOOST_CHECK_EQUAL(boost::lexical_cast<string>(i), c->lastMessage.getContent());
+    }
+    BOOST_CHECK(!q->dispatch(c));
+}
+
+QPID_AUTO_TEST_CASE(testLVQCompactionKeepsAcquired){
+
+    QueueSettings settings;
+    string key="key";
+    settings.lvqKey = key;
+    QueueFactory factory;
+    Queue::shared_ptr q(factory.create("my-queue", settings));
+
+    qpid::types::Variant::Map pinned;
+    pinned[key] = "pinned";
+    q->deliver(MessageUtils::createMessage(pinned, "pinned"));
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    BOOST_CHECK(q->dispatch(c));
+    QueueCursor acquired = c->lastCursor;
+
+    // Displaced messages build up behind the acquired one and are
+    // compacted away, moving the live messages between slots
+    const uint keys = 10;
+    const uint rounds = 500;
+    for (uint i = 0; i < keys * rounds; ++i) {
+        qpid::types::Variant::Map properties;
+        properties[key] = boost::lexical_cast<string>(i % keys);
+        q->deliver(MessageUtils::createMessage(properties, boost::lexical_cast<string>(i)));
+    }
+    BOOST_CHECK_EQUAL(q->getMessageCount(), keys);
+
+    // Each key is replaced once more, so every slot in the index must
+    // still hold the current message for its key
+    for (uint i = 0; i < keys; ++i) {
+        qpid::types::Variant::Map properties;
+        properties[key] = boost::lexical_cast<string>(i);
+        q->deliver(MessageUtils::createMessage(properties, "last-" + boost::lexical_cast<string>(i)));
+    }
+    BOOST_CHECK_EQUAL(q->getMessageCount(), keys);
+
+    // The acquired message is still found by its position
+    q->release(acquired);
+    BOOST_CHECK_EQUAL(q->getMessageCount(), keys + 1);
+    TestConsumer::shared_ptr browser(new TestConsumer("browser", false));
+    BOOST_CHECK(q->dispatch(browser));
+    BOOST_CHECK_EQUAL(std::string("pinned"), browser->lastMessage.getContent());
+    for (uint i = 0; i < keys; ++i) {
+        BOOST_CHECK(q->dispatch(browser));
+        BOOST_CHECK_EQUAL("last-" + boost::lexical_cast<string>(i), browser->lastMessage.getContent());
+    }
+    BOOST_CHECK(!q->dispatch(browser));
+}
+
 void addMessagesToQueue(uint count, Queue& queue, uint oddTtl = 200, uint evenTtl = 0)
 {
     for (uint i = 0; i < count; i++) {
@@ -200,6 +300,166 @@ QPID_AUTO_TEST_CASE(testPurgeExpired) {
     BOOST_CHECK_EQUAL(queue.getMessageCount(), 5u);
 }
 
+QPID_AUTO_TEST_CASE(testPurgeExpiredReleased) {
+    Queue::shared_ptr queue(new Queue("my-queue"));
+    addMessagesToQueue(2, *queue, 0, 200);
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    BOOST_CHECK(queue->dispatch(c));
+    ::usleep(300*1000);
+    // Acquired messages are left to their consumer...
+    queue->purgeExpired(0);
+    queue->release(c->lastCursor);
+    BOOST_CHECK_EQUAL(queue->getMessageCount(), 2u);
+    // ...but expire once released
+    queue->purgeExpired(0);
+    BOOST_CHECK_EQUAL(queue->getMessageCount(), 1u);
+    BOOST_CHECK(queue->dispatch(c));
+    BOOST_CHECK_EQUAL(2u, c->lastMessage.getSequence());
+}
+
+bool isHeld(const std::set<SequenceNumber>* held, SequenceNumber position)
+{
+    return held->find(position) != held->end();
+}
+
+QPID_AUTO_TEST_CASE(testExpiryIndexBounded) {
+    // Messages are consumed, and some released and consumed again, long
+    // before they expire; the index must not keep an entry for each
+    ExpiryIndex index;
+    std::set<SequenceNumber> held;
+    ExpiryIndex::Predicate p(boost::bind(&isHeld, &held, _1));
+    Message m = MessageUtils::createMessage("exchange", "key", 60*1000);
+    size_t largest(0);
+    for (uint i = 1; i <= 10000; ++i) {
+        m.setSequence(i);
+        held.insert(i);
+        index.add(m, p);
+        if (i % 3 == 0) index.add(m, p);//as if released
+        if (i > 10) held.erase(i - 10);
+        largest = std::max(largest, index.size());
+    }
+    BOOST_CHECK(largest <= 128u);
+    // Only the entries for messages still held remain once compacted
+    std::set<SequenceNumber> none;
+    for (uint i = 0; i < 128; ++i) index.add(m, boost::bind(&isHeld, &none, _1));
+    BOOST_CHECK(index.size() <= 128u);
+}
+
+QPID_AUTO_TEST_CASE(testMoveAndPurgeMany) {
+    // Enough messages that removal is done over several slices
+    const uint count = 2500;
+    Queue::shared_ptr q(new Queue("my-queue"));
+    Queue::shared_ptr q2(new Queue("my-queue-2"));
+    Exchange::shared_ptr exchange(new FanOutExchange("my-exchange"));
+    exchange->bind(q, "", 0);
+    for (uint i = 0; i < count; ++i) {
+        Message m = MessageUtils::createMessage(qpid::types::Variant::Map(), boost::lexical_cast<string>(i));
+        q->deliver(m);
+    }
+
+    // Re-routing back onto the same queue must not revisit those messages
+    BOOST_CHECK_EQUAL(q->purge(0, exchange), count);
+    BOOST_CHECK_EQUAL(q->getMessageCount(), count);
+
+    BOOST_CHECK_EQUAL(q->move(q2, count - 500), count - 500);
+    BOOST_CHECK_EQUAL(q->getMessageCount(), 500u);
+    BOOST_CHECK_EQUAL(q2->getMessageCount(), count - 500);
+    BOOST_CHECK_EQUAL(q2->move(q, 0), count - 500);
+
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    for (uint i = 0; i < count; ++i) {
+        BOOST_CHECK(q->dispatch(c));
+        BOOST_CHECK_EQUAL(boost::lexical_cast<string>((i + count - 500) % count), c->lastMessage.getContent());
+    }
+    BOOST_CHECK(!q->dispatch(c));
+}
+
+namespace {
+// Holds up the timer thread until released
+class BlockingTask : public TimerTask
+{
+  public:
+    BlockingTask() : TimerTask(Duration(0), "BlockingTask"), firing(false), released(false) {}
+    void fire()
+    {
+        Monitor::ScopedLock l(lock);
+        firing = true;
+        lock.notifyAll();
+        while (!released) lock.wait();
+    }
+    void waitUntilFiring()
+    {
+        Monitor::ScopedLock l(lock);
+        while (!firing) lock.wait();
+    }
+    void release()
+    {
+        Monitor::ScopedLock l(lock);
+        released = true;
+        lock.notifyAll();
+    }
+  private:
+    Monitor lock;
+    bool firing;
+    bool released;
+};
+
+// Waits for a background removal to finish, which cancelRemoval() reports
+bool removalFinished(Queue& q)
+{
+    for (int i = 0; i < 500; ++i) {
+        if (!q.cancelRemoval()) return true;
+        ::usleep(10*1000);
+    }
+    return false;
+}
+}
+
+QPID_AUTO_TEST_CASE(testPurgeInBackground) {
+    const uint count = 2500;
+    Timer timer;
+    Queue::shared_ptr q(new Queue("my-queue"));
+    Queue::shared_ptr q2(new Queue("my-queue-2"));
+    for (uint i = 0; i < count; ++i) {
+        Message m = MessageUtils::createMessage(qpid::types::Variant::Map(), boost::lexical_cast<string>(i));
+        q->deliver(m);
+    }
+
+    BOOST_CHECK(q->moveInBackground(timer, q2, 2000));
+    for (int i = 0; i < 500 && q2->getMessageCount() < 2000u; ++i) ::usleep(10*1000);
+    BOOST_CHECK_EQUAL(q->getMessageCount(), 500u);
+    BOOST_CHECK_EQUAL(q2->getMessageCount(), 2000u);
+
+    // The task clears itself from the queue just after the last slice
+    for (int i = 0; i < 500 && !q2->purgeInBackground(timer, 0); ++i) ::usleep(10*1000);
+    for (int i = 0; i < 500 && q2->getMessageCount(); ++i) ::usleep(10*1000);
+    BOOST_CHECK_EQUAL(q2->getMessageCount(), 0u);
+    BOOST_CHECK(removalFinished(*q2));
+}
+
+QPID_AUTO_TEST_CASE(testCancelPurgeInBackground) {
+    const uint count = 2500;
+    Timer timer;
+    Queue::shared_ptr q(new Queue("my-queue"));
+    for (uint i = 0; i < count; ++i) {
+        Message m = MessageUtils::createMessage(qpid::types::Variant::Map(), boost::lexical_cast<string>(i));
+        q->deliver(m);
+    }
+    BOOST_CHECK(!q->cancelRemoval());
+
+    boost::intrusive_ptr<BlockingTask> blocker(new BlockingTask);
+    timer.add(blocker);
+    blocker->waitUntilFiring();
+    BOOST_CHECK(q->purgeInBackground(timer, 0));
+    // Only one background removal at a time
+    BOOST_CHECK(!q->purgeInBackground(timer, 0));
+    BOOST_CHECK(q->cancelRemoval());
+    blocker->release();
+
+    BOOST_CHECK(removalFinished(*q));
+    BOOST_CHECK_EQUAL(q->getMessageCount(), count);
+}
+
 QPID_AUTO_TEST_CASE(testQueueCleaner) {
     boost::shared_ptr<Poller> poller(new Poller);
     Thread runner(poller.get());
@@ -500,6 +760,141 @@ QPID_AUTO_TEST_CASE(testGroupsMultiConsumerDefaults) {
     queue->cancel(c2);
 }
 
+QPID_AUTO_TEST_CASE(testGroupsManyGroups) {
+    //
+    // Verify that consumers are handed the oldest message they can acquire
+    // when a large owned group blocks the head of the queue
+    //
+    QueueSettings settings;
+    settings.shareGroups = 1;
+    settings.groupKey = "GROUP-ID";
+    QueueFactory factory;
+    Queue::shared_ptr queue(factory.create("my_queue", settings));
+
+    const int blocked = 1000;
+    const int singles = 1000;
+    for (int i = 0; i < blocked; ++i) {
+        queue->deliver(createGroupMessage(i, "big"));
+    }
+    for (int i = blocked; i < blocked + singles; ++i) {
+        queue->deliver(createGroupMessage(i, boost::lexical_cast<std::string>(i)));
+    }
+
+    TestConsumer::shared_ptr c1(new TestConsumer("C1"));
+    TestConsumer::shared_ptr c2(new TestConsumer("C2"));
+    queue->consume(c1);
+    queue->consume(c2);
+
+    std::deque<QueueCursor> dequeMeC1;
+    std::deque<QueueCursor> dequeMeC2;
+
+    verifyAcquire(queue, c1, dequeMeC1, "big", 0 );  // c1 now owns group "big"
+
+    // c2 skips the whole of the "big" group, then takes each free group in turn
+    for (int i = blocked; i < blocked + singles; ++i) {
+        verifyAcquire(queue, c2, dequeMeC2, boost::lexical_cast<std::string>(i), i );
+    }
+    BOOST_CHECK( !queue->dispatch(c2) );
+
+    verifyAcquire(queue, c1, dequeMeC1, "big", 1 );
+
+    qpid::types::Variant::Map status;
+    queue->query(status);
+    qpid::types::Variant::List groups =
+        status["qpid.message_group_queue"].asMap()["group_state"].asList();
+    BOOST_CHECK_EQUAL(groups.size(), size_t(1 + singles));
+    for (qpid::types::Variant::List::iterator i = groups.begin(); i != groups.end(); ++i) {
+        qpid::types::Variant::Map& info = i->asMap();
+        BOOST_CHECK_EQUAL(info["consumer"].asString(),
+                          info["group_id"].asString() == "big" ? "C1" : "C2");
+    }
+
+    // completing c2's messages releases and deletes its groups
+    while (!dequeMeC2.empty()) {
+        queue->dequeue(0, dequeMeC2.front());
+        dequeMeC2.pop_front();
+    }
+    BOOST_CHECK( !queue->dispatch(c2) );
+
+    // requeueing c1's messages frees "big", so c2 starts again from its oldest message
+    queue->release(dequeMeC1.back());
+    dequeMeC1.pop_back();
+    queue->release(dequeMeC1.back());
+    dequeMeC1.pop_back();
+    verifyAcquire(queue, c2, dequeMeC2, "big", 0 );
+    verifyAcquire(queue, c2, dequeMeC2, "big", 1 );
+    BOOST_CHECK( !queue->dispatch(c1) );
+
+    // removing the oldest messages of a free group leaves it ready at the next
+    queue->release(dequeMeC2.back());
+    queue->release(dequeMeC2.front());
+    dequeMeC2.clear();
+    BOOST_CHECK_EQUAL(queue->purge(2), uint32_t(2));
+    verifyAcquire(queue, c1, dequeMeC1, "big", 2 );
+    BOOST_CHECK_EQUAL(queue->getMessageCount(), uint32_t(blocked - 3));
+
+    queue->cancel(c1);
+    queue->cancel(c2);
+}
+
+namespace {
+// QueueFactory refuses a group key on a priority queue, but nothing stops
+// a queue being assembled from those parts
+class GroupedPriorityQueue : public Queue
+{
+  public:
+    GroupedPriorityQueue(const std::string& name, const QueueSettings& settings) : Queue(name, settings)
+    {
+        messages.reset(new PriorityQueue(settings.priorities));
+        boost::shared_ptr<MessageGroupManager> groups(MessageGroupManager::create(name, *messages, settings));
+        allocator = groups;
+        getObservers().add(groups);
+    }
+};
+}
+
+QPID_AUTO_TEST_CASE(testGroupsWithPriorities) {
+    //
+    // Verify that consumers of a queue with both groups and priorities are
+    // handed the highest priority message they can acquire, not the oldest
+    //
+    QueueSettings settings;
+    settings.shareGroups = 1;
+    settings.groupKey = "GROUP-ID";
+    settings.priorities = 10;
+    QueueFactory factory;
+    BOOST_CHECK_THROW(factory.create("my_queue", settings), qpid::framing::InvalidArgumentException);
+    Queue::shared_ptr queue(new GroupedPriorityQueue("my_queue", settings));
+
+    std::string groups[] = { std::string("a"), std::string("b"), std::string("a"), std::string("c") };
+    int priorities[] = { 0, 9, 5, 1 };
+    for (int i = 0; i < 4; ++i) {
+        qpid::types::Variant::Map properties;
+        properties["GROUP-ID"] = groups[i];
+        properties["MY-ID"] = i;
+        properties["priority"] = priorities[i];
+        queue->deliver(MessageUtils::createMessage(properties));
+    }
+
+    TestConsumer::shared_ptr c1(new TestConsumer("C1"));
+    TestConsumer::shared_ptr c2(new TestConsumer("C2"));
+    queue->consume(c1);
+    queue->consume(c2);
+
+    std::deque<QueueCursor> dequeMeC1;
+    std::deque<QueueCursor> dequeMeC2;
+
+    verifyAcquire(queue, c1, dequeMeC1, "b", 1 );  // priority 9, though a-0 is older
+    verifyAcquire(queue, c2, dequeMeC2, "a", 2 );  // c2 now owns group "a"
+    verifyAcquire(queue, c1, dequeMeC1, "c", 3 );  // a-0 is owned by c2
+    BOOST_CHECK( !queue->dispatch(c1) );
+    verifyAcquire(queue, c2, dequeMeC2, "a", 0 );
+    BOOST_CHECK( !queue->dispatch(c2) );
+
+    queue->cancel(c1);
+    queue->cancel(c2);
+}
+
 QPID_AUTO_TEST_CASE(testSetPositionFifo) {
     Queue::shared_ptr q(new Queue("my-queue", true));
     BOOST_CHECK_EQUAL(q->getPosition(), SequenceNumber(0));
@@ -624,6 +1019,102 @@ QPID_AUTO_TEST_CASE(testSetPositionPriority) {
     BOOST_CHECK_EQUAL("1", c->lastMessage.getContent());
 }
 
+QPID_AUTO_TEST_CASE(testWidePriorityRange) {
+    QueueSettings settings;
+    settings.priorities = 256;
+    QueueFactory factory;
+    Queue::shared_ptr q(factory.create("my-queue", settings));
+
+    const int priorities[] = { 0, 200, 7, 255, 200, 100, 7 };
+    for (size_t i = 0; i < sizeof(priorities)/sizeof(priorities[0]); ++i) {
+        qpid::types::Variant::Map properties;
+        properties["priority"] = priorities[i];
+        q->deliver(MessageUtils::createMessage(properties, boost::lexical_cast<string>(i+1)));
+    }
+
+    // Purge takes messages in the order consumers would see them
+    BOOST_CHECK_EQUAL(1u, q->purge(1));
+
+    // Highest level first, fifo within a level
+    const uint32_t expected[] = { 2, 5, 6, 3, 7, 1 };
+    TestConsumer::shared_ptr browser(new TestConsumer("browser", false));
+    for (size_t i = 0; i < sizeof(expected)/sizeof(expected[0]); ++i) {
+        BOOST_CHECK(q->dispatch(browser));
+        BOOST_CHECK_EQUAL(expected[i], browser->lastMessage.getSequence());
+    }
+    BOOST_CHECK(!q->dispatch(browser));
+
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK_EQUAL(2u, c->lastMessage.getSequence());
+    q->dequeue(0, c->lastCursor);
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK_EQUAL(5u, c->lastMessage.getSequence());
+    // A released message is seen again before lower levels
+    q->release(c->lastCursor);
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK_EQUAL(5u, c->lastMessage.getSequence());
+
+    // Emptied levels are found again when refilled
+    qpid::types::Variant::Map properties;
+    properties["priority"] = 255;
+    q->deliver(MessageUtils::createMessage(properties, "8"));
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK_EQUAL(8u, c->lastMessage.getSequence());
+    for (size_t i = 2; i < sizeof(expected)/sizeof(expected[0]); ++i) {
+        BOOST_CHECK(q->dispatch(c));
+        BOOST_CHECK_EQUAL(expected[i], c->lastMessage.getSequence());
+    }
+    BOOST_CHECK(!q->dispatch(c));
+}
+
+QPID_AUTO_TEST_CASE(testHistograms)
+{
+    QueueFactory factory;
+    QueueSettings settings;
+    settings.histograms = true;
+    Queue::shared_ptr q(factory.create("my-queue", settings));
+    Queue::shared_ptr plain(factory.create("plain-queue", QueueSettings()));
+    q->deliver(MessageUtils::createMessage("exchange", "key", 0, false, Uuid(true), "abc"));
+    plain->deliver(MessageUtils::createMessage("exchange", "key", 0, false, Uuid(true), "abc"));
+
+    // Only queues keeping histograms stamp their messages
+    TestConsumer::shared_ptr c(new TestConsumer("test", true));
+    BOOST_CHECK(plain->dispatch(c));
+    BOOST_CHECK(c->lastMessage.getQueueTime() == qpid::sys::ZERO);
+    c.reset(new TestConsumer("test", true));
+    BOOST_CHECK(q->dispatch(c));
+    BOOST_CHECK(!(c->lastMessage.getQueueTime() == qpid::sys::ZERO));
+
+    QueueHistograms histograms;
+    qpid::broker::Message m = MessageUtils::createMessage("exchange", "key", 0, false, Uuid(true), "abcdef");
+    histograms.enqueued(m);
+    BOOST_CHECK_EQUAL(1u, histograms.getMessageSize().getCount());
+    BOOST_CHECK_EQUAL(m.getMessageSize(), histograms.getMessageSize().getMax());
+
+    // Messages that are not acquired, e.g. when purged, are not counted
+    histograms.acquired(m);
+    histograms.dequeued(m);
+    BOOST_CHECK_EQUAL(0u, histograms.getEnqueueToAcquire().getCount());
+    BOOST_CHECK_EQUAL(0u, histograms.getAcquireToAccept().getCount());
+
+    // c->lastMessage is a copy of the message acquired from q
+    histograms.acquired(c->lastMessage);
+    histograms.dequeued(c->lastMessage);
+    BOOST_CHECK_EQUAL(1u, histograms.getEnqueueToAcquire().getCount());
+    BOOST_CHECK_EQUAL(1u, histograms.getAcquireToAccept().getCount());
+
+    qpid::types::Variant::Map map;
+    histograms.mapEncode(map);
+    BOOST_CHECK_EQUAL(1u, map["messageSize"].asMap()["count"].asUint64());
+    BOOST_CHECK_EQUAL(1u, map["enqueueToAcquire"].asMap()["count"].asUint64());
+    BOOST_CHECK_EQUAL(1u, map["acquireToAccept"].asMap()["count"].asUint64());
+
+    histograms.reset();
+    BOOST_CHECK_EQUAL(0u, histograms.getMessageSize().getCount());
+    BOOST_CHECK_EQUAL(0u, histograms.getEnqueueToAcquire().getCount());
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
@@ -22,6 +22,7 @@
 #include "qpid/Exception.h"
 #include "qpid/framing/MessageTransferBody.h"
 #include "qpid/framing/SessionFlushBody.h"
+#include "qpid/framing/reply_exceptions.h"
 
 #include <boost/bind.hpp>
 #include <algorithm>
@@ -59,7 +60,7 @@ string str(const AMQFrame& f) {
     return "H";                 // Must be a header.
 }
 // Make a string from a range of frames.
-string str(const boost::iterator_range<vector<AMQFrame>::const_iterator>& frames) {
+string str(const qpid::SessionState::ReplayRange& frames) {
     string (*strFrame)(const AMQFrame&) = str;
     return applyAccumulate(frames.begin(), frames.end(), string(), ptr_fun(strFrame));
 }
@@ -211,6 +212,27 @@ QPID_AUTO_TEST_CASE(testPeerCompleted) {
     BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(4,0))), "CeCf");
 }
 
+QPID_AUTO_TEST_CASE(testReplayHardLimit) {
+    qpid::SessionState::Configuration c;
+    // room for 2 1-byte transfers.
+    c.replayHardLimit = 2*(transferFrameSize()+contentFrameSize());
+    {
+        // Without a timeout nothing is kept for replay, so the limit never applies.
+        qpid::SessionState s(SessionId(), c);
+        s.senderGetCommandPoint();
+        BOOST_CHECK_NO_THROW(transfers(s, "abcdef"));
+    }
+    qpid::SessionState s(SessionId(), c);
+    s.setTimeout(1);
+    s.senderGetCommandPoint();
+    transfers(s, "ab");
+    // Confirmed commands are dropped from the replay list, making room for more.
+    s.senderConfirmed(SessionPoint(2));
+    transfers(s, "cd");
+    BOOST_CHECK_EQUAL(str(s.senderExpected(SessionPoint(2,0))), "CcCd");
+    BOOST_CHECK_THROW(transfers(s, "e"), qpid::framing::ResourceLimitExceededException);
+}
+
 QPID_AUTO_TEST_CASE(testReceive) {
     // Advance expected/received correctly
     qpid::SessionState s;
@@ -24,6 +24,7 @@
 #include "qpid/Options.h"
 #include "unit_test.h"
 #include <math.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <boost/format.hpp>
@@ -128,6 +129,108 @@ QPID_AUTO_TEST_CASE(testGeneral)
     dynamic_pointer_cast<TestTask>(task4)->check(2);
 }
 
+QPID_AUTO_TEST_CASE(testCancel)
+{
+    Counter counter;
+    Timer timer;
+    intrusive_ptr<TestTask> task1(new TestTask(Duration(1 * TIME_SEC), counter));
+    intrusive_ptr<TestTask> task2(new TestTask(Duration(2 * TIME_SEC), counter));
+
+    timer.add(task1);
+    timer.add(task2);
+    task1->cancel();
+
+    task2->wait(Duration(4 * TIME_SEC));
+    task2->check(1);
+}
+
+QPID_AUTO_TEST_CASE(testMultipleThreads)
+{
+    Counter counter;
+    Timer timer(4);
+    intrusive_ptr<TestTask> task1(new TestTask(Duration(3 * TIME_SEC), counter));
+    intrusive_ptr<TestTask> task2(new TestTask(Duration(1 * TIME_SEC), counter));
+    intrusive_ptr<TestTask> task3(new TestTask(Duration(2 * TIME_SEC), counter));
+
+    timer.add(task1);
+    timer.add(task2);
+    timer.add(task3);
+
+    task1->wait(Duration(5 * TIME_SEC));
+
+    task1->check(3);
+    task2->check(1);
+    task3->check(2);
+}
+
+class ReaddingTask : public TimerTask
+{
+    Timer& timer;
+    Mutex lock;
+    uint running;
+    uint maxRunning;
+    uint fires;
+
+  public:
+    ReaddingTask(Timer& t)
+        : TimerTask(Duration(TIME_MSEC), "Readding"), timer(t), running(0), maxRunning(0), fires(0) {}
+
+    void fire()
+    {
+        {
+            Mutex::ScopedLock l(lock);
+            maxRunning = std::max(maxRunning, ++running);
+            ++fires;
+        }
+        setupNextFire();
+        timer.add(this);
+        qpid::sys::usleep(20 * 1000);
+        Mutex::ScopedLock l(lock);
+        --running;
+    }
+
+    void check()
+    {
+        Mutex::ScopedLock l(lock);
+        BOOST_CHECK(fires > 1);
+        BOOST_CHECK_EQUAL(maxRunning, 1u);
+    }
+};
+
+QPID_AUTO_TEST_CASE(testReaddedTaskFiresOnOneThread)
+{
+    // A task that adds itself again from fire() is due again before
+    // that fire returns, and another timer thread is free to take it
+    Timer timer(4);
+    intrusive_ptr<ReaddingTask> task(new ReaddingTask(timer));
+    timer.add(task);
+    qpid::sys::usleep(300 * 1000);
+    task->cancel();
+    task->check();
+}
+
+QPID_AUTO_TEST_CASE(testDueAcrossRotation)
+{
+    // A task due just after the first level of the timer's wheel
+    // rotates must not wait for a later task that is already on the
+    // first level
+    Counter counter;
+    Timer timer;
+    intrusive_ptr<TestTask> task1(new TestTask(Duration(200 * TIME_MSEC), counter));
+    intrusive_ptr<TestTask> task2(new TestTask(Duration(260 * TIME_MSEC), counter));
+    timer.add(task1);
+    timer.add(task2);
+
+    task1->wait(Duration(2 * TIME_SEC));
+    intrusive_ptr<TestTask> task3(new TestTask(Duration(240 * TIME_MSEC), counter));
+    timer.add(task3);
+
+    task3->wait(Duration(2 * TIME_SEC));
+    task1->check(1, 100 * TIME_MSEC);
+    task2->check(2, 100 * TIME_MSEC);
+    task3->check(3, 100 * TIME_MSEC);
+}
+
 std::string toString(Duration d) { return boost::lexical_cast<std::string>(d); }
 Duration fromString(const std::string& str) { return boost::lexical_cast<Duration>(str); }
 
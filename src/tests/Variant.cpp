@@ -829,6 +829,90 @@ QPID_AUTO_TEST_CASE(described)
     BOOST_CHECK(!a.isDescribed());
 }
 
+QPID_AUTO_TEST_CASE(testCopiesAreIndependent)
+{
+    std::string longString(100, 'x');
+    Variant::Map map;
+    map["short"] = "abc";
+    map["long"] = longString;
+    map["uuid"] = Uuid(true);
+
+    Variant a(map);
+    Variant b(a);
+    b.asMap()["short"] = "def";
+    b.asMap()["long"].getString()[0] = 'y';
+    BOOST_CHECK_EQUAL(a.asMap()["short"], Variant("abc"));
+    BOOST_CHECK_EQUAL(a.asMap()["long"], Variant(longString));
+    BOOST_CHECK_EQUAL(b.asMap()["short"], Variant("def"));
+    BOOST_CHECK_EQUAL(b.asMap()["long"].getString()[0], 'y');
+    BOOST_CHECK_EQUAL(a.asMap()["uuid"], b.asMap()["uuid"]);
+
+    // Changes made through a reference obtained before a copy was
+    // taken must not be visible in the copy.
+    a = Variant::List();
+    Variant::List& list = a.asList();
+    list.push_back(1);
+    Variant c(a);
+    list.push_back(2);
+    BOOST_CHECK_EQUAL(c.asList().size(), 1U);
+    BOOST_CHECK_EQUAL(a.asList().size(), 2U);
+
+    c = longString;
+    std::string& s = c.getString();
+    Variant d(c);
+    s[0] = 'z';
+    BOOST_CHECK_EQUAL(d.getString(), longString);
+    BOOST_CHECK_EQUAL(c.getString()[0], 'z');
+}
+
+QPID_AUTO_TEST_CASE(testConstReferenceToSharedValue)
+{
+    Variant a = Variant::Map();
+    a.asMap()["key"] = "value";
+    Variant b(a);
+    Variant c(b);
+
+    // b and c share a value; a const reference from b refers to it and
+    // stays with it once b is modified and takes its own copy
+    const Variant::Map& shared = static_cast<const Variant&>(b).asMap();
+    Variant::Map& own = b.asMap();
+    own["key"] = "changed";
+    BOOST_CHECK(&shared != &own);
+    BOOST_CHECK_EQUAL(shared.find("key")->second, Variant("value"));
+    BOOST_CHECK_EQUAL(&shared, &static_cast<const Variant&>(c).asMap());
+
+    // A reference from the non-const accessor follows later changes
+    own["other"] = 1;
+    BOOST_CHECK_EQUAL(b.asMap().size(), 2U);
+    BOOST_CHECK_EQUAL(c.asMap().size(), 1U);
+}
+
+QPID_AUTO_TEST_CASE(testAssignFromContainedValue)
+{
+    Variant a = Variant::Map();
+    a.asMap()["nested"] = Variant::Map();
+    a.asMap()["nested"].asMap()["value"] = std::string(100, 'x');
+    a = a.asMap()["nested"];
+    BOOST_CHECK_EQUAL(a.asMap()["value"], Variant(std::string(100, 'x')));
+    a = a.asMap()["value"];
+    BOOST_CHECK_EQUAL(a, Variant(std::string(100, 'x')));
+    a = a.getString();
+    BOOST_CHECK_EQUAL(a, Variant(std::string(100, 'x')));
+    a = a;
+    BOOST_CHECK_EQUAL(a, Variant(std::string(100, 'x')));
+
+    Variant b("abc", "custom");
+    b.setDescriptor("d");
+    Variant c(1);
+    c = b;
+    BOOST_CHECK_EQUAL(c.getString(), std::string("abc"));
+    BOOST_CHECK_EQUAL(c.getEncoding(), std::string("custom"));
+    BOOST_CHECK_EQUAL(c.getDescriptor(), Variant("d"));
+    c = "def";
+    BOOST_CHECK_EQUAL(c.getEncoding(), std::string());
+    BOOST_CHECK(c.isDescribed());
+}
+
 QPID_AUTO_TEST_SUITE_END()
 
 }} // namespace qpid::tests
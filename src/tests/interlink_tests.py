@@ -32,13 +32,14 @@ class Domain(BrokerObject):
         BrokerObject.__init__(self, broker, values)
 
 class Config:
-    def __init__(self, broker, address="q;{create:always}", version="amqp1.0"):
+    def __init__(self, broker, address="q;{create:always}", version="amqp1.0", batch=0):
         self.url = broker.host_port()
         self.address = address
         self.version = version
+        self.batch = batch
 
     def __str__(self):
-        return "url: %s, address: %s, version: %s" % (self.url, self.address, self.version)
+        return "url: %s, address: %s, version: %s, batch: %s" % (self.url, self.address, self.version, self.batch)
 
 class AmqpBrokerTest(BrokerTest):
     """
@@ -56,7 +57,8 @@ class AmqpBrokerTest(BrokerTest):
                "--broker", config.url,
                "--address", config.address,
                "--connection-options", "{protocol:%s}" % config.version,
-               "--content-stdin", "--send-eos=1"
+               "--content-stdin", "--send-eos=1",
+               "--batch=%s" % config.batch
                ]
         if reply_to:
             cmd.append( "--reply-to=%s" % reply_to)
@@ -67,7 +69,7 @@ class AmqpBrokerTest(BrokerTest):
                "--broker", config.url,
                "--address", config.address,
                "--connection-options", "{protocol:%r}" % config.version,
-               "--timeout=10"
+               "--timeout=10", "--batch=%s" % config.batch
                ]
         return self.popen(cmd, stdout=PIPE)
 
@@ -131,6 +133,44 @@ class AmqpBrokerTest(BrokerTest):
     def test_translate_with_large_routingkey(self):
         self.send_and_receive(send_config=Config(self.broker, address="amq.topic/a.%s" % ("x" * 256), version="amqp1.0"), recv_config=Config(self.broker, address="amq.topic/a.*", version="amqp0-10"), wait_for_receiver=True)
 
+    def test_batch(self):
+        self.send_and_receive(send_config=Config(self.broker, batch=7), recv_config=Config(self.broker, batch=9))
+
+    def test_batch_translated(self):
+        self.send_and_receive(send_config=Config(self.broker, version="amqp0-10", batch=7), recv_config=Config(self.broker, batch=9))
+
+    def test_adaptive_capacity(self):
+        address = "q;{create:always,link:{adaptive-capacity:True,capacity-bytes:4096}}"
+        self.send_and_receive(recv_config=Config(self.broker, address=address))
+
+    def test_translate_browsed_repeatedly(self):
+        """Messages translated once and cached are delivered intact each time"""
+        send_cmd = ["qpid-send",
+               "--broker", self.broker.host_port(),
+               "--address=q;{create:always}",
+               "--connection-options={protocol:amqp0-10}",
+               "--messages=100", "--content-string=abc",
+               "-P", "my-header=xyz"
+               ]
+        self.popen(send_cmd).assert_exit_ok()
+        def receive(address):
+            receive_cmd = ["qpid-receive",
+                   "--broker", self.broker.host_port(),
+                   "--address=%s" % address,
+                   "--connection-options={protocol:amqp1.0}",
+                   "--messages=100", "--timeout=10",
+                   "--print-headers=true"
+                   ]
+            receiver = self.popen(receive_cmd, stdout=PIPE)
+            output = receiver.stdout.read()
+            receiver.wait()
+            return output
+        browsed = receive("q;{mode:browse}")
+        self.assertEqual(100, browsed.count("my-header:xyz"))
+        self.assertEqual(browsed, receive("q;{mode:browse}"))
+        self.assertEqual(browsed, receive("q"))
+        assert_browse(self.broker.connect().session(), "q", [])
+
     def send_and_receive_empty(self, send_config=None, recv_config=None):
         sconfig = send_config or self.default_config
         rconfig = recv_config or self.default_config
@@ -191,6 +191,23 @@ class CppTxTest(InteropTest):
         assert_browse(self.connect().session(), q, expect, transform=sn)
 
 
+class DriverTest(InteropTest):
+
+    def test_io_threads_follow_open_connections(self):
+        """IO threads are added for connections that are open at the same
+        time, not for every connection that was ever opened"""
+        tasks = "/proc/self/task"
+        if not os.path.isdir(tasks): return # Thread count not available
+        self.connect()
+        def open_close():
+            c = qm.Connection.establish(self.url, protocol='amqp1.0')
+            c.close()
+        open_close()
+        baseline = len(os.listdir(tasks))
+        for i in xrange(8): open_close()
+        self.assertEqual(baseline, len(os.listdir(tasks)))
+
+
 if __name__ == "__main__":
     from env import *
     outdir = "interop_tests.tmp"
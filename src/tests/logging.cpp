@@ -17,11 +17,17 @@
  */
 
 #include "test_tools.h"
+#include "qpid/log/AsyncLog.h"
 #include "qpid/log/Logger.h"
 #include "qpid/log/Options.h"
 #include "qpid/log/OstreamOutput.h"
 #include "qpid/memory.h"
 #include "qpid/Options.h"
+#include "qpid/sys/AtomicValue.h"
+#include "qpid/sys/Monitor.h"
+#include "qpid/sys/Runnable.h"
+#include "qpid/sys/Thread.h"
+#include "qpid/sys/Time.h"
 #if defined (_WIN32)
 #  include "qpid/log/windows/SinkOptions.h"
 #else
@@ -30,6 +36,7 @@
 
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include "unit_test.h"
 
@@ -174,6 +181,48 @@ QPID_AUTO_TEST_CASE(testMacro) {
     BOOST_CHECK_EQUAL(expect, out->msg);
 }
 
+int evaluated(int& count) { return ++count; }
+
+QPID_AUTO_TEST_CASE(testMacroArgumentsNotEvaluated) {
+    Logger& l=Logger::instance();
+    ScopedSuppressLogging ls(l);
+    l.select(Selector("notice+"));
+    TestOutput* out=new TestOutput(l);
+    int count = 0;
+    QPID_LOG(debug, "not enabled " << evaluated(count));
+    QPID_LOG_IF(debug, evaluated(count), "not enabled");
+    BOOST_CHECK_EQUAL(0, count);
+    BOOST_CHECK(out->msg.empty());
+    QPID_LOG(notice, "enabled " << evaluated(count));
+    BOOST_CHECK_EQUAL(1, count);
+    BOOST_CHECK_EQUAL(1u, out->msg.size());
+}
+
+// Statements below QPID_LOG_MIN_LEVEL are compiled out so can never be
+// enabled, the level is checked where the macro is expanded.
+#pragma push_macro("QPID_LOG_MIN_LEVEL")
+#undef QPID_LOG_MIN_LEVEL
+#define QPID_LOG_MIN_LEVEL 3 // notice
+QPID_AUTO_TEST_CASE(testCompiledOutStatements) {
+    Logger& l=Logger::instance();
+    ScopedSuppressLogging ls(l);
+    l.select(Selector("trace+"));
+    TestOutput* out=new TestOutput(l);
+    int count = 0;
+    QPID_LOG(info, "compiled out " << evaluated(count));
+    bool enabled = true;
+    QPID_LOG_TEST(debug, enabled);
+    BOOST_CHECK(!enabled);
+    BOOST_CHECK_EQUAL(0, count);
+    BOOST_CHECK(out->msg.empty());
+    QPID_LOG(notice, "compiled in " << evaluated(count));
+    QPID_LOG_TEST(warning, enabled);
+    BOOST_CHECK(enabled);
+    BOOST_CHECK_EQUAL(1, count);
+    BOOST_CHECK_EQUAL(1u, out->msg.size());
+}
+#pragma pop_macro("QPID_LOG_MIN_LEVEL")
+
 QPID_AUTO_TEST_CASE(testLoggerFormat) {
     Logger& l = Logger::instance();
     ScopedSuppressLogging ls(l);
@@ -430,6 +479,196 @@ QPID_AUTO_TEST_CASE(testLoggerStateure) {
     unlink("logging.tmp");
 }
 
+struct AsyncLogging : public qpid::sys::Runnable {
+    void run() {
+        for (int i = 0; i < 100; ++i)
+            QPID_LOG_CAT(critical, test, "thread " << i);
+    }
+};
+
+QPID_AUTO_TEST_CASE(testAsyncLogger) {
+    Logger& l=Logger::instance();
+    ScopedSuppressLogging ls(l);
+    qpid::log::Options opts("test");
+    const char* argv[]={
+        0,
+        "--log-time", "no",
+        "--log-level", "no",
+        "--log-category", "no",
+        "--log-to-stderr", "no",
+        "--log-enable", "critical",
+        "--log-async", "yes",
+        "--log-async-buffer", "8"
+    };
+    opts.parse(ARGC(argv), const_cast<char**>(argv));
+    BOOST_CHECK(opts.async);
+    BOOST_CHECK_EQUAL(8u, opts.asyncBufferSize);
+    l.configure(opts);
+    TestOutput* out=new TestOutput(l);
+
+    // Waits for space rather than dropping when a buffer fills.
+    AsyncLogging logging;
+    qpid::sys::Thread thread(logging);
+    for (int i = 0; i < 100; ++i)
+        QPID_LOG_CAT(critical, test, "main " << i);
+    thread.join();
+    l.flush();
+    BOOST_CHECK_EQUAL(0u, l.getDropped());
+    BOOST_REQUIRE_EQUAL(200u, out->msg.size());
+
+    // Each thread's messages are output in order.
+    int fromMain = 0, fromThread = 0;
+    for (size_t i = 0; i < out->msg.size(); ++i) {
+        if (out->msg[i] == (format("main %d\n")%fromMain).str()) ++fromMain;
+        else if (out->msg[i] == (format("thread %d\n")%fromThread).str()) ++fromThread;
+    }
+    BOOST_CHECK_EQUAL(100, fromMain);
+    BOOST_CHECK_EQUAL(100, fromThread);
+}
+
+struct ReconfiguringLogging : public qpid::sys::Runnable {
+    qpid::sys::AtomicValue<uint32_t> stop;
+    void run() {
+        while (!stop.get())
+            QPID_LOG_CAT(critical, test, "thread");
+    }
+};
+
+QPID_AUTO_TEST_CASE(testAsyncLoggerReconfigure) {
+    Logger& l=Logger::instance();
+    ScopedSuppressLogging ls(l);
+    qpid::log::Options opts("test");
+    const char* argv[]={
+        0,
+        "--log-to-stderr", "no",
+        "--log-enable", "critical",
+        "--log-async", "yes",
+        "--log-async-drop", "yes"
+    };
+    opts.parse(ARGC(argv), const_cast<char**>(argv));
+    // The asynchronous log is replaced while another thread is using it
+    ReconfiguringLogging logging;
+    qpid::sys::Thread thread(logging);
+    for (int i = 0; i < 20; ++i) {
+        l.configure(opts);
+        new TestOutput(l);
+        qpid::sys::usleep(1000);
+    }
+    logging.stop = 1;
+    thread.join();
+    l.flush();
+}
+
+struct BlockingWriter {
+    qpid::sys::Monitor lock;
+    bool blocked;
+    bool writing;
+    size_t written;
+    uint64_t dropped;
+
+    BlockingWriter() : blocked(true), writing(false), written(0), dropped(0) {}
+
+    void write(const AsyncLog::Batch& batch, uint64_t d) {
+        qpid::sys::Monitor::ScopedLock l(lock);
+        writing = true;
+        lock.notifyAll();
+        while (blocked) lock.wait();
+        written += batch.size();
+        dropped += d;
+    }
+
+    void waitForWrite() {
+        qpid::sys::Monitor::ScopedLock l(lock);
+        while (!writing) lock.wait();
+    }
+
+    void release() {
+        qpid::sys::Monitor::ScopedLock l(lock);
+        blocked = false;
+        lock.notifyAll();
+    }
+};
+
+QPID_AUTO_TEST_CASE(testAsyncLogDrop) {
+    static Statement s=QPID_LOG_STATEMENT_INIT(critical);
+    BlockingWriter writer;
+    {
+        AsyncLog log(boost::bind(&BlockingWriter::write, &writer, _1, _2), 4, true);
+        // At most one buffer full is held by the blocked writer and one
+        // by the logging thread's buffer.
+        for (int i = 0; i < 20; ++i) log.push(s, "foo");
+        BOOST_CHECK(log.getDropped() >= 12u);
+        writer.release();
+        log.flush();
+        BOOST_CHECK_EQUAL(20u, writer.written + log.getDropped());
+        BOOST_CHECK_EQUAL(log.getDropped(), writer.dropped);
+    }
+}
+
+struct PushingThread : public qpid::sys::Runnable {
+    AsyncLog& log;
+    int count;
+    PushingThread(AsyncLog& l, int c=4) : log(l), count(c) {}
+    void run() {
+        static Statement s=QPID_LOG_STATEMENT_INIT(critical);
+        for (int i = 0; i < count; ++i) log.push(s, "foo");
+    }
+};
+
+QPID_AUTO_TEST_CASE(testAsyncLogThreadExit) {
+    static Statement s=QPID_LOG_STATEMENT_INIT(critical);
+    BlockingWriter writer;
+    {
+        AsyncLog log(boost::bind(&BlockingWriter::write, &writer, _1, _2), 4, true);
+        log.push(s, "foo");
+        writer.waitForWrite();
+        // The first thread fills its buffer and exits; the second is
+        // given the same, still full, buffer rather than a new one
+        PushingThread pushing(log);
+        qpid::sys::Thread(pushing).join();
+        BOOST_CHECK_EQUAL(0u, log.getDropped());
+        qpid::sys::Thread(pushing).join();
+        BOOST_CHECK_EQUAL(4u, log.getDropped());
+        writer.release();
+        log.flush();
+        BOOST_CHECK_EQUAL(9u, writer.written + log.getDropped());
+    }
+}
+
+struct ClosingThread : public qpid::sys::Runnable {
+    AsyncLog& log;
+    qpid::sys::AtomicValue<uint32_t> closed;
+    ClosingThread(AsyncLog& l) : log(l) {}
+    void run() {
+        log.close();
+        ++closed;
+    }
+};
+
+QPID_AUTO_TEST_CASE(testAsyncLogCloseWaitsForPush) {
+    static Statement s=QPID_LOG_STATEMENT_INIT(critical);
+    BlockingWriter writer;
+    AsyncLog log(boost::bind(&BlockingWriter::write, &writer, _1, _2), 4, false);
+    log.push(s, "foo");
+    writer.waitForWrite();
+    // Fills its buffer then waits for the blocked writer to make room
+    PushingThread pushing(log, 5);
+    qpid::sys::Thread pusher(pushing);
+    qpid::sys::usleep(100*1000);
+    // Closing waits for that push to complete and refuses new ones
+    ClosingThread closing(log);
+    qpid::sys::Thread closer(closing);
+    qpid::sys::usleep(100*1000);
+    BOOST_CHECK(!log.push(s, "bar"));
+    BOOST_CHECK_EQUAL(0u, closing.closed.get());
+    writer.release();
+    pusher.join();
+    closer.join();
+    BOOST_CHECK_EQUAL(1u, closing.closed.get());
+    BOOST_CHECK_EQUAL(6u, writer.written);
+    BOOST_CHECK_EQUAL(0u, log.getDropped());
+}
+
 QPID_AUTO_TEST_CASE(testQuoteNonPrintable) {
     Logger& l=Logger::instance();
     ScopedSuppressLogging ls(l);
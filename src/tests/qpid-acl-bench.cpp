@@ -0,0 +1,155 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Microbenchmark for publish checks against a large ACL file.
+ *
+ * Writes an ACL file with the requested number of tenant rules, loads
+ * it and times the publish check made for each message, both as a
+ * lookup in the rules and through the per-session AclPublishCache, and
+ * the create queue check, both by scanning the rules and through the
+ * compiled rule set.
+ */
+
+#include "BenchUtils.h"
+#include "qpid/Exception.h"
+#include "qpid/acl/AclData.h"
+#include "qpid/acl/AclReader.h"
+#include "qpid/broker/AclModule.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fstream>
+#include <vector>
+
+using namespace qpid;
+using namespace qpid::sys;
+using boost::lexical_cast;
+
+namespace qpid {
+namespace tests {
+
+struct Opts : public BenchOptions
+{
+    uint32_t rules;
+    uint32_t keys;
+    std::string file;
+
+    Opts() : BenchOptions(1000000), rules(2000), keys(100), file("qpid-acl-bench.acl")
+    {
+        addOptions()
+            ("rules", optValue(rules, "N"), "Number of publish and create queue rules in the ACL file")
+            ("keys", optValue(keys, "N"), "Number of distinct routing keys published to")
+            ("acl-file", optValue(file, "FILE"), "ACL file to write and load");
+    }
+};
+
+const std::string USER("bench@QPID");
+const std::string EXCHANGE("amq.topic");
+
+void write(const Opts& opts)
+{
+    std::ofstream out(opts.file.c_str());
+    for (uint32_t i = 0; i < opts.rules; ++i) {
+        out << "acl allow " << USER << " publish exchange name=" << EXCHANGE
+            << " routingkey=tenant" << i << ".#" << std::endl;
+        out << "acl allow " << USER << " create queue name=tenant" << i << ".*" << std::endl;
+    }
+    out << "acl deny all all" << std::endl;
+}
+
+boost::shared_ptr<acl::AclData> load(const Opts& opts)
+{
+    write(opts);
+    boost::shared_ptr<acl::AclData> data(new acl::AclData);
+    acl::AclReader reader(0, 0);
+    if (reader.read(opts.file, data)) throw Exception(reader.getError());
+    return data;
+}
+
+void run(const Opts& opts)
+{
+    if (opts.keys == 0) throw Exception("--keys must be at least 1");
+    boost::shared_ptr<acl::AclData> loaded = load(opts);
+    acl::AclData& data = *loaded;
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; i < opts.keys; ++i) {
+        keys.push_back("tenant" + lexical_cast<std::string>(i * opts.rules / opts.keys) + ".orders.new");
+    }
+    uint64_t allowed = 0;
+
+    AbsTime start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        if (data.lookup(USER, acl::ACT_PUBLISH, acl::OBJ_EXCHANGE, EXCHANGE, keys[i % keys.size()]) == acl::ALLOW) ++allowed;
+    }
+    double lookupTime = nsPerOp(start, opts.count);
+
+    broker::AclPublishCache cache;
+    start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        const std::string& key = keys[i % keys.size()];
+        acl::AclResult result;
+        if (!cache.get(1, EXCHANGE, key, result)) {
+            result = data.lookup(USER, acl::ACT_PUBLISH, acl::OBJ_EXCHANGE, EXCHANGE, key);
+            cache.put(1, EXCHANGE, key, result);
+        }
+        if (result == acl::ALLOW) ++allowed;
+    }
+    double cachedTime = nsPerOp(start, opts.count);
+
+    std::vector<std::string> queues;
+    for (uint32_t i = 0; i < opts.keys; ++i) {
+        queues.push_back("tenant" + lexical_cast<std::string>(i * opts.rules / opts.keys) + ".orders");
+    }
+    start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        if (data.lookupLinear(USER, acl::ACT_CREATE, acl::OBJ_QUEUE, queues[i % queues.size()]) == acl::ALLOW) ++allowed;
+    }
+    double linearTime = nsPerOp(start, opts.count);
+
+    start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        if (data.lookup(USER, acl::ACT_CREATE, acl::OBJ_QUEUE, queues[i % queues.size()]) == acl::ALLOW) ++allowed;
+    }
+    double compiledTime = nsPerOp(start, opts.count);
+
+    JsonLine()
+        .add("rules", opts.rules)
+        .add("keys", opts.keys)
+        .add("count", opts.count)
+        .add("lookup_ns", lookupTime)
+        .add("cached_ns", cachedTime)
+        .add("create_linear_ns", linearTime)
+        .add("create_compiled_ns", compiledTime)
+        .add("allowed", allowed)
+        .print();
+}
+
+}} // namespace qpid::tests
+
+using namespace qpid::tests;
+
+int main(int argc, char** argv)
+{
+    Opts opts;
+    return benchMain("qpid-acl-bench", argc, argv, opts, &run);
+}
@@ -0,0 +1,460 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * In-process broker benchmark.
+ *
+ * Creates a broker, listening only on an ephemeral loopback port to
+ * which nothing connects, and drives it through the same internal APIs
+ * the protocol layers use: messages are routed
+ * with Exchange::route() into queues (and so the store, for durable
+ * queues), and consumed by broker Consumers that are dispatched and
+ * accept messages with Queue::dispatch() and Queue::dequeue(). This
+ * measures broker costs without client or network overheads.
+ *
+ * A run reports its configuration, the publish and receive rates and
+ * the distribution of in-broker latency: from just before a message is
+ * created and routed to its delivery to a consumer. The latency is
+ * taken from a timestamp the producer puts in the message properties,
+ * as the broker may set the message's queue time itself
+ * (--enable-histograms).
+ */
+
+#include "qpid/Modules.h"
+#include "qpid/Options.h"
+#include "qpid/OptionsTemplates.h"
+#include "qpid/Plugin.h"
+#include "qpid/broker/Broker.h"
+#include "qpid/broker/BrokerOptions.h"
+#include "qpid/broker/Consumer.h"
+#include "qpid/broker/DeliverableMessage.h"
+#include "qpid/broker/Exchange.h"
+#include "qpid/broker/Histogram.h"
+#include "qpid/broker/Queue.h"
+#include "qpid/broker/QueueSettings.h"
+#include "qpid/framing/FieldTable.h"
+#include "qpid/log/Logger.h"
+#include "qpid/log/Options.h"
+#include "qpid/sys/Monitor.h"
+#include "qpid/sys/Runnable.h"
+#include "qpid/sys/Thread.h"
+#include "qpid/sys/Time.h"
+#include "BenchUtils.h"
+#include "MessageUtils.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+using namespace qpid;
+using namespace qpid::broker;
+using namespace qpid::sys;
+using boost::lexical_cast;
+
+namespace qpid {
+namespace tests {
+
+const std::string EXCHANGE_NAME("qpid-broker-bench");
+const std::string QUEUE_KEY("q");
+const std::string LVQ_KEY("k");
+const std::string GROUP_KEY("g");
+const std::string EXTRA_KEY("x");
+const std::string TS_KEY("ts");
+
+enum QueueType { STANDARD, LVQ, PRIORITY, GROUP };
+const char* queueTypeNames[] = { "standard", "lvq", "priority", "group" };
+
+istream& operator>>(istream& in, QueueType& type) {
+    string s;
+    in >> s;
+    int i = find(queueTypeNames, queueTypeNames+4, s) - queueTypeNames;
+    if (i >= 4) throw Exception("Invalid queue type: "+s);
+    type = QueueType(i);
+    return in;
+}
+
+ostream& operator<<(ostream& out, QueueType type) {
+    return out << queueTypeNames[type];
+}
+
+struct Opts : public qpid::Options {
+    std::string exchangeType;
+    QueueType queueType;
+    size_t queues;
+    size_t bindings;
+    size_t producers;
+    size_t consumers;
+    size_t count;
+    size_t size;
+    size_t keys;
+    size_t priorities;
+    size_t iterations;
+    size_t drainTimeout;
+    bool durable;
+    bool help;
+
+    qpid::broker::BrokerOptions broker;
+    qpid::log::Options log;
+
+    Opts() :
+        qpid::Options("qpid-broker-bench options"),
+        exchangeType("direct"), queueType(STANDARD), queues(1), bindings(0),
+        producers(1), consumers(1), count(100000), size(1024), keys(100),
+        priorities(10), iterations(1), drainTimeout(60), durable(false), help(false),
+        broker("Broker Options"), log("qpid-broker-bench")
+    {
+        addOptions()
+            ("exchange-type", optValue(exchangeType, "direct|topic|fanout|headers"), "Type of exchange messages are routed through.")
+            ("queue-type", optValue(queueType, "standard|lvq|priority|group"), "Type of the queues.")
+            ("queues", optValue(queues, "N"), "Number of queues bound to the exchange.")
+            ("bindings", optValue(bindings, "N"), "Additional bindings per queue that match no messages.")
+            ("producers", optValue(producers, "N"), "Number of producer threads, each routes --count messages.")
+            ("consumers", optValue(consumers, "N"), "Number of consumer threads per queue (0 to only enqueue).")
+            ("count", optValue(count, "N"), "Messages routed by each producer.")
+            ("size", optValue(size, "BYTES"), "Size of message content.")
+            ("keys", optValue(keys, "N"), "Number of distinct last value or group keys.")
+            ("priorities", optValue(priorities, "N"), "Number of levels of priority queues, messages cycle through them.")
+            ("iterations", optValue(iterations, "N"), "Number of runs, each prints one result.")
+            ("drain-timeout", optValue(drainTimeout, "SECONDS"), "Longest to wait for consumers to empty the queues once all messages are routed.")
+            ("durable", optValue(durable, "yes|no"), "Use durable queues and messages.")
+            ("help,h", optValue(help), "Print this usage statement.");
+        add(broker);
+        add(log);
+
+        // No network or persistence unless asked for.
+        broker.port = 0;
+        broker.listenInterfaces.push_back("127.0.0.1");
+        broker.dataDir = "";
+        broker.auth = false;
+        log.selectors.clear();
+        log.selectors.push_back("error+");
+    }
+};
+
+/** Latency statistics and counts gathered by consumers. */
+class Results
+{
+  public:
+    Results() : received(0), last(AbsTime::now()) {}
+
+    void add(const Histogram& h, uint64_t n, AbsTime t) {
+        Mutex::ScopedLock l(lock);
+        latency.add(h);
+        received += n;
+        if (t > last) last = t;
+    }
+
+    Histogram latency;
+    uint64_t received;
+    AbsTime last;
+  private:
+    Mutex lock;
+};
+
+class Producer : public Runnable
+{
+  public:
+    Producer(const Opts& o, Exchange::shared_ptr e, size_t i)
+        : opts(o), exchange(e), id(i), content(o.size, 'X'), routed(0) {}
+
+    void run() {
+        bool fanout = opts.exchangeType == "fanout";
+        for (size_t i = 0; i < opts.count; ++i) {
+            size_t q = (id + i) % opts.queues;
+            types::Variant::Map properties;
+            properties["routing-key"] = opts.exchangeType == "topic" ? queueName(q) + ".data" : queueName(q);
+            if (!fanout) properties[QUEUE_KEY] = lexical_cast<std::string>(q);
+            if (opts.durable) properties["durable"] = true;
+            switch (opts.queueType) {
+              case LVQ: properties[LVQ_KEY] = lexical_cast<std::string>(i % opts.keys); break;
+              case PRIORITY: properties["priority"] = uint8_t(i % opts.priorities); break;
+              case GROUP: properties[GROUP_KEY] = lexical_cast<std::string>(i % opts.keys); break;
+              default: break;
+            }
+            properties[TS_KEY] = int64_t(Duration::FromEpoch());
+            Message msg = MessageUtils::createMessage(properties, content);
+            DeliverableMessage deliverable(msg, 0);
+            exchange->route(deliverable);
+            if (deliverable.delivered) ++routed;
+        }
+    }
+
+    static std::string queueName(size_t q) {
+        return EXCHANGE_NAME + "-" + lexical_cast<std::string>(q);
+    }
+
+    uint64_t getRouted() const { return routed; }
+
+  private:
+    const Opts& opts;
+    Exchange::shared_ptr exchange;
+    size_t id;
+    std::string content;
+    uint64_t routed;
+};
+
+class BenchConsumer : public Consumer, public Runnable
+{
+  public:
+    BenchConsumer(const std::string& name, Queue::shared_ptr q, Results& r)
+        : Consumer(name, CONSUMER, name), queue(q), results(r), received(0),
+          notified(false), stopped(false) {}
+
+    bool deliver(const QueueCursor& cursor, const Message& message) {
+        current = cursor;
+        int64_t sent = message.getProperty(TS_KEY).asInt64();
+        int64_t now = Duration::FromEpoch();
+        latency.record(now > sent ? now - sent : 0);
+        return true;
+    }
+
+    void notify() {
+        Monitor::ScopedLock l(monitor);
+        notified = true;
+        monitor.notify();
+    }
+
+    void stop() {
+        Monitor::ScopedLock l(monitor);
+        stopped = true;
+        monitor.notify();
+    }
+
+    void run() {
+        AbsTime last = AbsTime::now();
+        while (true) {
+            if (queue->dispatch(shared_from_this())) {
+                queue->dequeue(0, current);
+                ++received;
+                last = AbsTime::now();
+            } else {
+                Monitor::ScopedLock l(monitor);
+                if (stopped) break;
+                if (!notified) monitor.wait(AbsTime(AbsTime::now(), 10*TIME_MSEC));
+                notified = false;
+            }
+        }
+        results.add(latency, received, last);
+    }
+
+    void cancel() {}
+    void acknowledged(const DeliveryRecord&) {}
+    OwnershipToken* getSession() { return 0; }
+
+    Queue::shared_ptr getQueue() const { return queue; }
+    void setSelf(Consumer::shared_ptr s) { self = s; }
+    Consumer::shared_ptr shared_from_this() { return self.lock(); }
+
+  private:
+    Queue::shared_ptr queue;
+    Results& results;
+    QueueCursor current;
+    Histogram latency;
+    uint64_t received;
+    Monitor monitor;
+    bool notified;
+    bool stopped;
+    boost::weak_ptr<Consumer> self;
+};
+
+double secs(AbsTime start, AbsTime end) {
+    return double(Duration(start, end))/TIME_SEC;
+}
+
+double usecs(uint64_t ns) {
+    return double(ns)/TIME_USEC;
+}
+
+void run(const Opts& opts, Broker& broker, size_t iteration)
+{
+    // Set up exchange, queues and bindings.
+    Exchange::shared_ptr exchange = broker.createExchange(
+        EXCHANGE_NAME, opts.exchangeType, opts.durable, false, std::string(),
+        framing::FieldTable(), std::string(), std::string()).first;
+    std::vector<Queue::shared_ptr> queues;
+    for (size_t q = 0; q < opts.queues; ++q) {
+        QueueSettings settings(opts.durable, false);
+        switch (opts.queueType) {
+          case LVQ: settings.lvqKey = LVQ_KEY; break;
+          case PRIORITY: settings.priorities = opts.priorities; break;
+          case GROUP: settings.groupKey = GROUP_KEY; settings.shareGroups = true; break;
+          default: break;
+        }
+        std::string name = Producer::queueName(q);
+        queues.push_back(broker.createQueue(name, settings, 0, std::string(), std::string(), std::string()).first);
+        for (size_t b = 0; b <= opts.bindings; ++b) {
+            // Binding 0 matches messages for this queue, the rest match nothing.
+            std::string key = b ? name + "." + lexical_cast<std::string>(b) : name;
+            framing::FieldTable args;
+            if (opts.exchangeType == "topic") {
+                key += b ? ".none" : ".*";
+            } else if (opts.exchangeType == "headers") {
+                args.setString("x-match", "all");
+                args.setString(QUEUE_KEY, lexical_cast<std::string>(q));
+                if (b) args.setString(EXTRA_KEY, lexical_cast<std::string>(b));
+            }
+            broker.bind(name, EXCHANGE_NAME, key, args, 0, std::string(), std::string());
+        }
+    }
+
+    Results results;
+    std::vector<boost::shared_ptr<BenchConsumer> > consumers;
+    std::vector<Thread> consumerThreads;
+    for (size_t q = 0; q < queues.size(); ++q) {
+        for (size_t c = 0; c < opts.consumers; ++c) {
+            std::string name = queues[q]->getName() + "-consumer-" + lexical_cast<std::string>(c);
+            boost::shared_ptr<BenchConsumer> consumer(new BenchConsumer(name, queues[q], results));
+            consumer->setSelf(consumer);
+            consumers.push_back(consumer);
+            queues[q]->consume(consumer);
+        }
+    }
+
+    boost::ptr_vector<Producer> producers;
+    for (size_t p = 0; p < opts.producers; ++p)
+        producers.push_back(new Producer(opts, exchange, p));
+
+    AbsTime start = AbsTime::now();
+    for (size_t i = 0; i < consumers.size(); ++i)
+        consumerThreads.push_back(Thread(*consumers[i]));
+    std::vector<Thread> producerThreads;
+    for (size_t i = 0; i < producers.size(); ++i)
+        producerThreads.push_back(Thread(producers[i]));
+    for (size_t i = 0; i < producerThreads.size(); ++i)
+        producerThreads[i].join();
+    AbsTime published = AbsTime::now();
+
+    uint64_t routed = 0;
+    for (size_t i = 0; i < producers.size(); ++i)
+        routed += producers[i].getRouted();
+
+    // Wait for consumers to drain the queues before stopping them.
+    bool drained = true;
+    if (opts.consumers) {
+        AbsTime deadline(published, opts.drainTimeout*TIME_SEC);
+        bool empty = false;
+        while (!empty) {
+            empty = true;
+            for (size_t q = 0; q < queues.size() && empty; ++q)
+                empty = queues[q]->getMessageCount() == 0;
+            if (empty) break;
+            if (AbsTime::now() > deadline) {
+                std::cerr << "qpid-broker-bench: queues not drained after " << opts.drainTimeout << " seconds" << std::endl;
+                drained = false;
+                break;
+            }
+            qpid::sys::usleep(1000);
+        }
+    }
+    for (size_t i = 0; i < consumers.size(); ++i)
+        consumers[i]->stop();
+    for (size_t i = 0; i < consumerThreads.size(); ++i)
+        consumerThreads[i].join();
+    for (size_t i = 0; i < consumers.size(); ++i)
+        consumers[i]->getQueue()->cancel(consumers[i]);
+    AbsTime end = opts.consumers && results.last > published ? results.last : published;
+
+    uint64_t depth = 0;
+    for (size_t q = 0; q < queues.size(); ++q)
+        depth += queues[q]->getMessageCount();
+
+    double publishSecs = secs(start, published);
+    double totalSecs = secs(start, end);
+    uint64_t sent = opts.producers*opts.count;
+    const Histogram& latency = results.latency;
+
+    JsonLine()
+        .add("iteration", iteration)
+        .add("exchangeType", opts.exchangeType)
+        .add("queueType", queueTypeNames[opts.queueType])
+        .add("queues", opts.queues)
+        .add("bindings", opts.bindings)
+        .add("producers", opts.producers)
+        .add("consumers", opts.consumers)
+        .add("size", opts.size)
+        .add("durable", opts.durable)
+        .add("sent", sent)
+        .add("routed", routed)
+        .add("received", results.received)
+        .add("depth", depth)
+        .add("drained", drained)
+        .add("publishSeconds", publishSecs)
+        .add("totalSeconds", totalSecs)
+        .add("publishRate", publishSecs > 0 ? sent/publishSecs : 0)
+        .add("receiveRate", totalSecs > 0 && opts.consumers ? results.received/totalSecs : 0)
+        .add("publishMBytesPerSecond", publishSecs > 0 ? double(sent*opts.size)/(1024*1024)/publishSecs : 0)
+        .begin("latencyUs")
+        .add("count", latency.getCount())
+        .add("min", usecs(latency.getMin()))
+        .add("mean", usecs(latency.getCount() ? latency.getTotal()/latency.getCount() : 0))
+        .add("p50", usecs(latency.getPercentile(50)))
+        .add("p90", usecs(latency.getPercentile(90)))
+        .add("p99", usecs(latency.getPercentile(99)))
+        .add("p999", usecs(latency.getPercentile(99.9)))
+        .add("max", usecs(latency.getMax()))
+        .end()
+        .print();
+
+    // Leave the broker empty for the next iteration.
+    for (size_t q = 0; q < queues.size(); ++q)
+        broker.deleteQueue(queues[q]->getName(), std::string(), std::string());
+    broker.deleteExchange(EXCHANGE_NAME, std::string(), std::string());
+}
+
+}} // namespace qpid::tests
+
+using namespace qpid::tests;
+
+int main(int argc, char** argv)
+{
+    try {
+        // Load any store or other modules first so that their options
+        // are known when the full command line is parsed.
+        qpid::ModuleOptions modules("");
+        modules.parse(argc, argv, std::string(), true);
+        for (std::vector<std::string>::iterator i = modules.load.begin(); i != modules.load.end(); ++i)
+            qpid::tryShlib(*i);
+
+        Opts opts;
+        opts.add(modules);
+        qpid::Plugin::addOptions(opts);
+        opts.parse(argc, argv);
+        if (opts.help) {
+            std::cout << opts << std::endl;
+            return 0;
+        }
+        if (opts.queues == 0 || opts.keys == 0 || opts.priorities == 0)
+            throw qpid::Exception("--queues, --keys and --priorities must be at least 1");
+        qpid::log::Logger::instance().configure(opts.log);
+
+        boost::intrusive_ptr<Broker> broker(Broker::create(opts.broker));
+        for (size_t i = 0; i < opts.iterations; ++i)
+            run(opts, *broker, i);
+        broker->shutdown();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "qpid-broker-bench: " << e.what() << std::endl;
+        return 1;
+    }
+}
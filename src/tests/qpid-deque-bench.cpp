@@ -0,0 +1,104 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Microbenchmark for qpid::broker::IndexedDeque::publish.
+ *
+ * Publishes messages into an IndexedDeque<Message> with the logger set
+ * to a chosen level (notice+ by default) and times each publish. The
+ * debug statement on that path is either compiled out (when the build
+ * sets QPID_LOG_MIN_LEVEL above debug) or skipped by its runtime check.
+ * qpid-deque-bench-notice is the same program built with the minimum
+ * level forced to notice, so running both shows what each costs.
+ */
+
+// Let the build force a minimum level for this program only; the
+// IndexedDeque code it times is instantiated here.
+#ifdef QPID_DEQUE_BENCH_MIN_LEVEL
+#undef QPID_LOG_MIN_LEVEL
+#define QPID_LOG_MIN_LEVEL QPID_DEQUE_BENCH_MIN_LEVEL
+#endif
+
+#include "BenchUtils.h"
+#include "qpid/broker/IndexedDeque.h"
+#include "qpid/broker/Message.h"
+#include "qpid/log/Logger.h"
+#include "qpid/log/Selector.h"
+
+using namespace qpid;
+using namespace qpid::sys;
+using qpid::broker::IndexedDeque;
+using qpid::broker::Message;
+using qpid::framing::SequenceNumber;
+
+namespace qpid {
+namespace tests {
+
+struct Opts : public BenchOptions
+{
+    std::string logEnable;
+
+    Opts() : BenchOptions(1000000), logEnable("notice+")
+    {
+        addOptions()
+            ("log-enable", optValue(logEnable, "RULE"), "Log levels enabled while publishing, as for qpidd");
+    }
+};
+
+Message pad(SequenceNumber n)
+{
+    Message m;
+    m.setSequence(n);
+    return m;
+}
+
+void run(const Opts& opts)
+{
+    qpid::log::Logger::instance().select(qpid::log::Selector(opts.logEnable));
+    IndexedDeque<Message> deque(&pad);
+    Message message;
+    uint64_t check = 0;
+
+    AbsTime start = AbsTime::now();
+    for (uint32_t i = 1; i <= opts.count; ++i) {
+        message.setSequence(SequenceNumber(i));
+        check += deque.publish(message).getState();
+    }
+    double publishTime = nsPerOp(start, opts.count);
+
+    JsonLine()
+        .add("logEnable", opts.logEnable)
+        .add("logMinLevel", QPID_LOG_MIN_LEVEL)
+        .add("count", opts.count)
+        .add("publish_ns", publishTime)
+        .add("check", check)
+        .print();
+}
+
+}} // namespace qpid::tests
+
+using namespace qpid::tests;
+
+int main(int argc, char** argv)
+{
+    Opts opts;
+    return benchMain("qpid-deque-bench", argc, argv, opts, &run);
+}
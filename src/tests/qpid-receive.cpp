@@ -35,6 +35,7 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 
 using namespace qpid::messaging;
 using namespace qpid::types;
@@ -56,6 +57,7 @@ struct Options : public qpid::Options
     bool verifySequence;
     bool checkRedelivered;
     uint capacity;
+    uint batch;
     uint ackFrequency;
     uint tx;
     uint rollbackFrequency;
@@ -83,6 +85,7 @@ struct Options : public qpid::Options
           verifySequence(false),
           checkRedelivered(false),
           capacity(1000),
+          batch(0),
           ackFrequency(100),
           tx(0),
           rollbackFrequency(0),
@@ -108,6 +111,7 @@ struct Options : public qpid::Options
             ("verify-sequence", qpid::optValue(verifySequence), "Verify there are no gaps in the message sequence (by checking 'sn' header)")
             ("check-redelivered", qpid::optValue(checkRedelivered), "Fails with exception if a duplicate is not marked as redelivered (only relevant when ignore-duplicates is selected)")
             ("capacity", qpid::optValue(capacity, "N"), "Pre-fetch window (0 implies no pre-fetch)")
+            ("batch", qpid::optValue(batch, "N"), "Fetch up to N messages at a time (0 implies one at a time)")
             ("ack-frequency", qpid::optValue(ackFrequency, "N"), "Ack frequency (0 implies none of the messages will get accepted)")
             ("tx", qpid::optValue(tx, "N"), "batch size for transactions (0 implies transaction are not used)")
             ("rollback-frequency", qpid::optValue(rollbackFrequency, "N"), "rollback frequency (0 implies no transaction will be rolledback)")
@@ -182,6 +186,30 @@ class SequenceTracker
     uint lastSn;
 };
 
+/** Hand out messages one at a time, fetching them in batches if so configured */
+class BatchFetcher
+{
+  public:
+    BatchFetcher(Receiver& r, uint s) : receiver(r), size(s), next(0) {}
+
+    bool fetch(Message& message, Duration timeout) {
+        if (!size) return receiver.fetch(message, timeout);
+        if (next == batch.size()) {
+            batch.clear();
+            next = 0;
+            if (!receiver.fetch(batch, size, timeout)) return false;
+        }
+        message = batch[next++];
+        return true;
+    }
+
+  private:
+    Receiver& receiver;
+    const uint size;
+    std::vector<Message> batch;
+    size_t next;
+};
+
 }} // namespace qpid::tests
 
 using namespace qpid::tests;
@@ -202,6 +230,7 @@ int main(int argc, char ** argv)
             uint count = 0;
             uint txCount = 0;
             SequenceTracker sequenceTracker(opts);
+            BatchFetcher fetcher(receiver, opts.batch);
             Duration timeout = opts.getTimeout();
             bool done = false;
             Reporter<ThroughputAndLatency> reporter(std::cout, opts.reportEvery, opts.reportHeader);
@@ -217,7 +246,7 @@ int main(int argc, char ** argv)
 
             std::map<std::string,Sender> replyTo;
 
-            while (!done && receiver.fetch(msg, timeout)) {
+            while (!done && fetcher.fetch(msg, timeout)) {
                 reporter.message(msg);
                 if (sequenceTracker.track(msg)) {
                     if (msg.getContent() == EOS) {
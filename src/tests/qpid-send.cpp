@@ -35,6 +35,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 using std::string;
 using std::ios_base;
@@ -80,6 +81,7 @@ struct Options : public qpid::Options
     uint tx;
     uint rollbackFrequency;
     uint capacity;
+    uint batch;
     bool failoverUpdates;
     qpid::log::Options log;
     bool reportTotal;
@@ -110,6 +112,7 @@ struct Options : public qpid::Options
           tx(0),
           rollbackFrequency(0),
           capacity(1000),
+          batch(0),
           failoverUpdates(false),
           log(argv0),
           reportTotal(false),
@@ -143,6 +146,7 @@ struct Options : public qpid::Options
             ("content-map,M", qpid::optValue(entries, "NAME=VALUE"), "specify entry for map content")
             ("content-stdin", qpid::optValue(contentStdin), "read message content from stdin, one line per message")
             ("capacity", qpid::optValue(capacity, "N"), "size of the senders outgoing message queue")
+            ("batch", qpid::optValue(batch, "N"), "send messages in batches of N (0 implies one at a time)")
             ("tx", qpid::optValue(tx, "N"), "batch size for transactions (0 implies transaction are not used)")
             ("rollback-frequency", qpid::optValue(rollbackFrequency, "N"), "rollback frequency (0 implies no transaction will be rolledback)")
             ("failover-updates", qpid::optValue(failoverUpdates), "Listen for membership updates distributed via amq.failover")
@@ -387,6 +391,7 @@ int main(int argc, char ** argv)
             opts.setProperties(msg);
             uint sent = 0;
             uint txCount = 0;
+            std::vector<Message> batch;
             Reporter<Throughput> reporter(std::cout, opts.reportEvery, opts.reportHeader);
 
             std::auto_ptr<ContentGenerator> contentGen;
@@ -423,7 +428,16 @@ int main(int argc, char ** argv)
                 if (opts.timestamp)
                     msg.getProperties()[TS] = int64_t(
                         qpid::sys::Duration::FromEpoch());
-                sender.send(msg);
+                if (opts.batch) {
+                    batch.push_back(msg);
+                    if (batch.size() >= opts.batch || (opts.tx && (sent % opts.tx == 0))
+                        || (opts.messages && sent >= opts.messages)) {
+                        sender.send(batch);
+                        batch.clear();
+                    }
+                } else {
+                    sender.send(msg);
+                }
                 reporter.message(msg);
 
                 if (opts.tx && (sent % opts.tx == 0)) {
@@ -441,6 +455,7 @@ int main(int argc, char ** argv)
                     if (delay > 0) qpid::sys::usleep(delay/qpid::sys::TIME_USEC);
                 }
             }
+            if (!batch.empty()) sender.send(batch);
             if (opts.reportTotal) reporter.report();
             for (uint i = opts.sendEos; i > 0; --i) {
                 if (opts.sequence)
@@ -0,0 +1,118 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/**
+ * Microbenchmark for qpid::types::Variant.
+ *
+ * Builds a property map like those carried by messages (a mix of
+ * integers, booleans, doubles, short strings and the odd longer string)
+ * and times building it, copying the map and copying a Variant holding
+ * the map, which shares rather than copies the entries.
+ */
+
+#include "BenchUtils.h"
+#include "qpid/types/Variant.h"
+
+#include <boost/lexical_cast.hpp>
+
+using namespace qpid;
+using namespace qpid::sys;
+using qpid::types::Variant;
+using boost::lexical_cast;
+
+namespace qpid {
+namespace tests {
+
+struct Opts : public BenchOptions
+{
+    uint32_t entries;
+
+    Opts() : BenchOptions(100000), entries(20)
+    {
+        addOptions()
+            ("entries", optValue(entries, "N"), "Number of entries in the property map");
+    }
+};
+
+const std::string LONG_VALUE(64, 'x');
+
+void build(Variant::Map& map, uint32_t entries)
+{
+    for (uint32_t i = 0; i < entries; ++i) {
+        std::string key("property-" + lexical_cast<std::string>(i));
+        switch (i % 5) {
+          case 0: map[key] = uint32_t(i); break;
+          case 1: map[key] = int64_t(i) * -1000; break;
+          case 2: map[key] = (i % 2) == 0; break;
+          case 3: map[key] = (i % 10) == 8 ? LONG_VALUE : "value-" + lexical_cast<std::string>(i); break;
+          default: map[key] = double(i) / 3; break;
+        }
+    }
+}
+
+void run(const Opts& opts)
+{
+    uint64_t check = 0;
+
+    AbsTime start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        Variant::Map map;
+        build(map, opts.entries);
+        check += map.size();
+    }
+    double buildTime = nsPerOp(start, opts.count);
+
+    Variant::Map original;
+    build(original, opts.entries);
+    start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        Variant::Map copy(original);
+        check += copy.size();
+    }
+    double copyMapTime = nsPerOp(start, opts.count);
+
+    Variant value(original);
+    start = AbsTime::now();
+    for (uint32_t i = 0; i < opts.count; ++i) {
+        Variant copy(value);
+        check += copy.getType();
+    }
+    double copyVariantTime = nsPerOp(start, opts.count);
+
+    JsonLine()
+        .add("entries", opts.entries)
+        .add("count", opts.count)
+        .add("build_ns", buildTime)
+        .add("copy_map_ns", copyMapTime)
+        .add("copy_variant_ns", copyVariantTime)
+        .add("check", check)
+        .print();
+}
+
+}} // namespace qpid::tests
+
+using namespace qpid::tests;
+
+int main(int argc, char** argv)
+{
+    Opts opts;
+    return benchMain("qpid-variant-bench", argc, argv, opts, &run);
+}